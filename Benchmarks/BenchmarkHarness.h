@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Minimal timing harness for the headless gameplay benchmarks.
+////////////////////////////////////////////////////////
+struct SBenchmarkOptions
+{
+	// Number of kernel invocations each measurement aims for, spread over the simulated frames.
+	uint64_t targetOperations = 2000000;
+	// Simulated player counts every kernel is measured at.
+	std::vector<uint32_t> playerCounts = { 1, 10, 100, 1000, 10000 };
+};
+
+// Keeps results observable so that the optimizer cannot drop the measured work.
+extern volatile float g_benchmarkSink;
+
+// Runs the frame function until about targetOperations operations of operationsPerFrame each are done,
+// and returns the average nanoseconds per operation.
+template<typename TFrameFunction>
+inline double MeasureNanosecondsPerOperation(const SBenchmarkOptions& options, uint64_t operationsPerFrame, TFrameFunction&& frameFunction)
+{
+	const uint64_t frameCount = operationsPerFrame >= options.targetOperations ? 1 : options.targetOperations / operationsPerFrame;
+
+	// One untimed frame to warm up caches and branch predictors
+	frameFunction(0);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t frame = 1; frame <= frameCount; ++frame)
+	{
+		frameFunction(frame);
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	return nanoseconds / static_cast<double>(frameCount * operationsPerFrame);
+}
+
+// Deterministic coordinate in [0, range] so that every run tests the same layout, salt picks a different sequence.
+inline float ScatterCoordinate(uint32_t index, uint32_t salt, float range)
+{
+	uint32_t value = index * 2654435761u + salt * 40503u;
+	value ^= value >> 15;
+	value *= 2246822519u;
+	value ^= value >> 13;
+	return static_cast<float>(value & 0xFFFF) / 65535.f * range;
+}
+
+inline void PrintBenchmarkHeader(const char* szGroup)
+{
+	printf("\n== %s ==\n", szGroup);
+	printf("%-32s %10s %14s\n", "Benchmark", "Players", "ns/op");
+}
+
+inline void PrintBenchmarkResult(const char* szName, uint32_t playerCount, double nanosecondsPerOperation)
+{
+	printf("%-32s %10u %14.2f\n", szName, playerCount, nanosecondsPerOperation);
+}
+
+// Benchmark groups, each lives in its own translation unit.
+void RunPlayerKernelBenchmarks(const SBenchmarkOptions& options);
+void RunTriggerBroadphaseBenchmarks(const SBenchmarkOptions& options);
+void RunFireReplicationBenchmarks(const SBenchmarkOptions& options);
+void RunPlayerSnapshotBenchmarks(const SBenchmarkOptions& options);
+void RunGameplayMemoryBenchmarks(const SBenchmarkOptions& options);
@@ -0,0 +1,485 @@
+#include "BenchmarkHarness.h"
+#include "Core/FireEventCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+	#define FIRE_REPLICATION_LOOPBACK 0
+#else
+	#include <arpa/inet.h>
+	#include <netinet/in.h>
+	#include <sys/socket.h>
+	#include <sys/time.h>
+	#include <unistd.h>
+	#define FIRE_REPLICATION_LOOPBACK 1
+#endif
+
+namespace
+{
+	// Same numbers as SRegularBulletTraits and SWaterBulletTraits. The bullets are launched with an impulse,
+	// so they fly at the impulse divided by their mass.
+	struct SWeapon
+	{
+		float launchImpulse;
+		float mass;
+		float lifetime;
+		float fireRate;
+
+		float GetLaunchSpeed() const { return NetKernels::GetLaunchSpeed(launchImpulse, mass); }
+	};
+	const SWeapon Weapons[2] = { { 1000.f, 20000.f, 1.f, 10.f }, { 10.f, 20000.f, 5.f, 4.f } };
+
+	const float ServerTickRate = 30.f;
+	const float SimulatedSeconds = 2.f;
+	const float Gravity = -9.81f;
+	const float TargetRadius = 0.5f;
+	const uint32_t MaxDatagramBytes = 1200;
+	// IPv4 and UDP headers every datagram pays on the wire on top of its payload
+	const uint32_t DatagramHeaderBytes = 28;
+	// Loopback floods a socket buffer fast with thousands of players, the larger counts add nothing here
+	const uint32_t MaxReplicatedPlayers = 1000;
+
+	struct SShot
+	{
+		NetKernels::SFireEvent event;
+		float age;
+	};
+
+	struct SReplicationResult
+	{
+		uint64_t shots = 0;
+		uint64_t payloadBytes = 0;
+		uint64_t datagrams = 0;
+		uint64_t serverHits = 0;
+		// Worst client trajectory error as a fraction of what the quantization allows.
+		float maxTrajectoryError = 0.f;
+	};
+
+	// Ground positions of the players, x and y interleaved.
+	std::vector<float> CreateTargetPositions(uint32_t playerCount)
+	{
+		std::vector<float> positions(playerCount * 2);
+		for (uint32_t player = 0; player < playerCount; ++player)
+		{
+			positions[player * 2] = ScatterCoordinate(player, 1, 400.f);
+			positions[player * 2 + 1] = ScatterCoordinate(player, 2, 400.f);
+		}
+		return positions;
+	}
+
+	// Every player stands still and fires its weapon at the weapon's fire rate, turning a little each shot.
+	// Even players fire regular bullets, odd players water bullets.
+	void CreateShots(uint32_t playerCount, uint32_t tick, uint16_t& nextSeed, std::vector<NetKernels::SFireEvent>& shots)
+	{
+		const float tickSeconds = 1.f / ServerTickRate;
+		for (uint32_t player = 0; player < playerCount; ++player)
+		{
+			const SWeapon& weapon = Weapons[player % 2];
+			const uint32_t shotsBefore = static_cast<uint32_t>(tick * tickSeconds * weapon.fireRate);
+			const uint32_t shotsAfter = static_cast<uint32_t>((tick + 1) * tickSeconds * weapon.fireRate);
+			for (uint32_t shot = shotsBefore; shot < shotsAfter; ++shot)
+			{
+				const float yaw = static_cast<float>(player) * 0.7f + static_cast<float>(shot) * 0.1f;
+				NetKernels::SFireEvent event;
+				event.shooterIndex = static_cast<uint16_t>(player);
+				event.weaponType = static_cast<uint8_t>(player % 2);
+				event.isHitscan = false;
+				event.positionX = ScatterCoordinate(player, 1, 400.f);
+				event.positionY = ScatterCoordinate(player, 2, 400.f);
+				event.positionZ = 1.5f;
+				// Rotation about the up axis, aiming slightly upwards
+				event.rotationX = 0.02f;
+				event.rotationY = 0.f;
+				event.rotationZ = sinf(yaw * 0.5f);
+				event.rotationW = cosf(yaw * 0.5f);
+				const float length = sqrtf(event.rotationX * event.rotationX + event.rotationZ * event.rotationZ + event.rotationW * event.rotationW);
+				event.rotationX /= length;
+				event.rotationZ /= length;
+				event.rotationW /= length;
+				event.scale = 1.f;
+				event.timestampMs = static_cast<uint32_t>(tick * 1000.f / ServerTickRate);
+				event.seed = nextSeed++;
+				shots.push_back(event);
+			}
+		}
+	}
+
+	// The server sweeps every live projectile over the tick against the players, like the physics would for a bullet entity.
+	// Returns true if it hit someone other than the shooter.
+	bool SweepShot(const SShot& shot, float fromTime, float toTime, const std::vector<float>& targetPositions)
+	{
+		const SWeapon& weapon = Weapons[shot.event.weaponType];
+		float fromX, fromY, fromZ, toX, toY, toZ;
+		NetKernels::EvaluateFireTrajectory(shot.event, weapon.GetLaunchSpeed(), Gravity, fromTime, fromX, fromY, fromZ);
+		NetKernels::EvaluateFireTrajectory(shot.event, weapon.GetLaunchSpeed(), Gravity, toTime, toX, toY, toZ);
+
+		const float segmentX = toX - fromX, segmentY = toY - fromY, segmentZ = toZ - fromZ;
+		const float segmentLengthSquared = segmentX * segmentX + segmentY * segmentY + segmentZ * segmentZ;
+		const float reach = TargetRadius + std::fabs(segmentX) + std::fabs(segmentY);
+		const uint32_t playerCount = static_cast<uint32_t>(targetPositions.size() / 2);
+		for (uint32_t player = 0; player < playerCount; ++player)
+		{
+			const float centerX = targetPositions[player * 2] - fromX;
+			const float centerY = targetPositions[player * 2 + 1] - fromY;
+			if (std::fabs(centerX) > reach || std::fabs(centerY) > reach || player == shot.event.shooterIndex)
+				continue;
+
+			const float centerZ = 1.f - fromZ;
+			const float along = segmentLengthSquared > 0.f ? std::max(0.f, std::min(1.f, (centerX * segmentX + centerY * segmentY + centerZ * segmentZ) / segmentLengthSquared)) : 0.f;
+			const float offsetX = centerX - segmentX * along, offsetY = centerY - segmentY * along, offsetZ = centerZ - segmentZ * along;
+			if (offsetX * offsetX + offsetY * offsetY + offsetZ * offsetZ < TargetRadius * TargetRadius)
+				return true;
+		}
+		return false;
+	}
+
+#if FIRE_REPLICATION_LOOPBACK
+	// A server and a client UDP socket on 127.0.0.1, the server sends and the client receives.
+	class CLoopbackConnection
+	{
+	public:
+		CLoopbackConnection()
+		{
+			m_serverSocket = OpenSocket();
+			m_clientSocket = OpenSocket();
+
+			// Receives block for at most a second, so that a lost datagram fails the run instead of hanging it
+			timeval timeout = { 1, 0 };
+			setsockopt(m_clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+			socklen_t addressLength = sizeof(m_clientAddress);
+			getsockname(m_clientSocket, reinterpret_cast<sockaddr*>(&m_clientAddress), &addressLength);
+		}
+
+		~CLoopbackConnection()
+		{
+			close(m_serverSocket);
+			close(m_clientSocket);
+		}
+
+		bool IsOpen() const { return m_serverSocket >= 0 && m_clientSocket >= 0; }
+
+		// Sends the datagram to the client and receives it there.
+		bool Transfer(const std::vector<uint8_t>& datagram, std::vector<uint8_t>& received)
+		{
+			if (sendto(m_serverSocket, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr*>(&m_clientAddress), sizeof(m_clientAddress)) != static_cast<ssize_t>(datagram.size()))
+				return false;
+
+			received.resize(MaxDatagramBytes);
+			const ssize_t receivedBytes = recv(m_clientSocket, received.data(), received.size(), 0);
+			if (receivedBytes < 0)
+				return false;
+
+			received.resize(static_cast<size_t>(receivedBytes));
+			m_payloadBytes += static_cast<uint64_t>(receivedBytes);
+			++m_datagrams;
+			return true;
+		}
+
+		uint64_t GetPayloadBytes() const { return m_payloadBytes; }
+		uint64_t GetDatagrams() const { return m_datagrams; }
+
+	private:
+		static int OpenSocket()
+		{
+			const int socketHandle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+			if (socketHandle < 0)
+				return -1;
+
+			sockaddr_in address = {};
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			address.sin_port = 0;
+			if (bind(socketHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+			{
+				close(socketHandle);
+				return -1;
+			}
+			return socketHandle;
+		}
+
+		int m_serverSocket = -1;
+		int m_clientSocket = -1;
+		sockaddr_in m_clientAddress = {};
+		uint64_t m_payloadBytes = 0;
+		uint64_t m_datagrams = 0;
+	};
+
+	// Server fires and resolves hits, the fire events go over the loopback and the client flies its own copies of
+	// the projectiles from them. The client trajectories are compared with the server's to measure what the
+	// quantization costs in accuracy.
+	SReplicationResult RunFireEventReplication(uint32_t playerCount)
+	{
+		SReplicationResult result;
+		CLoopbackConnection connection;
+		if (!connection.IsOpen())
+		{
+			printf("Fire replication: could not open loopback sockets\n");
+			exit(1);
+		}
+
+		const NetKernels::SLevelGrid grid;
+		const float tickSeconds = 1.f / ServerTickRate;
+		const uint32_t tickCount = static_cast<uint32_t>(SimulatedSeconds * ServerTickRate);
+		const std::vector<float> targetPositions = CreateTargetPositions(playerCount);
+		uint16_t nextSeed = 1;
+
+		std::vector<SShot> serverShots;
+		std::vector<SShot> clientShots;
+		std::vector<NetKernels::SFireEvent> newShots;
+		std::vector<NetKernels::SFireEvent> decodedShots;
+		std::vector<uint8_t> datagram;
+		std::vector<uint8_t> received;
+
+		for (uint32_t tick = 0; tick < tickCount; ++tick)
+		{
+			newShots.clear();
+			CreateShots(playerCount, tick, nextSeed, newShots);
+			result.shots += newShots.size();
+
+			// Server: one event per shot, the shots of the tick go out together
+			decodedShots.clear();
+			for (size_t first = 0; first < newShots.size(); first += NetKernels::MaxFireEventsPerPacket)
+			{
+				const uint32_t count = static_cast<uint32_t>(std::min<size_t>(newShots.size() - first, NetKernels::MaxFireEventsPerPacket));
+				NetKernels::EncodeFireEvents(grid, &newShots[first], count, datagram);
+				if (!connection.Transfer(datagram, received) || !NetKernels::DecodeFireEvents(grid, received.data(), static_cast<uint32_t>(received.size()), decodedShots))
+				{
+					printf("Fire replication: datagram lost or malformed\n");
+					exit(1);
+				}
+			}
+
+			// The client has to know exactly who fired what and when, only the transform may be approximate
+			if (decodedShots.size() != newShots.size())
+			{
+				printf("Fire replication mismatch: %u events decoded, %u sent\n", static_cast<uint32_t>(decodedShots.size()), static_cast<uint32_t>(newShots.size()));
+				exit(1);
+			}
+			for (size_t i = 0; i < newShots.size(); ++i)
+			{
+				const NetKernels::SFireEvent& sent = newShots[i];
+				const NetKernels::SFireEvent& decoded = decodedShots[i];
+				if (sent.shooterIndex != decoded.shooterIndex || sent.weaponType != decoded.weaponType || sent.isHitscan != decoded.isHitscan || sent.timestampMs != decoded.timestampMs
+					|| sent.seed != decoded.seed || std::fabs(sent.positionX - decoded.positionX) > 0.01f || std::fabs(sent.scale - decoded.scale) > 0.01f)
+				{
+					printf("Fire replication mismatch: shot %u of shooter %u decoded differently\n", static_cast<uint32_t>(i), sent.shooterIndex);
+					exit(1);
+				}
+				serverShots.push_back(SShot { sent, 0.f });
+				clientShots.push_back(SShot { decoded, 0.f });
+			}
+
+			// Both sides fly their projectiles, only the server tests them against the players
+			for (size_t i = 0; i < serverShots.size();)
+			{
+				SShot& serverShot = serverShots[i];
+				SShot& clientShot = clientShots[i];
+				const SWeapon& weapon = Weapons[serverShot.event.weaponType];
+				const float nextAge = serverShot.age + tickSeconds;
+
+				float serverX, serverY, serverZ, clientX, clientY, clientZ;
+				NetKernels::EvaluateFireTrajectory(serverShot.event, weapon.GetLaunchSpeed(), Gravity, nextAge, serverX, serverY, serverZ);
+				NetKernels::EvaluateFireTrajectory(clientShot.event, weapon.GetLaunchSpeed(), Gravity, nextAge, clientX, clientY, clientZ);
+				const float error = sqrtf((serverX - clientX) * (serverX - clientX) + (serverY - clientY) * (serverY - clientY) + (serverZ - clientZ) * (serverZ - clientZ));
+				// Allowed is the position quantization plus the direction quantization over the distance flown
+				const float allowedError = 0.005f + 0.003f * weapon.GetLaunchSpeed() * nextAge;
+				result.maxTrajectoryError = std::max(result.maxTrajectoryError, error / allowedError);
+
+				const bool hit = SweepShot(serverShot, serverShot.age, nextAge, targetPositions);
+				serverShot.age = clientShot.age = nextAge;
+				if (hit || nextAge >= weapon.lifetime)
+				{
+					result.serverHits += hit ? 1 : 0;
+					serverShots[i] = serverShots.back();
+					serverShots.pop_back();
+					clientShots[i] = clientShots.back();
+					clientShots.pop_back();
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+
+		result.payloadBytes = connection.GetPayloadBytes();
+		result.datagrams = connection.GetDatagrams();
+		return result;
+	}
+
+	// Appends a message to the datagram, sending the datagram first if the message would not fit.
+	void AppendMessage(CLoopbackConnection& connection, std::vector<uint8_t>& datagram, std::vector<uint8_t>& received, const void* pMessage, uint32_t size)
+	{
+		if (datagram.size() + size > MaxDatagramBytes)
+		{
+			if (!connection.Transfer(datagram, received))
+			{
+				printf("Entity replication: datagram lost\n");
+				exit(1);
+			}
+			datagram.clear();
+		}
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pMessage);
+		datagram.insert(datagram.end(), pBytes, pBytes + size);
+	}
+
+	// The same shots replicated as networked bullet entities: a spawn per shot, a physics state per tick while
+	// the bullet flies and a removal, messages packed into as few datagrams as fit.
+	SReplicationResult RunEntityReplication(uint32_t playerCount)
+	{
+		SReplicationResult result;
+		CLoopbackConnection connection;
+		if (!connection.IsOpen())
+		{
+			printf("Entity replication: could not open loopback sockets\n");
+			exit(1);
+		}
+
+		const float tickSeconds = 1.f / ServerTickRate;
+		const uint32_t tickCount = static_cast<uint32_t>(SimulatedSeconds * ServerTickRate);
+		const std::vector<float> targetPositions = CreateTargetPositions(playerCount);
+		uint16_t nextSeed = 1;
+		uint32_t nextEntityId = 1;
+
+		struct SBulletEntity
+		{
+			SShot shot;
+			uint32_t entityId;
+		};
+		std::vector<SBulletEntity> bullets;
+		std::vector<NetKernels::SFireEvent> newShots;
+		std::vector<uint8_t> datagram;
+		std::vector<uint8_t> received;
+		uint8_t message[NetKernels::EntitySpawnMessageBytes + NetKernels::EntityStateMessageBytes] = {};
+
+		for (uint32_t tick = 0; tick < tickCount; ++tick)
+		{
+			newShots.clear();
+			CreateShots(playerCount, tick, nextSeed, newShots);
+			result.shots += newShots.size();
+
+			datagram.clear();
+			for (const NetKernels::SFireEvent& event : newShots)
+			{
+				const uint32_t entityId = nextEntityId++;
+				memcpy(message, &entityId, sizeof(entityId));
+				memcpy(message + 6, &event.positionX, sizeof(float) * 3);
+				memcpy(message + 18, &event.rotationX, sizeof(float) * 4);
+				AppendMessage(connection, datagram, received, message, NetKernels::EntitySpawnMessageBytes);
+				bullets.push_back(SBulletEntity { SShot { event, 0.f }, entityId });
+			}
+
+			for (size_t i = 0; i < bullets.size();)
+			{
+				SBulletEntity& bullet = bullets[i];
+				const SWeapon& weapon = Weapons[bullet.shot.event.weaponType];
+				const float nextAge = bullet.shot.age + tickSeconds;
+				const bool hit = SweepShot(bullet.shot, bullet.shot.age, nextAge, targetPositions);
+				bullet.shot.age = nextAge;
+
+				if (hit || nextAge >= weapon.lifetime)
+				{
+					result.serverHits += hit ? 1 : 0;
+					AppendMessage(connection, datagram, received, &bullet.entityId, NetKernels::EntityRemoveMessageBytes);
+					bullets[i] = bullets.back();
+					bullets.pop_back();
+					continue;
+				}
+
+				float position[3];
+				NetKernels::EvaluateFireTrajectory(bullet.shot.event, weapon.GetLaunchSpeed(), Gravity, nextAge, position[0], position[1], position[2]);
+				memcpy(message, &bullet.entityId, sizeof(bullet.entityId));
+				memcpy(message + 4, position, sizeof(position));
+				memcpy(message + 16, &bullet.shot.event.rotationX, sizeof(float) * 4);
+				AppendMessage(connection, datagram, received, message, NetKernels::EntityStateMessageBytes);
+				++i;
+			}
+
+			if (!datagram.empty() && !connection.Transfer(datagram, received))
+			{
+				printf("Entity replication: datagram lost\n");
+				exit(1);
+			}
+		}
+
+		result.payloadBytes = connection.GetPayloadBytes();
+		result.datagrams = connection.GetDatagrams();
+		return result;
+	}
+
+	void PrintReplicationResult(const char* szName, uint32_t playerCount, const SReplicationResult& result)
+	{
+		const double shots = static_cast<double>(std::max<uint64_t>(result.shots, 1));
+		const double wireBytes = static_cast<double>(result.payloadBytes + result.datagrams * DatagramHeaderBytes);
+		printf("%-32s %10u %10llu %12.2f %12.2f %8llu\n", szName, playerCount, static_cast<unsigned long long>(result.shots),
+			static_cast<double>(result.payloadBytes) / shots, wireBytes / shots, static_cast<unsigned long long>(result.serverHits));
+	}
+#endif
+}
+
+void RunFireReplicationBenchmarks(const SBenchmarkOptions& options)
+{
+	PrintBenchmarkHeader("Fire event codec (ns per event)");
+	{
+		const NetKernels::SLevelGrid grid;
+		std::vector<NetKernels::SFireEvent> events;
+		uint16_t seed = 1;
+		for (uint32_t tick = 0; events.size() < NetKernels::MaxFireEventsPerPacket; ++tick)
+		{
+			CreateShots(100, tick, seed, events);
+		}
+		events.resize(NetKernels::MaxFireEventsPerPacket);
+
+		std::vector<uint8_t> packet;
+		std::vector<NetKernels::SFireEvent> decoded;
+		double nanoseconds = MeasureNanosecondsPerOperation(options, NetKernels::MaxFireEventsPerPacket, [&](uint64_t frame)
+		{
+			events[0].seed = static_cast<uint16_t>(frame);
+			NetKernels::EncodeFireEvents(grid, events.data(), NetKernels::MaxFireEventsPerPacket, packet);
+		});
+		PrintBenchmarkResult("Encode", NetKernels::MaxFireEventsPerPacket, nanoseconds);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, NetKernels::MaxFireEventsPerPacket, [&](uint64_t)
+		{
+			decoded.clear();
+			NetKernels::DecodeFireEvents(grid, packet.data(), static_cast<uint32_t>(packet.size()), decoded);
+		});
+		PrintBenchmarkResult("Decode", NetKernels::MaxFireEventsPerPacket, nanoseconds);
+		g_benchmarkSink = g_benchmarkSink + decoded[0].positionX;
+	}
+
+#if FIRE_REPLICATION_LOOPBACK
+	printf("\n== Fire replication over UDP loopback, %.0f s at %.0f Hz (bytes per shot) ==\n", SimulatedSeconds, ServerTickRate);
+	printf("%-32s %10s %10s %12s %12s %8s\n", "Replication", "Players", "Shots", "Payload", "Wire", "Hits");
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		if (playerCount > MaxReplicatedPlayers)
+			continue;
+
+		const SReplicationResult fireEvents = RunFireEventReplication(playerCount);
+		const SReplicationResult entities = RunEntityReplication(playerCount);
+		PrintReplicationResult("Fire events", playerCount, fireEvents);
+		PrintReplicationResult("Bullet entities", playerCount, entities);
+
+		// Both sides fire the same shots and the server resolves the same hits, only the traffic may differ
+		if (fireEvents.shots != entities.shots || fireEvents.serverHits != entities.serverHits)
+		{
+			printf("Fire replication mismatch: the two runs fired or hit differently\n");
+			exit(1);
+		}
+		// Client trajectories drift from the server's only by the quantized muzzle transform
+		if (fireEvents.maxTrajectoryError > 1.f)
+		{
+			printf("Fire replication mismatch: client trajectories drift %.2f times further than the quantization allows\n", fireEvents.maxTrajectoryError);
+			exit(1);
+		}
+	}
+#else
+	printf("\nFire replication loopback skipped, it needs POSIX sockets\n");
+#endif
+}
@@ -0,0 +1,191 @@
+#include "BenchmarkHarness.h"
+#include "Core/GameplayMemory.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+	// Stands in for CGameplayMemory, one pool and one set of counters for the whole benchmark.
+	MemoryKernels::CSizeClassPool g_pool;
+	MemoryKernels::SAllocationCounters g_counters;
+
+	// Mirrors TGameplayAllocator without the engine.
+	template<typename T>
+	class TBenchmarkPoolAllocator
+	{
+	public:
+		typedef T value_type;
+
+		template<typename U>
+		struct rebind
+		{
+			typedef TBenchmarkPoolAllocator<U> other;
+		};
+
+		TBenchmarkPoolAllocator() = default;
+		template<typename U>
+		TBenchmarkPoolAllocator(const TBenchmarkPoolAllocator<U>&) {}
+
+		T* allocate(size_t count)
+		{
+			g_counters.Add(count * sizeof(T));
+			return static_cast<T*>(g_pool.Allocate(count * sizeof(T)));
+		}
+
+		void deallocate(T* pMemory, size_t count)
+		{
+			g_counters.Remove(count * sizeof(T));
+			g_pool.Free(pMemory, count * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const TBenchmarkPoolAllocator<U>&) const { return true; }
+		template<typename U>
+		bool operator!=(const TBenchmarkPoolAllocator<U>&) const { return false; }
+	};
+
+	// Same size as CFireScheduler::SQueuedShot.
+	struct SQueuedShot
+	{
+		float muzzle[8];
+		uint32_t shooterId;
+		uint8_t type;
+		float requestTime;
+		int requestFrameId;
+	};
+
+	template<typename TAllocator>
+	using TShotQueue = std::deque<SQueuedShot, TAllocator>;
+	template<typename TAllocator>
+	using TShooterMap = std::unordered_map<uint32_t, float, std::hash<uint32_t>, std::equal_to<uint32_t>, TAllocator>;
+
+	// A frame of CFireScheduler: every shooter queues a shot and the queue is drained again.
+	template<typename TQueue>
+	void ChurnShotQueue(TQueue& queue, uint32_t shooterCount, uint64_t frame)
+	{
+		for (uint32_t i = 0; i < shooterCount; ++i)
+		{
+			queue.push_back(SQueuedShot { {}, i, static_cast<uint8_t>(frame & 1), static_cast<float>(frame), static_cast<int>(frame) });
+		}
+		while (!queue.empty())
+		{
+			g_benchmarkSink = g_benchmarkSink + queue.front().requestTime;
+			queue.pop_front();
+		}
+	}
+
+	// Shooters joining and leaving, like the fire rate history and the trigger registrations of spawned entities.
+	template<typename TMap>
+	void ChurnShooterMap(TMap& shooters, uint32_t shooterCount, uint64_t frame)
+	{
+		const uint32_t firstId = static_cast<uint32_t>(frame * shooterCount);
+		for (uint32_t i = 0; i < shooterCount; ++i)
+		{
+			shooters.emplace(firstId + i, static_cast<float>(i));
+		}
+		for (uint32_t i = 0; i < shooterCount; ++i)
+		{
+			shooters.erase(firstId + i);
+		}
+	}
+
+	void Fail(const char* szMessage)
+	{
+		printf("Gameplay memory mismatch: %s\n", szMessage);
+		exit(1);
+	}
+
+	// The arena has to keep alignment and give everything back at once, and a level that needed several chunks
+	// has to be served from one block after the reset.
+	void CheckLevelArena()
+	{
+		MemoryKernels::CLinearArena arena(4096);
+		for (uint32_t level = 0; level < 3; ++level)
+		{
+			for (uint32_t i = 0; i < 100; ++i)
+			{
+				void* pMemory = arena.Allocate(100 + i, i % 2 == 0 ? 16 : 4);
+				if (pMemory == nullptr || (i % 2 == 0 && reinterpret_cast<uintptr_t>(pMemory) % 16 != 0))
+					Fail("level arena allocation is not aligned");
+				memset(pMemory, 0xcd, 100 + i);
+			}
+			if (arena.GetUsedBytes() < 100 * 100 || arena.GetUsedBytes() > arena.GetReservedBytes())
+				Fail("level arena used bytes do not add up");
+			if (level > 0 && arena.GetChunkCount() != 1)
+				Fail("level arena needs more than one chunk for a level of the same size");
+			arena.Reset();
+			if (arena.GetUsedBytes() != 0 || arena.GetChunkCount() != 1)
+				Fail("level arena reset did not rewind into a single chunk");
+		}
+
+		// Level storage the projectile pool and manager attach to
+		MemoryKernels::TFixedArray<uint32_t> freeEntities;
+		freeEntities.Attach(static_cast<uint32_t*>(arena.Allocate(sizeof(uint32_t) * 4, alignof(uint32_t))), 4);
+		for (uint32_t i = 0; i < 5; ++i)
+		{
+			if (freeEntities.push_back(i) != (i < 4))
+				Fail("fixed array does not stop at its capacity");
+		}
+		if (freeEntities.back() != 3 || freeEntities.size() != 4)
+			Fail("fixed array lost an element");
+		freeEntities.Detach();
+	}
+
+	// Once warmed up, churning the same number of nodes must not take anything more from the heap.
+	void CheckPoolReuse()
+	{
+		TShotQueue<TBenchmarkPoolAllocator<SQueuedShot>> queue;
+		TShooterMap<TBenchmarkPoolAllocator<std::pair<const uint32_t, float>>> shooters;
+		ChurnShotQueue(queue, 1000, 0);
+		ChurnShooterMap(shooters, 1000, 0);
+		const size_t reservedBytes = g_pool.GetReservedBytes();
+
+		for (uint64_t frame = 1; frame < 200; ++frame)
+		{
+			ChurnShotQueue(queue, 1000, frame);
+			ChurnShooterMap(shooters, 1000, frame);
+		}
+		if (g_pool.GetReservedBytes() != reservedBytes)
+			Fail("pools kept growing under steady churn");
+
+		void* pFirst = g_pool.Allocate(48);
+		g_pool.Free(pFirst, 48);
+		void* pSecond = g_pool.Allocate(40);
+		g_pool.Free(pSecond, 40);
+		if (pFirst != pSecond)
+			Fail("a freed block is not reused for the next request of its size class");
+	}
+}
+
+void RunGameplayMemoryBenchmarks(const SBenchmarkOptions& options)
+{
+	CheckLevelArena();
+	CheckPoolReuse();
+
+	PrintBenchmarkHeader("Gameplay memory churn (ns per shooter)");
+	for (const uint32_t shooterCount : options.playerCounts)
+	{
+		TShotQueue<std::allocator<SQueuedShot>> heapQueue;
+		double nanoseconds = MeasureNanosecondsPerOperation(options, shooterCount, [&](uint64_t frame) { ChurnShotQueue(heapQueue, shooterCount, frame); });
+		PrintBenchmarkResult("Shot queue, heap", shooterCount, nanoseconds);
+
+		TShotQueue<TBenchmarkPoolAllocator<SQueuedShot>> poolQueue;
+		nanoseconds = MeasureNanosecondsPerOperation(options, shooterCount, [&](uint64_t frame) { ChurnShotQueue(poolQueue, shooterCount, frame); });
+		PrintBenchmarkResult("Shot queue, pools", shooterCount, nanoseconds);
+
+		TShooterMap<std::allocator<std::pair<const uint32_t, float>>> heapShooters;
+		nanoseconds = MeasureNanosecondsPerOperation(options, shooterCount, [&](uint64_t frame) { ChurnShooterMap(heapShooters, shooterCount, frame); });
+		PrintBenchmarkResult("Shooter map, heap", shooterCount, nanoseconds);
+
+		TShooterMap<TBenchmarkPoolAllocator<std::pair<const uint32_t, float>>> poolShooters;
+		nanoseconds = MeasureNanosecondsPerOperation(options, shooterCount, [&](uint64_t frame) { ChurnShooterMap(poolShooters, shooterCount, frame); });
+		PrintBenchmarkResult("Shooter map, pools", shooterCount, nanoseconds);
+	}
+
+	printf("Pools reserve %zu KB, peak %llu KB live in %llu allocations\n", g_pool.GetReservedBytes() / 1024,
+		static_cast<unsigned long long>(g_counters.peakBytes / 1024), static_cast<unsigned long long>(g_counters.totalCount));
+}
@@ -0,0 +1,35 @@
+#include "BenchmarkHarness.h"
+#include <cstdlib>
+#include <cstring>
+
+volatile float g_benchmarkSink = 0.f;
+
+int main(int argc, char* argv[])
+{
+	SBenchmarkOptions options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		// --quick keeps the run short enough for every build, the default gives more stable numbers
+		if (strcmp(argv[i], "--quick") == 0)
+		{
+			options.targetOperations = 100000;
+		}
+		else if (strcmp(argv[i], "--operations") == 0 && i + 1 < argc)
+		{
+			options.targetOperations = strtoull(argv[++i], nullptr, 10);
+		}
+		else
+		{
+			printf("Usage: %s [--quick] [--operations <count>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	RunPlayerKernelBenchmarks(options);
+	RunTriggerBroadphaseBenchmarks(options);
+	RunFireReplicationBenchmarks(options);
+	RunPlayerSnapshotBenchmarks(options);
+	RunGameplayMemoryBenchmarks(options);
+	return 0;
+}
@@ -0,0 +1,624 @@
+#include "BenchmarkHarness.h"
+#include "Core/FixedTimestep.h"
+#include "Core/PlayerKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Stand-ins for the engine interfaces CPlayerComponent talks to during its update.
+	struct SStubVec3
+	{
+		float x, y, z;
+	};
+
+	class CStubCharacterController
+	{
+	public:
+		bool IsOnGround() const { return m_isOnGround; }
+		void AddVelocity(const SStubVec3& velocity)
+		{
+			m_velocity.x += velocity.x;
+			m_velocity.y += velocity.y;
+			m_velocity.z += velocity.z;
+		}
+		const SStubVec3& GetVelocity() const { return m_velocity; }
+
+	private:
+		bool m_isOnGround = true;
+		SStubVec3 m_velocity = { 0.f, 0.f, 0.f };
+	};
+
+	struct SStubEntity
+	{
+		SStubVec3 position;
+		// Rotation about Z as the W and Z of a quaternion.
+		float rotationW;
+		float rotationZ;
+	};
+
+	struct SStubPlayer
+	{
+		SStubEntity entity;
+		SStubEntity cursor;
+		CStubCharacterController characterController;
+		uint8_t inputFlags = 0;
+		bool isTopDown = true;
+	};
+
+	std::vector<SStubPlayer> CreatePlayers(uint32_t count)
+	{
+		std::vector<SStubPlayer> players(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			SStubPlayer& player = players[i];
+			player.entity.position = { static_cast<float>(i % 100), static_cast<float>(i / 100), 0.f };
+			player.entity.rotationW = 1.f;
+			player.entity.rotationZ = 0.f;
+			player.cursor.position = { player.entity.position.x + 3.f, player.entity.position.y - 2.f + static_cast<float>(i % 7), 0.f };
+			player.cursor.rotationW = 1.f;
+			player.cursor.rotationZ = 0.f;
+			player.isTopDown = (i % 4) != 0;
+		}
+		return players;
+	}
+
+	// Mirrors CPlayerComponent::HandleInputFlagChange, a press and a release of one movement key per player per frame.
+	void HandleInputFlagChanges(std::vector<SStubPlayer>& players, uint64_t frame)
+	{
+		const uint8_t flag = static_cast<uint8_t>(1u << (frame & 3));
+		for (SStubPlayer& player : players)
+		{
+			player.inputFlags = PlayerKernels::ApplyInputFlagChange<uint8_t>(player.inputFlags, flag, false, false);
+			player.inputFlags = PlayerKernels::ApplyInputFlagChange<uint8_t>(player.inputFlags, static_cast<uint8_t>(flag << 1), true, false);
+		}
+	}
+
+	// Mirrors CPlayerComponent::UpdateMovementRequest.
+	void UpdateMovementRequests(std::vector<SStubPlayer>& players, float frameTime)
+	{
+		const float moveSpeed = 20.5f;
+		for (SStubPlayer& player : players)
+		{
+			if (!player.characterController.IsOnGround())
+				continue;
+
+			const PlayerKernels::SPlanarVelocity velocity = PlayerKernels::ComputeMovementVelocity(player.inputFlags, player.isTopDown, moveSpeed, frameTime);
+			player.characterController.AddVelocity({ velocity.x, velocity.y, 0.f });
+		}
+	}
+
+	// The facing CPlayerComponent::UpdateAnimation used to do per character, a yaw and Quat::CreateRotationZ.
+	void UpdateFacingPerCharacter(std::vector<SStubPlayer>& players)
+	{
+		for (SStubPlayer& player : players)
+		{
+			const float directionX = player.cursor.position.x - player.entity.position.x;
+			const float directionY = player.cursor.position.y - player.entity.position.y;
+			const float halfYaw = PlayerKernels::ComputeFacingYaw(directionX, directionY) * 0.5f;
+			player.entity.rotationW = cosf(halfYaw);
+			player.entity.rotationZ = sinf(halfYaw);
+		}
+	}
+
+	struct SFacingBuffers
+	{
+		std::vector<float> directionX, directionY, rotationW, rotationZ;
+	};
+
+	// Mirrors CFacingSystem::Update, gather into structure of arrays, one batched pass and write back.
+	void UpdateFacingBatched(std::vector<SStubPlayer>& players, SFacingBuffers& buffers)
+	{
+		const uint32_t count = static_cast<uint32_t>(players.size());
+		buffers.directionX.resize(count);
+		buffers.directionY.resize(count);
+		buffers.rotationW.resize(count);
+		buffers.rotationZ.resize(count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			buffers.directionX[i] = players[i].cursor.position.x - players[i].entity.position.x;
+			buffers.directionY[i] = players[i].cursor.position.y - players[i].entity.position.y;
+		}
+
+		PlayerKernels::ComputeFacingRotations(buffers.directionX.data(), buffers.directionY.data(), buffers.rotationW.data(), buffers.rotationZ.data(), count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			players[i].entity.rotationW = buffers.rotationW[i];
+			players[i].entity.rotationZ = buffers.rotationZ[i];
+		}
+	}
+
+	// The four at a time path has to match ComputeFacingRotation, including zero and tiny directions whose sign
+	// must not flip them into a half turn.
+	void CheckFacingRotations()
+	{
+		SFacingBuffers buffers;
+		const float degenerateDirections[][2] = { { 0.f, -1e-7f }, { 0.f, -0.f }, { 1e-7f, -1e-7f }, { 0.f, 0.f }, { -0.f, 1e-7f }, { 0.f, -1.f } };
+		for (const auto& direction : degenerateDirections)
+		{
+			buffers.directionX.push_back(direction[0]);
+			buffers.directionY.push_back(direction[1]);
+		}
+		// A sweep around the circle, the odd count also runs the scalar tail
+		for (uint32_t i = 0; i < 61; ++i)
+		{
+			const float angle = static_cast<float>(i) * 0.1031f;
+			buffers.directionX.push_back(cosf(angle) * (1.f + i));
+			buffers.directionY.push_back(sinf(angle) * (1.f + i));
+		}
+
+		const uint32_t count = static_cast<uint32_t>(buffers.directionX.size());
+		buffers.rotationW.resize(count);
+		buffers.rotationZ.resize(count);
+		PlayerKernels::ComputeFacingRotations(buffers.directionX.data(), buffers.directionY.data(), buffers.rotationW.data(), buffers.rotationZ.data(), count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			float rotationW, rotationZ;
+			PlayerKernels::ComputeFacingRotation(buffers.directionX[i], buffers.directionY[i], rotationW, rotationZ);
+			if (std::fabs(rotationW - buffers.rotationW[i]) > 1e-5f || std::fabs(rotationZ - buffers.rotationZ[i]) > 1e-5f)
+			{
+				printf("Facing mismatch: direction (%g, %g) gives (%f, %f) batched, (%f, %f) per character\n", buffers.directionX[i], buffers.directionY[i],
+					buffers.rotationW[i], buffers.rotationZ[i], rotationW, rotationZ);
+				exit(1);
+			}
+		}
+	}
+
+	// One simulated second of player movement at the render frame rate, either an update per frame like the
+	// variable timestep or fixed ticks paid out by the simulation clock like CSimulationClock.
+	void SimulateSecond(std::vector<SStubPlayer>& players, float framesPerSecond, float ticksPerSecond, SimulationKernels::CFixedTimestep& timestep)
+	{
+		const uint32_t frameCount = static_cast<uint32_t>(framesPerSecond);
+		const float frameTime = 1.f / framesPerSecond;
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			if (ticksPerSecond <= 0.f)
+			{
+				UpdateMovementRequests(players, frameTime);
+				continue;
+			}
+
+			timestep.SetTickRate(ticksPerSecond);
+			const uint32_t tickCount = timestep.Advance(frameTime);
+			for (uint32_t tick = 0; tick < tickCount; ++tick)
+			{
+				UpdateMovementRequests(players, timestep.GetTickInterval());
+			}
+		}
+	}
+
+	// The fixed timestep has to run the same number of ticks for the same time at any frame rate, keep the
+	// interpolation fraction within a tick and interpolate yaw the short way round.
+	void CheckFixedTimestep()
+	{
+		const float frameRates[] = { 20.f, 30.f, 60.f, 144.f, 240.f };
+		for (const float frameRate : frameRates)
+		{
+			SimulationKernels::CFixedTimestep timestep;
+			timestep.SetTickRate(30.f);
+			uint32_t ticks = 0;
+			for (uint32_t frame = 0; frame < static_cast<uint32_t>(frameRate) * 10; ++frame)
+			{
+				// Jitter the frame time by up to a third, the total still adds up to ten seconds
+				const float jitter = (frame & 1) != 0 ? 1.f / 3.f : -1.f / 3.f;
+				ticks += timestep.Advance((1.f + jitter) / frameRate);
+				const float alpha = timestep.GetInterpolationAlpha();
+				if (alpha < 0.f || alpha >= 1.f)
+				{
+					printf("Fixed timestep mismatch: interpolation fraction %f at %.0f fps\n", alpha, frameRate);
+					exit(1);
+				}
+			}
+			if (ticks < 299 || ticks > 300)
+			{
+				printf("Fixed timestep mismatch: %u ticks in ten seconds at %.0f fps, expected 300\n", ticks, frameRate);
+				exit(1);
+			}
+		}
+
+		SimulationKernels::STransformInterpolator interpolator;
+		interpolator.PushTick(0.f, 0.f, 0.f, 3.0f, 0.1f);
+		interpolator.PushTick(1.f, 0.f, 0.f, -3.0f, 0.1f);
+		interpolator.Advance(0.05f);
+		float x, y, z, yaw;
+		interpolator.Evaluate(x, y, z, yaw);
+		if (std::fabs(x - 0.5f) > 1e-4f || std::fabs(std::remainder(yaw - 3.14159265f, 6.28318531f)) > 1e-3f)
+		{
+			printf("Fixed timestep mismatch: interpolated to %f and yaw %f, expected 0.5 and pi\n", x, yaw);
+			exit(1);
+		}
+	}
+
+	// Stands in for the engine's job manager, a fixed set of worker threads that run the batches of a parallel for.
+	class CStubJobManager
+	{
+	public:
+		explicit CStubJobManager(uint32_t workerCount)
+		{
+			for (uint32_t i = 0; i < workerCount; ++i)
+			{
+				m_workers.emplace_back([this]() { WorkerLoop(); });
+			}
+		}
+
+		~CStubJobManager()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_isStopping = true;
+			}
+			m_wakeUp.notify_all();
+			for (std::thread& worker : m_workers)
+			{
+				worker.join();
+			}
+		}
+
+		uint32_t GetNumWorkerThreads() const { return static_cast<uint32_t>(m_workers.size()); }
+
+		// Runs function(batch) for every batch on the workers and the calling thread, returns once all batches are done.
+		void ParallelFor(uint32_t batchCount, const std::function<void(uint32_t)>& function)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				// A worker may still be leaving the previous parallel for
+				m_idle.wait(lock, [this]() { return m_activeWorkers == 0; });
+				m_pFunction = &function;
+				m_batchCount = batchCount;
+				m_nextBatch.store(0);
+				m_pendingBatches.store(batchCount);
+				++m_generation;
+			}
+			m_wakeUp.notify_all();
+
+			RunBatches();
+			while (m_pendingBatches.load(std::memory_order_acquire) != 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		void RunBatches()
+		{
+			for (;;)
+			{
+				const uint32_t batch = m_nextBatch.fetch_add(1);
+				if (batch >= m_batchCount)
+					return;
+
+				(*m_pFunction)(batch);
+				m_pendingBatches.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		void WorkerLoop()
+		{
+			uint64_t seenGeneration = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wakeUp.wait(lock, [&]() { return m_isStopping || m_generation != seenGeneration; });
+					if (m_isStopping)
+						return;
+					seenGeneration = m_generation;
+					++m_activeWorkers;
+				}
+
+				RunBatches();
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					--m_activeWorkers;
+				}
+				m_idle.notify_one();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeUp;
+		std::condition_variable m_idle;
+		const std::function<void(uint32_t)>* m_pFunction = nullptr;
+		uint32_t m_batchCount = 0;
+		std::atomic<uint32_t> m_nextBatch{ 0 };
+		std::atomic<uint32_t> m_pendingBatches{ 0 };
+		uint64_t m_generation = 0;
+		uint32_t m_activeWorkers = 0;
+		bool m_isStopping = false;
+	};
+
+	// A player as CPlayerUpdateSystem sees it, with what the prepare pass read and the compute pass produced.
+	struct SStubJobPlayer
+	{
+		SStubEntity entity;
+		CStubCharacterController characterController;
+		uint8_t inputFlags = 0;
+		bool isTopDown = true;
+		bool isRemote = false;
+		SimulationKernels::STransformInterpolator remotePresentation;
+
+		// Pending update, see CPlayerComponent::SPendingUpdate.
+		bool isOnGround = false;
+		uint32_t tickCount = 0;
+		float tickInterval = 0.f;
+		float velocityX = 0.f;
+		float velocityY = 0.f;
+		float remotePosition[3] = { 0.f, 0.f, 0.f };
+		// Camera rotation the compute pass wants pushed, as a quaternion.
+		float cameraRotation[4] = { 1.f, 0.f, 0.f, 0.f };
+		float pushedCameraRotation[4] = { 1.f, 0.f, 0.f, 0.f };
+	};
+
+	std::vector<SStubJobPlayer> CreateJobPlayers(uint32_t count)
+	{
+		std::vector<SStubJobPlayer> players(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			SStubJobPlayer& player = players[i];
+			player.entity.position = { static_cast<float>(i % 100), static_cast<float>(i / 100), 0.f };
+			player.entity.rotationW = 1.f;
+			player.entity.rotationZ = 0.f;
+			player.isTopDown = (i % 4) != 0;
+			// Every eighth player is simulated on another machine
+			player.isRemote = (i % 8) == 7;
+			player.remotePresentation.PushTick(player.entity.position.x, player.entity.position.y, 0.f, 0.f, 1.f / 30.f);
+			player.remotePresentation.PushTick(player.entity.position.x + 0.2f, player.entity.position.y, 0.f, 0.5f, 1.f / 30.f);
+		}
+		return players;
+	}
+
+	// Mirrors CPlayerComponent::PrepareUpdate, input and engine reads on the main thread.
+	void PrepareJobPlayer(SStubJobPlayer& player, uint64_t frame, float tickInterval)
+	{
+		const uint8_t flag = static_cast<uint8_t>(1u << (frame & 3));
+		player.inputFlags = PlayerKernels::ApplyInputFlagChange<uint8_t>(player.inputFlags, flag, false, false);
+		player.inputFlags = PlayerKernels::ApplyInputFlagChange<uint8_t>(player.inputFlags, static_cast<uint8_t>(flag << 1), true, false);
+		player.isOnGround = player.characterController.IsOnGround();
+		player.tickCount = player.isRemote ? 0 : 1;
+		player.tickInterval = tickInterval;
+	}
+
+	// Mirrors CPlayerComponent::ComputeUpdate, touches nothing but the player.
+	void ComputeJobPlayer(SStubJobPlayer& player, float frameTime)
+	{
+		float rotationW = player.entity.rotationW;
+		float rotationZ = player.entity.rotationZ;
+		if (player.isRemote)
+		{
+			player.remotePresentation.Advance(frameTime);
+			float yaw;
+			player.remotePresentation.Evaluate(player.remotePosition[0], player.remotePosition[1], player.remotePosition[2], yaw);
+			rotationW = cosf(yaw * 0.5f);
+			rotationZ = sinf(yaw * 0.5f);
+		}
+		else if (player.tickCount > 0)
+		{
+			const PlayerKernels::SPlanarVelocity velocity = PlayerKernels::ComputeMovementVelocity(player.isOnGround ? player.inputFlags : 0, player.isTopDown, 20.5f, player.tickInterval);
+			player.velocityX = velocity.x;
+			player.velocityY = velocity.y;
+		}
+
+		// Top down camera, the inverted player rotation times a rotation of -90 degrees about X
+		const float halfAngle = -0.785398163f;
+		const float pitchW = cosf(halfAngle);
+		const float pitchX = sinf(halfAngle);
+		player.cameraRotation[0] = rotationW * pitchW;
+		player.cameraRotation[1] = rotationW * pitchX;
+		player.cameraRotation[2] = rotationZ * pitchX;
+		player.cameraRotation[3] = -rotationZ * pitchW;
+	}
+
+	// Mirrors CPlayerComponent::ApplyUpdate, the engine writes on the main thread.
+	void ApplyJobPlayer(SStubJobPlayer& player)
+	{
+		if (player.isRemote)
+		{
+			player.entity.position = { player.remotePosition[0], player.remotePosition[1], player.remotePosition[2] };
+		}
+		for (uint32_t tick = 0; tick < player.tickCount; ++tick)
+		{
+			player.characterController.AddVelocity({ player.velocityX, player.velocityY, 0.f });
+		}
+		for (int i = 0; i < 4; ++i)
+		{
+			player.pushedCameraRotation[i] = player.cameraRotation[i];
+		}
+	}
+
+	// Mirrors CPlayerUpdateSystem::Update, or the players updating themselves one after the other without a job manager.
+	void UpdateJobPlayers(std::vector<SStubJobPlayer>& players, uint64_t frame, float frameTime, CStubJobManager* pJobManager)
+	{
+		for (SStubJobPlayer& player : players)
+		{
+			PrepareJobPlayer(player, frame, frameTime);
+		}
+
+		const uint32_t playerCount = static_cast<uint32_t>(players.size());
+		const uint32_t batchCount = pJobManager != nullptr ? PlayerKernels::ComputeBatchCount(playerCount, 16, pJobManager->GetNumWorkerThreads() + 1) : 1;
+		if (batchCount > 1)
+		{
+			pJobManager->ParallelFor(batchCount, [&](uint32_t batch)
+			{
+				uint32_t begin, end;
+				PlayerKernels::GetBatchRange(playerCount, batchCount, batch, begin, end);
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					ComputeJobPlayer(players[i], frameTime);
+				}
+			});
+		}
+		else
+		{
+			for (SStubJobPlayer& player : players)
+			{
+				ComputeJobPlayer(player, frameTime);
+			}
+		}
+
+		for (SStubJobPlayer& player : players)
+		{
+			ApplyJobPlayer(player);
+		}
+	}
+
+	// The batches have to cover every player exactly once, and the job update has to end in exactly the same
+	// state as updating the players one after the other.
+	void CheckJobPlayerUpdate(CStubJobManager& jobManager)
+	{
+		for (uint32_t count = 1; count < 200; count += 7)
+		{
+			for (uint32_t batchCount = 1; batchCount <= 9; ++batchCount)
+			{
+				uint32_t expectedBegin = 0;
+				for (uint32_t batch = 0; batch < batchCount; ++batch)
+				{
+					uint32_t begin, end;
+					PlayerKernels::GetBatchRange(count, batchCount, batch, begin, end);
+					if (begin != expectedBegin || end < begin || end - begin > count / batchCount + 1)
+					{
+						printf("Player job mismatch: batch %u of %u over %u players is [%u, %u)\n", batch, batchCount, count, begin, end);
+						exit(1);
+					}
+					expectedBegin = end;
+				}
+				if (expectedBegin != count)
+				{
+					printf("Player job mismatch: %u batches cover %u of %u players\n", batchCount, expectedBegin, count);
+					exit(1);
+				}
+			}
+		}
+
+		const float frameTime = 1.f / 60.f;
+		std::vector<SStubJobPlayer> serialPlayers = CreateJobPlayers(1000);
+		std::vector<SStubJobPlayer> jobPlayers = CreateJobPlayers(1000);
+		for (uint64_t frame = 0; frame < 16; ++frame)
+		{
+			UpdateJobPlayers(serialPlayers, frame, frameTime, nullptr);
+			UpdateJobPlayers(jobPlayers, frame, frameTime, &jobManager);
+		}
+
+		for (size_t i = 0; i < serialPlayers.size(); ++i)
+		{
+			const SStubJobPlayer& serial = serialPlayers[i];
+			const SStubJobPlayer& job = jobPlayers[i];
+			const bool isSame = serial.entity.position.x == job.entity.position.x && serial.entity.position.y == job.entity.position.y
+				&& serial.characterController.GetVelocity().x == job.characterController.GetVelocity().x
+				&& serial.characterController.GetVelocity().y == job.characterController.GetVelocity().y
+				&& serial.pushedCameraRotation[0] == job.pushedCameraRotation[0] && serial.pushedCameraRotation[3] == job.pushedCameraRotation[3];
+			if (!isSame)
+			{
+				printf("Player job mismatch: player %zu differs between the serial and the job update\n", i);
+				exit(1);
+			}
+		}
+	}
+
+	float Checksum(const std::vector<SStubJobPlayer>& players)
+	{
+		float sum = 0.f;
+		for (const SStubJobPlayer& player : players)
+		{
+			sum += player.characterController.GetVelocity().x + player.entity.position.x + player.pushedCameraRotation[0];
+		}
+		return sum;
+	}
+
+	float Checksum(const std::vector<SStubPlayer>& players)
+	{
+		float sum = 0.f;
+		for (const SStubPlayer& player : players)
+		{
+			sum += player.characterController.GetVelocity().x + player.characterController.GetVelocity().y + player.entity.rotationW + player.entity.rotationZ + player.inputFlags;
+		}
+		return sum;
+	}
+}
+
+void RunPlayerKernelBenchmarks(const SBenchmarkOptions& options)
+{
+	CheckFacingRotations();
+	PrintBenchmarkHeader("Player kernels (ns per player)");
+	const float frameTime = 1.f / 60.f;
+
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		std::vector<SStubPlayer> players = CreatePlayers(playerCount);
+
+		double nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame) { HandleInputFlagChanges(players, frame); });
+		PrintBenchmarkResult("HandleInputFlagChange", playerCount, nanoseconds);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t) { UpdateMovementRequests(players, frameTime); });
+		PrintBenchmarkResult("UpdateMovementRequest", playerCount, nanoseconds);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t) { UpdateFacingPerCharacter(players); });
+		PrintBenchmarkResult("Facing per character", playerCount, nanoseconds);
+
+		SFacingBuffers facingBuffers;
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t) { UpdateFacingBatched(players, facingBuffers); });
+		PrintBenchmarkResult("Facing batched", playerCount, nanoseconds);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame)
+		{
+			HandleInputFlagChanges(players, frame);
+			UpdateMovementRequests(players, frameTime);
+			UpdateFacingBatched(players, facingBuffers);
+		});
+		PrintBenchmarkResult("Full player update", playerCount, nanoseconds);
+
+		g_benchmarkSink = g_benchmarkSink + Checksum(players);
+	}
+
+	// Server cost of one simulated second: per frame it grows with the frame rate, fixed ticks do not
+	CheckFixedTimestep();
+	PrintBenchmarkHeader("Player movement per simulated second (ns per player)");
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		std::vector<SStubPlayer> players = CreatePlayers(playerCount);
+		SimulationKernels::CFixedTimestep timestep;
+
+		double nanoseconds = MeasureNanosecondsPerOperation(options, playerCount * 144, [&](uint64_t) { SimulateSecond(players, 144.f, 0.f, timestep); });
+		PrintBenchmarkResult("Per frame at 144 fps", playerCount, nanoseconds * 144);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount * 144, [&](uint64_t) { SimulateSecond(players, 144.f, 30.f, timestep); });
+		PrintBenchmarkResult("Fixed 30 Hz at 144 fps", playerCount, nanoseconds * 144);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount * 144, [&](uint64_t) { SimulateSecond(players, 144.f, 20.f, timestep); });
+		PrintBenchmarkResult("Fixed 20 Hz at 144 fps", playerCount, nanoseconds * 144);
+
+		g_benchmarkSink = g_benchmarkSink + Checksum(players);
+	}
+
+	// Main thread time of the whole player update: computed in jobs it should stay flat per frame with enough cores
+	const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	CStubJobManager jobManager(std::min(workerCount, 32u));
+	CheckJobPlayerUpdate(jobManager);
+	PrintBenchmarkHeader("Player update main thread (ns per player)");
+	char jobName[64];
+	snprintf(jobName, sizeof(jobName), "Jobs on %u workers", jobManager.GetNumWorkerThreads());
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		std::vector<SStubJobPlayer> players = CreateJobPlayers(playerCount);
+
+		double nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame) { UpdateJobPlayers(players, frame, frameTime, nullptr); });
+		PrintBenchmarkResult("Serial per player", playerCount, nanoseconds);
+
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame) { UpdateJobPlayers(players, frame, frameTime, &jobManager); });
+		PrintBenchmarkResult(jobName, playerCount, nanoseconds);
+
+		g_benchmarkSink = g_benchmarkSink + Checksum(players);
+	}
+}
@@ -0,0 +1,257 @@
+#include "BenchmarkHarness.h"
+#include "Core/PlayerSnapshot.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// Frames of the recorded movement, players walk one circle in this many ticks so that the recording loops seamlessly
+	const uint32_t SnapshotFrameCount = 64;
+	const float SnapshotTwoPi = 6.28318531f;
+
+	// A mix of what a match looks like: half the players walk in circles and turn, a quarter stand and turn on the spot,
+	// a quarter idle. Every player fires and reloads now and then, and a few switch camera.
+	NetKernels::SPlayerState CreatePlayerState(uint32_t player, uint32_t frame)
+	{
+		const float angle = SnapshotTwoPi * static_cast<float>(frame % SnapshotFrameCount) / SnapshotFrameCount;
+		const uint32_t behaviour = player % 4;
+
+		NetKernels::SPlayerState state;
+		state.playerId = player + 1;
+		// Kept away from the level edge, the walking players circle around these points
+		state.positionX = 16.f + ScatterCoordinate(player, 1, 400.f);
+		state.positionY = 16.f + ScatterCoordinate(player, 2, 400.f);
+		state.positionZ = 32.f;
+		state.yaw = 0.f;
+		state.inputFlags = 0;
+		state.selection = static_cast<uint8_t>(player & 1);
+		state.regularAmmo = 5;
+		state.waterAmmo = 5;
+		state.cameraMode = 3;
+
+		if (behaviour < 2)
+		{
+			// About 5 m/s at 30 ticks per second
+			state.positionX += cosf(angle + player) * 1.7f;
+			state.positionY += sinf(angle + player) * 1.7f;
+			state.yaw = angle + player;
+			state.inputFlags = static_cast<uint8_t>(1 << ((frame / 16 + player) % 4));
+		}
+		else if (behaviour == 2)
+		{
+			state.yaw = angle;
+		}
+
+		state.regularAmmo = static_cast<uint8_t>(5 - (frame + player) / 8 % 6);
+		state.cameraMode = (frame + player) % 60 < 30 || player % 16 != 0 ? 3 : 4;
+		// Keep the yaw in -pi to pi like the entity rotation
+		state.yaw = state.yaw - SnapshotTwoPi * std::floor((state.yaw + 3.14159265f) / SnapshotTwoPi);
+		return state;
+	}
+
+	std::vector<NetKernels::SPlayerState> CreateFrames(uint32_t playerCount)
+	{
+		std::vector<NetKernels::SPlayerState> frames(static_cast<size_t>(playerCount) * SnapshotFrameCount);
+		for (uint32_t frame = 0; frame < SnapshotFrameCount; ++frame)
+		{
+			for (uint32_t player = 0; player < playerCount; ++player)
+			{
+				frames[frame * playerCount + player] = CreatePlayerState(player, frame);
+			}
+		}
+		return frames;
+	}
+
+	void FailSnapshotCheck(const char* szMessage, uint32_t playerCount, uint32_t tick)
+	{
+		printf("Player snapshot mismatch: %s (%u players, tick %u)\n", szMessage, playerCount, tick);
+		exit(1);
+	}
+
+	// Quantization error has to stay within half a step of every field.
+	void CheckQuantization(const NetKernels::SLevelGrid& grid, const NetKernels::SPlayerState& state, uint32_t playerCount, uint32_t tick)
+	{
+		const NetKernels::SPlayerState decoded = NetKernels::DequantizePlayerState(grid, NetKernels::QuantizePlayerState(grid, state));
+		const float positionTolerance = grid.extent / static_cast<float>((1u << NetKernels::SnapshotPositionBits) - 1) * 0.5f + 0.001f;
+		const float yawError = std::fabs(std::remainder(decoded.yaw - state.yaw, SnapshotTwoPi));
+		if (std::fabs(decoded.positionX - state.positionX) > positionTolerance || std::fabs(decoded.positionY - state.positionY) > positionTolerance
+			|| std::fabs(decoded.positionZ - state.positionZ) > positionTolerance || yawError > SnapshotTwoPi / 65536.f)
+		{
+			FailSnapshotCheck("quantization error above half a step", playerCount, tick);
+		}
+		if (decoded.playerId != state.playerId || decoded.inputFlags != state.inputFlags || decoded.selection != state.selection || decoded.regularAmmo != state.regularAmmo
+			|| decoded.waterAmmo != state.waterAmmo || decoded.cameraMode != state.cameraMode)
+		{
+			FailSnapshotCheck("exact fields changed", playerCount, tick);
+		}
+	}
+
+	// Sends snapshots for a few seconds with acknowledgements arriving late and some snapshots lost, and checks that
+	// every delivered snapshot decodes to exactly what the sender quantized. Players join and leave along the way,
+	// and a slot in the middle is emptied and taken over by another player.
+	// Returns the average delta snapshot bytes per player.
+	double RunSnapshotRoundTrip(uint32_t playerCount, const std::vector<NetKernels::SPlayerState>& frames)
+	{
+		const NetKernels::SLevelGrid grid;
+		NetKernels::CSnapshotSender sender(grid);
+		NetKernels::CSnapshotReceiver receiver(grid);
+		std::vector<uint8_t> packet;
+		std::vector<NetKernels::SPlayerState> decoded;
+		std::vector<NetKernels::SPlayerState> states;
+		// Acknowledgements take three ticks back to the server
+		const uint32_t ackLatency = 3;
+		std::vector<uint16_t> pendingAcks;
+		uint64_t deltaBytes = 0;
+		uint64_t deltaPlayers = 0;
+
+		const uint32_t tickCount = SnapshotFrameCount * 3;
+		for (uint32_t tick = 0; tick < tickCount; ++tick)
+		{
+			// One player joins at the end for a while and leaves again
+			const uint32_t count = playerCount + ((tick / 20) % 2);
+			states.assign(frames.begin() + (tick % SnapshotFrameCount) * playerCount, frames.begin() + (tick % SnapshotFrameCount + 1) * playerCount);
+			if (count > playerCount)
+			{
+				NetKernels::SPlayerState joined = CreatePlayerState(playerCount, tick);
+				// Standing on the edge of the grid and facing exactly backwards tests the clamping and the yaw wrap
+				joined.positionX = grid.originX + grid.extent + 10.f;
+				joined.yaw = (tick & 1) ? 3.14159265f : -3.14159265f;
+				states.push_back(joined);
+			}
+			if (playerCount > 1)
+			{
+				NetKernels::SPlayerState& reused = states[playerCount / 2];
+				const uint32_t phase = (tick / 24) % 3;
+				if (phase == 1)
+				{
+					reused = NetKernels::SPlayerState();
+				}
+				else if (phase == 2)
+				{
+					// Same entity index with another salt, like an entity spawned into a freed index
+					reused.playerId += 0x10000;
+				}
+			}
+
+			sender.Encode(states.data(), count, packet);
+
+			// Every seventh snapshot is lost on the way
+			if (tick % 7 == 6)
+				continue;
+
+			uint16_t sequence = 0;
+			if (!receiver.Decode(packet.data(), static_cast<uint32_t>(packet.size()), decoded, sequence))
+				FailSnapshotCheck("snapshot could not be decoded", playerCount, tick);
+
+			if (decoded.size() != count)
+				FailSnapshotCheck("player count changed", playerCount, tick);
+
+			const std::vector<NetKernels::SQuantizedPlayerState>* pQuantized = receiver.GetQuantizedStates(sequence);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				NetKernels::SPlayerState expected = states[i];
+				expected.positionX = std::fmin(expected.positionX, grid.originX + grid.extent);
+				if ((*pQuantized)[i] != NetKernels::QuantizePlayerState(grid, states[i]))
+					FailSnapshotCheck("decoded state differs from the sent state", playerCount, tick);
+
+				CheckQuantization(grid, expected, playerCount, tick);
+			}
+
+			// Steady state is after the first acknowledgement arrived
+			if (tick > ackLatency)
+			{
+				deltaBytes += packet.size();
+				deltaPlayers += count;
+			}
+
+			pendingAcks.push_back(sequence);
+			if (pendingAcks.size() > ackLatency)
+			{
+				sender.Acknowledge(pendingAcks.front());
+				pendingAcks.erase(pendingAcks.begin());
+			}
+		}
+
+		return static_cast<double>(deltaBytes) / static_cast<double>(deltaPlayers);
+	}
+
+	// A packet that claims more players than it has bytes for must be rejected before anything is sized by it.
+	void CheckTruncatedSnapshot()
+	{
+		std::vector<uint8_t> packet;
+		NetKernels::CBitWriter writer(packet);
+		writer.WriteBits(1, 16);
+		writer.WriteBool(false);
+		writer.WriteBits(0xFFFF, 16);
+		// A few players worth of bytes, far fewer than the count claims
+		writer.WriteBits(0, 32);
+
+		NetKernels::CSnapshotReceiver receiver;
+		std::vector<NetKernels::SPlayerState> decoded;
+		uint16_t sequence = 0;
+		if (receiver.Decode(packet.data(), static_cast<uint32_t>(packet.size()), decoded, sequence) || !decoded.empty())
+			FailSnapshotCheck("truncated snapshot was accepted", 0xFFFF, 0);
+	}
+}
+
+void RunPlayerSnapshotBenchmarks(const SBenchmarkOptions& options)
+{
+	CheckTruncatedSnapshot();
+
+	printf("\n== Player snapshot size (bytes per player per tick) ==\n");
+	printf("%-32s %10s %14s\n", "Snapshot", "Players", "bytes");
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		const std::vector<NetKernels::SPlayerState> frames = CreateFrames(playerCount);
+
+		NetKernels::CSnapshotSender sender;
+		std::vector<uint8_t> packet;
+		sender.Encode(frames.data(), playerCount, packet);
+		printf("%-32s %10u %14.2f\n", "Full", playerCount, static_cast<double>(packet.size()) / playerCount);
+		printf("%-32s %10u %14.2f\n", "Delta, 3 tick ack latency", playerCount, RunSnapshotRoundTrip(playerCount, frames));
+	}
+
+	PrintBenchmarkHeader("Player snapshot codec (ns per player)");
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		const std::vector<NetKernels::SPlayerState> frames = CreateFrames(playerCount);
+		std::vector<uint8_t> packet;
+		std::vector<NetKernels::SPlayerState> decoded;
+		uint16_t sequence = 0;
+
+		// Without acknowledgements every snapshot is sent in full
+		NetKernels::CSnapshotSender fullSender;
+		double nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame)
+		{
+			fullSender.Encode(&frames[(frame % SnapshotFrameCount) * playerCount], playerCount, packet);
+		});
+		PrintBenchmarkResult("Encode full", playerCount, nanoseconds);
+
+		// Acknowledged right away, every snapshot is a delta against the previous one
+		NetKernels::CSnapshotSender deltaSender;
+		uint16_t nextSequence = 0;
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame)
+		{
+			deltaSender.Encode(&frames[(frame % SnapshotFrameCount) * playerCount], playerCount, packet);
+			deltaSender.Acknowledge(nextSequence++);
+		});
+		PrintBenchmarkResult("Encode delta", playerCount, nanoseconds);
+
+		// Decoding the same delta again and again, its baseline stays in the receiver history
+		NetKernels::CSnapshotSender sender;
+		NetKernels::CSnapshotReceiver receiver;
+		sender.Encode(&frames[0], playerCount, packet);
+		receiver.Decode(packet.data(), static_cast<uint32_t>(packet.size()), decoded, sequence);
+		sender.Acknowledge(sequence);
+		sender.Encode(&frames[playerCount], playerCount, packet);
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t)
+		{
+			receiver.Decode(packet.data(), static_cast<uint32_t>(packet.size()), decoded, sequence);
+		});
+		PrintBenchmarkResult("Decode delta", playerCount, nanoseconds);
+
+		g_benchmarkSink = g_benchmarkSink + decoded[0].positionX;
+	}
+}
@@ -0,0 +1,323 @@
+#include "BenchmarkHarness.h"
+#include "Core/TriggerBroadphase.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// Scripted triggers in a level of a few hundred meters, the number the levels are expected to need.
+	const uint32_t BenchmarkTriggerCount = 512;
+	const float LevelSize = 400.f;
+	const float ProximityCellSize = 8.f;
+
+	TriggerKernels::SBounds MakeBox(float x, float y, float halfSize)
+	{
+		return TriggerKernels::SBounds { x - halfSize, y - halfSize, -halfSize, x + halfSize, y + halfSize, halfSize };
+	}
+
+	std::vector<TriggerKernels::SBounds> CreateTriggers()
+	{
+		std::vector<TriggerKernels::SBounds> triggers(BenchmarkTriggerCount);
+		for (uint32_t i = 0; i < BenchmarkTriggerCount; ++i)
+		{
+			// The 2m boxes of CLevelChangeTriggerComponent, with a few larger preload volumes mixed in
+			triggers[i] = MakeBox(ScatterCoordinate(i, 1, LevelSize), ScatterCoordinate(i, 2, LevelSize), (i % 8) == 0 ? 20.f : 1.f);
+		}
+		return triggers;
+	}
+
+	// Players walk in circles so that they keep entering and leaving triggers.
+	void MovePlayers(std::vector<TriggerKernels::SBounds>& players, uint64_t frame)
+	{
+		const float angle = static_cast<float>(frame) * 0.05f;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(players.size()); ++i)
+		{
+			const float x = ScatterCoordinate(i, 3, LevelSize) + cosf(angle + i) * 6.f;
+			const float y = ScatterCoordinate(i, 4, LevelSize) + sinf(angle + i) * 6.f;
+			// Roughly the bounds of the character controller capsule
+			players[i] = TriggerKernels::SBounds { x - 0.4f, y - 0.4f, 0.f, x + 0.4f, y + 0.4f, 1.8f };
+		}
+	}
+
+	// Stand-in for the engine's per-entity approach: every trigger is its own object registered in a proximity grid,
+	// keeps its own list of entities inside and handles each enter and leave in a virtual callback that looks the
+	// entity and its player component up again, like CLevelChangeTriggerComponent::ProcessEvent.
+	struct SStubPlayerComponent
+	{
+		int cameraSelection = 3;
+	};
+
+	class CStubTriggerEntity
+	{
+	public:
+		CStubTriggerEntity(const TriggerKernels::SBounds& bounds, std::unordered_map<uint32_t, SStubPlayerComponent>& players)
+			: m_bounds(bounds)
+			, m_players(players)
+		{
+		}
+		virtual ~CStubTriggerEntity() = default;
+
+		const TriggerKernels::SBounds& GetBounds() const { return m_bounds; }
+
+		void TestEntity(uint32_t entityId, const TriggerKernels::SBounds& entityBounds, uint64_t frame)
+		{
+			auto it = m_inside.find(entityId);
+			if (TriggerKernels::Overlaps(m_bounds, entityBounds))
+			{
+				if (it == m_inside.end())
+				{
+					m_inside.emplace(entityId, frame);
+					OnEnterArea(entityId);
+				}
+				else
+				{
+					it->second = frame;
+				}
+			}
+			else if (it != m_inside.end() && it->second != frame)
+			{
+				m_inside.erase(it);
+				OnLeaveArea(entityId);
+			}
+		}
+
+		virtual void OnEnterArea(uint32_t entityId)
+		{
+			auto it = m_players.find(entityId);
+			if (it != m_players.end())
+			{
+				it->second.cameraSelection = 4;
+			}
+		}
+
+		virtual void OnLeaveArea(uint32_t entityId)
+		{
+			auto it = m_players.find(entityId);
+			if (it != m_players.end())
+			{
+				it->second.cameraSelection = 3;
+			}
+		}
+
+	private:
+		TriggerKernels::SBounds m_bounds;
+		std::unordered_map<uint32_t, SStubPlayerComponent>& m_players;
+		// Entities inside and the last frame they were seen overlapping.
+		std::unordered_map<uint32_t, uint64_t> m_inside;
+	};
+
+	// Ordered so that the events of the broadphase and of the reference can be compared as sorted lists.
+	bool IsEventBefore(const TriggerKernels::SOverlapEvent& a, const TriggerKernels::SOverlapEvent& b)
+	{
+		if (a.playerId != b.playerId)
+			return a.playerId < b.playerId;
+		if (a.triggerId != b.triggerId)
+			return a.triggerId < b.triggerId;
+		return a.isEnter < b.isEnter;
+	}
+
+	// Every enter and leave event has to match testing every player against every trigger, across moving players
+	// and triggers removed mid run, down to the last trigger.
+	// With small cells the preload volumes are too large for the cells and take the large trigger path.
+	void CheckOverlapEvents(const std::vector<TriggerKernels::SBounds>& triggers, float cellSize)
+	{
+		const uint32_t playerCount = 100;
+		std::vector<TriggerKernels::SBounds> players(playerCount);
+		std::vector<uint32_t> playerIds(playerCount);
+		for (uint32_t i = 0; i < playerCount; ++i)
+		{
+			playerIds[i] = i + 1;
+		}
+
+		TriggerKernels::CTriggerBroadphase broadphase(cellSize);
+		std::vector<bool> isTriggerAlive(triggers.size(), true);
+		for (uint32_t i = 0; i < static_cast<uint32_t>(triggers.size()); ++i)
+		{
+			broadphase.AddTrigger(i, triggers[i]);
+		}
+
+		// Overlaps of the last frame per player, kept as a flag per trigger
+		std::vector<std::vector<bool>> wasInside(playerCount, std::vector<bool>(triggers.size(), false));
+		std::vector<TriggerKernels::SOverlapEvent> events, expectedEvents;
+		const uint64_t frameCount = 200;
+		for (uint64_t frame = 0; frame < frameCount; ++frame)
+		{
+			// The second half removes a share of the triggers every frame, the last frame has none left
+			if (frame >= frameCount / 2)
+			{
+				const uint32_t removePerFrame = static_cast<uint32_t>(triggers.size() / (frameCount / 2 - 1)) + 1;
+				for (uint32_t trigger = 0, removed = 0; trigger < static_cast<uint32_t>(triggers.size()) && removed < removePerFrame; ++trigger)
+				{
+					if (isTriggerAlive[trigger])
+					{
+						broadphase.RemoveTrigger(trigger);
+						isTriggerAlive[trigger] = false;
+						++removed;
+					}
+				}
+			}
+
+			MovePlayers(players, frame);
+			events.clear();
+			broadphase.Update(playerIds.data(), players.data(), playerCount, events);
+
+			expectedEvents.clear();
+			for (uint32_t i = 0; i < playerCount; ++i)
+			{
+				for (uint32_t trigger = 0; trigger < static_cast<uint32_t>(triggers.size()); ++trigger)
+				{
+					const bool isInside = isTriggerAlive[trigger] && TriggerKernels::Overlaps(players[i], triggers[trigger]);
+					if (isInside != wasInside[i][trigger])
+					{
+						expectedEvents.push_back(TriggerKernels::SOverlapEvent { playerIds[i], trigger, isInside });
+						wasInside[i][trigger] = isInside;
+					}
+				}
+			}
+
+			std::sort(events.begin(), events.end(), IsEventBefore);
+			std::sort(expectedEvents.begin(), expectedEvents.end(), IsEventBefore);
+			bool isMatch = events.size() == expectedEvents.size();
+			for (size_t i = 0; isMatch && i < events.size(); ++i)
+			{
+				isMatch = events[i].playerId == expectedEvents[i].playerId && events[i].triggerId == expectedEvents[i].triggerId && events[i].isEnter == expectedEvents[i].isEnter;
+			}
+			if (!isMatch)
+			{
+				printf("Trigger broadphase event mismatch in frame %u: %u events, expected %u\n", static_cast<uint32_t>(frame),
+					static_cast<uint32_t>(events.size()), static_cast<uint32_t>(expectedEvents.size()));
+				exit(1);
+			}
+		}
+
+		if (broadphase.GetTriggerCount() != 0 || broadphase.HasOverlaps())
+		{
+			printf("Trigger broadphase mismatch: players still inside after the last trigger was removed\n");
+			exit(1);
+		}
+	}
+
+	class CStubProximityGrid
+	{
+	public:
+		void Add(CStubTriggerEntity* pTrigger)
+		{
+			const TriggerKernels::SBounds& bounds = pTrigger->GetBounds();
+			for (int32_t y = ToCell(bounds.minY); y <= ToCell(bounds.maxY); ++y)
+				for (int32_t x = ToCell(bounds.minX); x <= ToCell(bounds.maxX); ++x)
+					m_cells[MakeKey(x, y)].push_back(pTrigger);
+		}
+
+		// Tests a moved entity against the triggers in the cells around it.
+		void OnEntityMoved(uint32_t entityId, const TriggerKernels::SBounds& bounds, uint64_t frame)
+		{
+			for (int32_t y = ToCell(bounds.minY) - 1; y <= ToCell(bounds.maxY) + 1; ++y)
+			{
+				for (int32_t x = ToCell(bounds.minX) - 1; x <= ToCell(bounds.maxX) + 1; ++x)
+				{
+					auto it = m_cells.find(MakeKey(x, y));
+					if (it == m_cells.end())
+						continue;
+
+					for (CStubTriggerEntity* pTrigger : it->second)
+					{
+						pTrigger->TestEntity(entityId, bounds, frame);
+					}
+				}
+			}
+		}
+
+	private:
+		static int32_t ToCell(float coordinate) { return static_cast<int32_t>(std::floor(coordinate / ProximityCellSize)); }
+		static uint64_t MakeKey(int32_t x, int32_t y) { return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y); }
+
+		std::unordered_map<uint64_t, std::vector<CStubTriggerEntity*>> m_cells;
+	};
+}
+
+void RunTriggerBroadphaseBenchmarks(const SBenchmarkOptions& options)
+{
+	const std::vector<TriggerKernels::SBounds> triggers = CreateTriggers();
+	CheckOverlapEvents(triggers, 8.f);
+	CheckOverlapEvents(triggers, 2.f);
+
+	PrintBenchmarkHeader("Trigger broadphase, 512 triggers (ns per player)");
+
+	for (const uint32_t playerCount : options.playerCounts)
+	{
+		std::vector<TriggerKernels::SBounds> players(playerCount);
+		std::vector<uint32_t> playerIds(playerCount);
+		std::unordered_map<uint32_t, SStubPlayerComponent> playerComponents;
+		for (uint32_t i = 0; i < playerCount; ++i)
+		{
+			playerIds[i] = i + 1;
+			playerComponents[playerIds[i]] = SStubPlayerComponent();
+		}
+
+		// Per trigger entities in a proximity grid
+		std::vector<std::unique_ptr<CStubTriggerEntity>> triggerEntities;
+		CStubProximityGrid proximityGrid;
+		for (const TriggerKernels::SBounds& bounds : triggers)
+		{
+			triggerEntities.emplace_back(new CStubTriggerEntity(bounds, playerComponents));
+			proximityGrid.Add(triggerEntities.back().get());
+		}
+
+		double nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame)
+		{
+			MovePlayers(players, frame);
+			for (uint32_t i = 0; i < playerCount; ++i)
+			{
+				proximityGrid.OnEntityMoved(playerIds[i], players[i], frame);
+			}
+		});
+		PrintBenchmarkResult("Per-entity proximity grid", playerCount, nanoseconds);
+
+		// Batched spatial hash
+		TriggerKernels::CTriggerBroadphase broadphase;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(triggers.size()); ++i)
+		{
+			broadphase.AddTrigger(i, triggers[i]);
+		}
+
+		// The batched results have to match testing every trigger before their timings mean anything
+		MovePlayers(players, 0);
+		std::vector<uint32_t> overlaps;
+		for (const TriggerKernels::SBounds& playerBounds : players)
+		{
+			broadphase.QueryOverlaps(playerBounds, overlaps);
+			uint32_t expectedCount = 0;
+			for (const TriggerKernels::SBounds& triggerBounds : triggers)
+			{
+				expectedCount += TriggerKernels::Overlaps(playerBounds, triggerBounds) ? 1 : 0;
+			}
+			if (overlaps.size() != expectedCount)
+			{
+				printf("Trigger broadphase mismatch: %u overlaps, expected %u\n", static_cast<uint32_t>(overlaps.size()), expectedCount);
+				exit(1);
+			}
+		}
+
+		std::vector<TriggerKernels::SOverlapEvent> events;
+		uint64_t eventCount = 0;
+		nanoseconds = MeasureNanosecondsPerOperation(options, playerCount, [&](uint64_t frame)
+		{
+			MovePlayers(players, frame);
+			events.clear();
+			broadphase.Update(playerIds.data(), players.data(), playerCount, events);
+			for (const TriggerKernels::SOverlapEvent& event : events)
+			{
+				playerComponents[event.playerId].cameraSelection = event.isEnter ? 4 : 3;
+			}
+			eventCount += events.size();
+		});
+		PrintBenchmarkResult("Batched spatial hash", playerCount, nanoseconds);
+
+		g_benchmarkSink = g_benchmarkSink + static_cast<float>(eventCount);
+	}
+}
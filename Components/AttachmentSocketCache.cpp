@@ -0,0 +1,48 @@
+#include "StdAfx.h"
+#include "AttachmentSocketCache.h"
+
+void CAttachmentSocketCache::Resolve(ICharacterInstance* pCharacter)
+{
+	m_pCharacter = pCharacter;
+	if (pCharacter == nullptr)
+	{
+		m_attachments.fill(nullptr);
+		return;
+	}
+
+	IAttachmentManager* pAttachmentManager = pCharacter->GetIAttachmentManager();
+	for (size_t i = 0; i < m_attachments.size(); ++i)
+	{
+		m_attachments[i] = pAttachmentManager->GetInterfaceByName(GetSocketName(static_cast<ECharacterSocket>(i)));
+	}
+}
+
+void CAttachmentSocketCache::Invalidate()
+{
+	m_pCharacter.reset();
+	m_attachments.fill(nullptr);
+}
+
+bool CAttachmentSocketCache::GetWorldTransform(ICharacterInstance* pCharacter, ECharacterSocket socket, QuatTS& transform)
+{
+	if (pCharacter != m_pCharacter)
+	{
+		Resolve(pCharacter);
+	}
+
+	if (IAttachment* pAttachment = m_attachments[static_cast<size_t>(socket)])
+	{
+		transform = pAttachment->GetAttWorldAbsolute();
+		return true;
+	}
+	return false;
+}
+
+const char* CAttachmentSocketCache::GetSocketName(ECharacterSocket socket)
+{
+	switch (socket)
+	{
+	case ECharacterSocket::BarrelOut: return "barrel_out";
+	}
+	return "";
+}
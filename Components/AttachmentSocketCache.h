@@ -0,0 +1,34 @@
+#pragma once
+
+#include <CryAnimation/ICryAnimation.h>
+#include <array>
+
+// Character attachments gameplay code needs the world transform of.
+enum class ECharacterSocket : uint8
+{
+	BarrelOut = 0,
+	Count
+};
+
+////////////////////////////////////////////////////////
+// Resolves character attachments by name once per character instance.
+// Lookups afterwards are an array access, and a reloaded character is detected by its instance changing.
+////////////////////////////////////////////////////////
+class CAttachmentSocketCache
+{
+public:
+	// Looks up every socket on the character, sockets the character does not have stay unresolved.
+	void Resolve(ICharacterInstance* pCharacter);
+	// Forgets the resolved sockets, used when the character file is about to be reloaded.
+	void Invalidate();
+
+	// Gets the world space transform of the socket on the character, resolving again if the character changed.
+	bool GetWorldTransform(ICharacterInstance* pCharacter, ECharacterSocket socket, QuatTS& transform);
+
+private:
+	static const char* GetSocketName(ECharacterSocket socket);
+
+	// Kept alive so that a new character can never reuse the address of the one the sockets were resolved on.
+	_smart_ptr<ICharacterInstance> m_pCharacter;
+	std::array<IAttachment*, static_cast<size_t>(ECharacterSocket::Count)> m_attachments = {};
+};
@@ -0,0 +1,104 @@
+#include "StdAfx.h"
+#include "CameraRig.h"
+
+void CCameraRig::Initialize(Cry::DefaultComponents::CCameraComponent* pCameraComponent, Cry::Audio::DefaultComponents::CListenerComponent* pAudioListenerComponent)
+{
+	m_pCameraComponent = pCameraComponent;
+	m_pAudioListenerComponent = pAudioListenerComponent;
+	// Make sure the new components receive a transform on the next update
+	m_isDirty = true;
+	m_engineState.Invalidate();
+}
+
+void CCameraRig::SetMode(ECameraMode mode)
+{
+	if (mode == m_mode)
+		return;
+
+	// The very first mode is applied immediately, there is nothing to blend from yet
+	const bool canBlend = m_mode != ECameraMode::None && m_blendDuration > 0.f;
+	m_mode = mode;
+	m_blendFrom = m_lastTransform;
+	m_blendProgress = canBlend ? 0.f : 1.f;
+	m_isDirty = true;
+}
+
+void CCameraRig::Compute(float frameTime, const Quat& playerRotation)
+{
+	if (m_pCameraComponent == nullptr || m_mode == ECameraMode::None)
+		return;
+
+	const bool isBlending = m_blendProgress < 1.f;
+	// Only the top down view depends on the player rotation
+	const bool rotationChanged = m_mode == ECameraMode::TopDown && !m_lastPlayerRotation.IsEquivalent(playerRotation);
+
+	if (!m_isDirty && !isBlending && !rotationChanged)
+		return;
+
+	m_lastPlayerRotation = playerRotation;
+	m_isDirty = false;
+
+	QuatT transform = ComputeTransform(m_mode, playerRotation);
+	if (isBlending)
+	{
+		m_blendProgress = min(m_blendProgress + frameTime / m_blendDuration, 1.f);
+		// Ease in and out so that the switch does not start or stop abruptly
+		const float t = m_blendProgress * m_blendProgress * (3.f - 2.f * m_blendProgress);
+		transform.t = Vec3::CreateLerp(m_blendFrom.t, transform.t, t);
+		transform.q = Quat::CreateSlerp(m_blendFrom.q, transform.q, t);
+	}
+
+	// The next blend starts from here even before the transform is pushed
+	m_lastTransform = transform;
+	m_hasPendingTransform = true;
+}
+
+void CCameraRig::Apply()
+{
+	if (!m_hasPendingTransform)
+		return;
+
+	m_hasPendingTransform = false;
+	Push(m_lastTransform);
+}
+
+QuatT CCameraRig::ComputeTransform(ECameraMode mode, const Quat& playerRotation)
+{
+	switch (mode)
+	{
+	case ECameraMode::TopDown: return ComputeTopDownTransform(playerRotation);
+	case ECameraMode::SideView: return ComputeSideViewTransform();
+	}
+	return QuatT(IDENTITY);
+}
+
+QuatT CCameraRig::ComputeTopDownTransform(const Quat& playerRotation)
+{
+	// Start with rotating the camera to face downwards
+	const Quat rotation = playerRotation.GetInverted() * Quat::CreateRotationX(DEG2RAD(-90));
+
+	// change this to have fun results of the camera's distance from the character.
+	const float viewDistanceFromPlayer = 5.f;
+
+	// Offset upwards. This affects the camera and the audio components.
+	return QuatT(rotation, Vec3(0, 0, viewDistanceFromPlayer));
+}
+
+QuatT CCameraRig::ComputeSideViewTransform()
+{
+	const float viewDistance = 5;
+	const float viewOffsetUp = 2.f;
+
+	// Offset the player along the forward axis (normally back)
+	// Also offset upwards
+	return QuatT(Quat::CreateRotationZ(DEG2RAD(90)), Vec3(viewDistance, 0, viewOffsetUp));
+}
+
+void CCameraRig::Push(const QuatT& transform)
+{
+	m_engineState.SetCameraTransform(*m_pCameraComponent, Matrix34(transform));
+	if (m_pAudioListenerComponent != nullptr)
+	{
+		m_engineState.SetListenerOffset(*m_pAudioListenerComponent, transform.t);
+	}
+}
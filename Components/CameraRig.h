@@ -0,0 +1,64 @@
+#pragma once
+
+#include <DefaultComponents/Cameras/CameraComponent.h>
+#include <DefaultComponents/Audio/ListenerComponent.h>
+#include "Systems/EngineWriteFilter.h"
+
+// Camera modes, the values match CPlayerComponent::cameraSelection.
+enum class ECameraMode : uint8
+{
+	None = 0,
+	TopDown = 3,
+	SideView = 4
+};
+
+////////////////////////////////////////////////////////
+// Positions the player camera and audio listener for the active camera mode.
+// Transforms are only recomputed and pushed when the mode or the player rotation changes, and mode switches
+// blend smoothly from the last pushed transform without spawning or allocating anything.
+////////////////////////////////////////////////////////
+class CCameraRig
+{
+public:
+	void Initialize(Cry::DefaultComponents::CCameraComponent* pCameraComponent, Cry::Audio::DefaultComponents::CListenerComponent* pAudioListenerComponent);
+
+	// Switches to the mode, blending from the current transform. Requesting the active mode does nothing.
+	void SetMode(ECameraMode mode);
+	ECameraMode GetMode() const { return m_mode; }
+
+	// Seconds a mode switch takes to blend, zero cuts instantly.
+	void SetBlendDuration(float duration) { m_blendDuration = duration; }
+
+	// Prepares new camera and listener transforms if the mode, the blend or the player rotation changed.
+	// Compute only touches the rig, so it can run on a worker thread. Apply pushes its result on the main thread.
+	void Compute(float frameTime, const Quat& playerRotation);
+	void Apply();
+
+private:
+	static QuatT ComputeTransform(ECameraMode mode, const Quat& playerRotation);
+	// Looking straight down at the player, counter-rotated so that the view does not spin with the player.
+	static QuatT ComputeTopDownTransform(const Quat& playerRotation);
+	// Looking at the player from the side.
+	static QuatT ComputeSideViewTransform();
+	void Push(const QuatT& transform);
+
+	Cry::DefaultComponents::CCameraComponent* m_pCameraComponent = nullptr;
+	Cry::Audio::DefaultComponents::CListenerComponent* m_pAudioListenerComponent = nullptr;
+
+	ECameraMode m_mode = ECameraMode::None;
+	// Set when the next Compute has to prepare a transform regardless of the player rotation.
+	bool m_isDirty = false;
+	// Rotation the last pushed transform was computed for.
+	Quat m_lastPlayerRotation = IDENTITY;
+	// Last transform sent to the camera, the start of the next blend.
+	QuatT m_lastTransform = IDENTITY;
+	// Set by Compute when Apply has a transform to push.
+	bool m_hasPendingTransform = false;
+	// Drops pushes that end up at the same transform, such as the top down view while the rotation jitters.
+	CEngineStateCache m_engineState;
+
+	QuatT m_blendFrom = IDENTITY;
+	// Blend progress from 0 to 1, 1 when no blend is running.
+	float m_blendProgress = 1.f;
+	float m_blendDuration = 0.5f;
+};
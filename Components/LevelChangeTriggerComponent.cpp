@@ -2,9 +2,11 @@
 #include "StdAfx.h"
 #include "Player.h"
 #include "GamePlugin.h"
+#include "Systems/GameplayProfiler.h"
 #include <DefaultComponents/Cameras/CameraComponent.h>
 #include <CrySchematyc\Env\Elements\EnvComponent.h>
 #include <CryCore/StaticInstanceList.h>
+#include <algorithm>
 
 namespace
 {
@@ -19,38 +21,137 @@ namespace
 	CRY_STATIC_AUTO_REGISTER_FUNCTION(&RegisterLevelChangeTriggerComponent);
 }
 
+CLevelChangeTriggerComponent::~CLevelChangeTriggerComponent()
+{
+	CGamePlugin::GetInstance()->GetTriggerSystem().RemoveTrigger(GetEntityId());
+}
+
 void CLevelChangeTriggerComponent::Initialize()
 {
-	// Create a new IEntityTriggerComponent instance, responsible for registering our entity in the proximity grid
-	IEntityTriggerComponent* pTriggerComponent = m_pEntity->CreateComponent<IEntityTriggerComponent>();
 	// Listen to area events in a 2m^3 box around the entity
 	const Vec3 triggerBoxSize = Vec3(2, 2, 2);
+	m_switchBoxHalfSize = triggerBoxSize * 0.5f;
+	// Register our box with the plug-in's trigger system, responsible for testing it against the players
+	UpdateTriggerBounds();
+}
+
+void CLevelChangeTriggerComponent::UpdateTriggerBounds()
+{
+	// With a next level the trigger box is grown to the preload distance, entering it starts streaming the level
+	// and the 2m box is then checked every frame until the player reaches it
+	const Vec3 halfSize = HasNextLevel() ? Vec3(m_preloadDistance) : m_switchBoxHalfSize;
 
 	// Create an axis aligned bounding box, ensuring that we listen to events around the entity translation
-	const AABB triggerBounds = AABB(triggerBoxSize * -0.5f, triggerBoxSize * 0.5f);
-	// Now set the trigger bounds on the trigger component
-	pTriggerComponent->SetTriggerBounds(triggerBounds);
+	const Vec3 position = m_pEntity->GetWorldPos();
+	const AABB triggerBounds = AABB(position - halfSize, position + halfSize);
+	CGamePlugin::GetInstance()->GetTriggerSystem().SetTrigger(GetEntityId(), triggerBounds, this);
+}
+
+void CLevelChangeTriggerComponent::OnPlayerEnterTrigger(CPlayerComponent& enteredPlayer)
+{
+	GAMEPLAY_PROFILE_SCOPE(TriggerEvent);
+	IEntity& playerEntity = *enteredPlayer.GetEntity();
+
+	if (HasNextLevel())
+	{
+		// Start streaming now so that the level is resident by the time the player reaches the switch box
+		CGamePlugin::GetInstance()->GetLevelPreloader().RequestPreload(m_nextLevel.c_str());
+		if (std::find(m_approachingPlayerIds.begin(), m_approachingPlayerIds.end(), playerEntity.GetId()) == m_approachingPlayerIds.end())
+		{
+			m_approachingPlayerIds.push_back(playerEntity.GetId());
+		}
+		m_pEntity->UpdateComponentEventMask(this);
+	}
+	else
+	{
+		OnPlayerEntered(playerEntity);
+	}
+}
+
+void CLevelChangeTriggerComponent::OnPlayerLeaveTrigger(CPlayerComponent& leftPlayer)
+{
+	auto it = std::find(m_approachingPlayerIds.begin(), m_approachingPlayerIds.end(), leftPlayer.GetEntityId());
+	if (it != m_approachingPlayerIds.end())
+	{
+		// The preload is kept, the player may still come back
+		m_approachingPlayerIds.erase(it);
+		m_pEntity->UpdateComponentEventMask(this);
+	}
 }
 
 void CLevelChangeTriggerComponent::ProcessEvent(const SEntityEvent& event)
 {
-	if (event.event == ENTITY_EVENT_ENTERAREA)
+	switch (event.event)
+	{
+	case ENTITY_EVENT_XFORM:
+	{
+		// Trigger volumes are static in game, this keeps them in place while they are moved in the editor
+		UpdateTriggerBounds();
+	}
+	break;
+	case ENTITY_EVENT_COMPONENT_PROPERTY_CHANGED:
+	{
+		// The next level or the preload distance was edited, which changes the size of the trigger box
+		UpdateTriggerBounds();
+		if (!HasNextLevel() && !m_approachingPlayerIds.empty())
+		{
+			m_approachingPlayerIds.clear();
+			m_pEntity->UpdateComponentEventMask(this);
+		}
+	}
+	break;
+	case ENTITY_EVENT_UPDATE:
 	{
-		//player = m_pEntity->GetComponent<CPlayerComponent>();
-		// Get the entity identifier of the entity that just entered our shape
-		const EntityId enteredEntityId = static_cast<EntityId>(event.nParam[0]);
-		//gEnv->pConsole->ExecuteString("map sidescrolllevel", false, true);
-		if (IEntity* pEntity = gEnv->pEntitySystem->GetEntity(enteredEntityId))
+		const Vec3 triggerPosition = m_pEntity->GetWorldPos();
+		const AABB switchBox(triggerPosition - m_switchBoxHalfSize, triggerPosition + m_switchBoxHalfSize);
+		const size_t approachingCount = m_approachingPlayerIds.size();
+		for (size_t i = 0; i < m_approachingPlayerIds.size();)
+		{
+			IEntity* pPlayerEntity = gEnv->pEntitySystem->GetEntity(m_approachingPlayerIds[i]);
+			// Players that were removed or reached the switch box are no longer polled
+			if (pPlayerEntity == nullptr)
+			{
+				m_approachingPlayerIds.erase(m_approachingPlayerIds.begin() + i);
+			}
+			else if (switchBox.IsContainPoint(pPlayerEntity->GetWorldPos()))
+			{
+				GAMEPLAY_PROFILE_SCOPE(TriggerEvent);
+				m_approachingPlayerIds.erase(m_approachingPlayerIds.begin() + i);
+				OnPlayerEntered(*pPlayerEntity);
+			}
+			else
+			{
+				++i;
+			}
+		}
+		if (m_approachingPlayerIds.size() != approachingCount)
 		{
-			player = pEntity->GetComponent<CPlayerComponent>();
-			player->cameraSelection = 4;
+			m_pEntity->UpdateComponentEventMask(this);
 		}
-		CryLog("Entity event area entered triggered");
+	}
+	break;
 	}
 }
 
 Cry::Entity::EventFlags CLevelChangeTriggerComponent::GetEventMask() const
 {
-	// Listen to the enter and leave events, in order to receive callbacks above when entities enter our trigger box
-	return { ENTITY_EVENT_ENTERAREA, ENTITY_EVENT_LEAVEAREA };
-}
\ No newline at end of file
+	// Enter and leave come from the trigger system, only moves and edits of the volume are needed here
+	// Updates are only needed while a player is between the preload box and the switch box
+	if (!m_approachingPlayerIds.empty())
+	{
+		return { ENTITY_EVENT_XFORM, ENTITY_EVENT_COMPONENT_PROPERTY_CHANGED, ENTITY_EVENT_UPDATE };
+	}
+	return { ENTITY_EVENT_XFORM, ENTITY_EVENT_COMPONENT_PROPERTY_CHANGED };
+}
+
+void CLevelChangeTriggerComponent::OnPlayerEntered(IEntity& playerEntity)
+{
+	player = playerEntity.GetComponent<CPlayerComponent>();
+	player->cameraSelection = 4;
+
+	if (HasNextLevel())
+	{
+		// Switches once the level is resident instead of blocking on a cold map load here
+		CGamePlugin::GetInstance()->GetLevelPreloader().RequestSwitch(m_nextLevel.c_str());
+	}
+}
@@ -1,18 +1,25 @@
 #pragma once
 #include "StdAfx.h"
 #include "Player.h"
+#include "Systems/TriggerSystem.h"
 #include <CryEntitySystem/IEntitySystem.h>
 #include <CryEntitySystem/IEntityComponent.h>
+#include <CrySchematyc/Utils/SharedString.h>
+#include <vector>
 
 // Example of a component that receives enter and leave events from a virtual box positioned on the entity
-class CLevelChangeTriggerComponent : public IEntityComponent
+// With a next level set, approaching players start streaming that level and entering the inner box switches to it.
+// The box is tested by CTriggerSystem together with every other trigger volume in the level.
+class CLevelChangeTriggerComponent : public IEntityComponent, public ITriggerListener
 {
 public:
 	CLevelChangeTriggerComponent() = default;
-	virtual ~CLevelChangeTriggerComponent() = default;
+	virtual ~CLevelChangeTriggerComponent();
 	static void ReflectType(Schematyc::CTypeDesc<CLevelChangeTriggerComponent>& desc) 
 	{ 
 		desc.SetGUID("{D34659E5-FD99-4B5E-A7CA-C5834E1D0E80}"_cry_guid); 
+		desc.AddMember(&CLevelChangeTriggerComponent::m_nextLevel, 'levl', "NextLevel", "Next Level", "Level to switch to when a player enters, empty to only change the camera", Schematyc::CSharedString());
+		desc.AddMember(&CLevelChangeTriggerComponent::m_preloadDistance, 'prel', "PreloadDistance", "Preload Distance", "Distance from the trigger at which the next level starts streaming", 20.f);
 	}
 
 	virtual void Initialize() override;
@@ -21,4 +28,22 @@ public:
 
 	virtual Cry::Entity::EventFlags GetEventMask() const override;
 	CPlayerComponent* player = nullptr;
-};
\ No newline at end of file
+
+	// ITriggerListener
+	virtual void OnPlayerEnterTrigger(CPlayerComponent& enteredPlayer) override;
+	virtual void OnPlayerLeaveTrigger(CPlayerComponent& leftPlayer) override;
+
+protected:
+	// Registers the trigger box at the entity's current position.
+	void UpdateTriggerBounds();
+	// Called when a player enters the trigger box itself.
+	void OnPlayerEntered(IEntity& playerEntity);
+	bool HasNextLevel() const { return !m_nextLevel.empty(); }
+
+	Schematyc::CSharedString m_nextLevel;
+	float m_preloadDistance = 20.f;
+	// Half size of the box that switches the level, the outer trigger box only starts the preload.
+	Vec3 m_switchBoxHalfSize = Vec3(1, 1, 1);
+	// Players inside the preload box, polled every frame until they reach the switch box.
+	std::vector<EntityId> m_approachingPlayerIds;
+};
@@ -3,6 +3,9 @@
 #include "RegularBullet.h"
 #include "WaterBullet.h"
 #include "GamePlugin.h"
+#include "Systems/GameplayProfiler.h"
+#include "Core/PlayerKernels.h"
+#include "Core/InputEventQueue.h"
 #include <CryRenderer/IRenderAuxGeom.h>
 #include <CrySchematyc/Env/Elements/EnvComponent.h>
 #include <CryCore/StaticInstanceList.h>
@@ -21,6 +24,29 @@ namespace
 	CRY_STATIC_AUTO_REGISTER_FUNCTION(&RegisterPlayerComponent);
 }
 
+CPlayerComponent::~CPlayerComponent()
+{
+	// The result callback captures this component, make sure it is never invoked after we are gone
+	if (m_cursorRayQuery != CRayQueryService::InvalidHandle)
+	{
+		CGamePlugin::GetInstance()->GetRayQueryService().Cancel(m_cursorRayQuery);
+	}
+	CGamePlugin::GetInstance()->GetTriggerSystem().UnregisterPlayer(GetEntityId());
+	CGamePlugin::GetInstance()->GetFacingSystem().RemoveCharacter(GetEntityId());
+	CGamePlugin::GetInstance()->GetFireScheduler().RemoveShooter(GetEntityId());
+	CGamePlugin::GetInstance()->GetSnapshotSystem().UnregisterPlayer(this);
+	CGamePlugin::GetInstance()->GetPlayerUpdateSystem().UnregisterPlayer(this);
+	if (m_pCharacterTemplate != nullptr && m_isCharacterInstanceLive)
+	{
+		CGamePlugin::GetInstance()->GetCharacterTemplateRegistry().ReleaseInstance(*m_pCharacterTemplate);
+	}
+	// The cursor belongs to this player, looked up by ID since a level unload may already have removed it
+	if (gEnv->pEntitySystem->GetEntity(m_cursorEntityId) != nullptr)
+	{
+		gEnv->pEntitySystem->RemoveEntity(m_cursorEntityId);
+	}
+}
+
 void CPlayerComponent::Initialize()
 {
 	// The character controller is responsible for maintaining player physics
@@ -30,13 +56,30 @@ void CPlayerComponent::Initialize()
 
 	// Create the advanced animation component, responsible for updating Mannequin and animating the player
 	m_pAnimationComponent = m_pEntity->GetOrCreateComponent<Cry::DefaultComponents::CAdvancedAnimationComponent>();
-
+	// The character is drawn at this offset from the entity, plus the tick interpolation offset with the fixed timestep on
+	m_characterTransform = m_pAnimationComponent->GetTransformMatrix();
+
+	// The character data is loaded once per template. The first player of a template loads it here, unless the startup
+	// warm-up already bound the template (g_startupWarmup 1, player character only).
+	// The animation component only takes file names, so every player still sets them and calls LoadFromDisk below.
+	// Those loads find the model, database and controller definition in the engine caches the template keeps filled
+	CCharacterTemplateRegistry& characterTemplates = CGamePlugin::GetInstance()->GetCharacterTemplateRegistry();
+	const SCharacterFiles& characterFiles = CStartupWarmup::GetPlayerCharacterFiles();
+	if (m_pCharacterTemplate != nullptr && m_isCharacterInstanceLive)
+	{
+		characterTemplates.ReleaseInstance(*m_pCharacterTemplate);
+		m_isCharacterInstanceLive = false;
+	}
+	m_pCharacterTemplate = characterTemplates.Acquire(characterFiles);
+	// Measured until ResetPlayer applied the character, that is where the instance and its action controller are created
+	m_characterLoadMeasurement = characterTemplates.BeginInstance();
+	m_isCharacterLoadPending = true;
 	// Set the player geometry, this also triggers physics proxy creation
-	m_pAnimationComponent->SetMannequinAnimationDatabaseFile("Animations/Mannequin/ADB/FirstPerson.adb");
+	m_pAnimationComponent->SetMannequinAnimationDatabaseFile(characterFiles.szAnimationDatabase);
 	// Set the player geometry based on the model stored in the engine.
-	m_pAnimationComponent->SetCharacterFile("Objects/Characters/SampleCharacter/thirdperson.cdf");
+	m_pAnimationComponent->SetCharacterFile(characterFiles.szCharacter);
 	// Controller Definition sets our blend spaces and animations that are available for our model.
-	m_pAnimationComponent->SetControllerDefinitionFile("Animations/Mannequin/ADB/FirstPersonControllerDefinition.xml");
+	m_pAnimationComponent->SetControllerDefinitionFile(characterFiles.szControllerDefinition);
 	// Sets the context name based off what is set in the blendspace editor / xml file.
 	m_pAnimationComponent->SetDefaultScopeContextName("FirstPersonCharacter");
 	// Queue the idle fragment to start playing immediately on next update
@@ -48,11 +91,24 @@ void CPlayerComponent::Initialize()
 	m_pAnimationComponent->EnableGroundAlignment(true);
 	// Load the character and Mannequin data from file
 	m_pAnimationComponent->LoadFromDisk();
+	// The character is about to be replaced, sockets are resolved again once it is applied in ResetPlayer
+	m_socketCache.Invalidate();
 
-	// Acquire tag identifiers to avoid doing so each update
-	m_walkTagId = m_pAnimationComponent->GetTagId("Walk");
+	// Tag identifiers are resolved once per template, not per player
+	if (m_pCharacterTemplate != nullptr)
+	{
+		m_walkTagId = m_pCharacterTemplate->GetTagId(ECharacterTag::Walk);
+	}
+	else
+	{
+		m_walkTagId = m_pAnimationComponent->GetTagId("Walk");
+	}
 	// Initializes the remaining items we need.
 	InitializePlayer();
+	// Trigger volumes are only tested against registered players
+	CGamePlugin::GetInstance()->GetTriggerSystem().RegisterPlayer(this, GetEntityId());
+	CGamePlugin::GetInstance()->GetSnapshotSystem().RegisterPlayer(this);
+	CGamePlugin::GetInstance()->GetPlayerUpdateSystem().RegisterPlayer(this);
 }
 
 void CPlayerComponent::InitializePlayer()
@@ -63,6 +119,9 @@ void CPlayerComponent::InitializePlayer()
 	// Create the audio listener component.
 	m_pAudioListenerComponent = m_pEntity->GetOrCreateComponent<Cry::Audio::DefaultComponents::CListenerComponent>();
 
+	// The camera rig positions the camera and listener for the active camera mode
+	m_cameraRig.Initialize(m_pCameraComponent, m_pAudioListenerComponent);
+
 	// Get the input component, wraps access to action mapping so we can easily get callbacks when inputs are triggered
 	m_pInputComponent = m_pEntity->GetOrCreateComponent<Cry::DefaultComponents::CInputComponent>();
 	InitializeCamera();
@@ -80,7 +139,8 @@ void CPlayerComponent::InitializeLeftMovement()
 {
 		/* Left Movement*/
 		// Register an action, and the callback that will be sent when it's triggered
-		m_pInputComponent->RegisterAction("player", "moveleft", [this](int activationMode, float value) { HandleInputFlagChange(EInputFlag::MoveLeft, (EActionActivationMode)activationMode);  });
+		// The callbacks only queue the input, it is applied once per frame in DrainInputEvents
+		m_pInputComponent->RegisterAction("player", "moveleft", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::MoveLeft, activationMode, value); });
 		// Bind the 'A' key the "moveleft" action and so on.
 		//29U
 		m_pInputComponent->BindAction("player", "moveleft", eAID_KeyboardMouse, EKeyId::eKI_A);
@@ -91,7 +151,7 @@ void CPlayerComponent::InitializeLeftMovement()
 void CPlayerComponent::InitializeRightMovement()
 {
 		/* Right Movement*/
-		m_pInputComponent->RegisterAction("player", "moveright", [this](int activationMode, float value) { HandleInputFlagChange(EInputFlag::MoveRight, (EActionActivationMode)activationMode);  });
+		m_pInputComponent->RegisterAction("player", "moveright", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::MoveRight, activationMode, value); });
 		//31U
 		m_pInputComponent->BindAction("player", "moveright", eAID_KeyboardMouse, EKeyId::eKI_D);
 		//533U
@@ -101,7 +161,7 @@ void CPlayerComponent::InitializeRightMovement()
 void CPlayerComponent::InitializeForwardMovement()
 {
 	/* Forward Movement*/
-	m_pInputComponent->RegisterAction("player", "moveforward", [this](int activationMode, float value) { HandleInputFlagChange(EInputFlag::MoveForward, (EActionActivationMode)activationMode);  });
+	m_pInputComponent->RegisterAction("player", "moveforward", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::MoveForward, activationMode, value); });
 	//16U
 	m_pInputComponent->BindAction("player", "moveforward", eAID_KeyboardMouse, EKeyId::eKI_W);
 	//530U
@@ -111,7 +171,7 @@ void CPlayerComponent::InitializeForwardMovement()
 void CPlayerComponent::InitializeBackMovement()
 {
 	/* Back Movement*/
-	m_pInputComponent->RegisterAction("player", "moveback", [this](int activationMode, float value) { HandleInputFlagChange(EInputFlag::MoveBack, (EActionActivationMode)activationMode);  });
+	m_pInputComponent->RegisterAction("player", "moveback", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::MoveBack, activationMode, value); });
 	//30U
 	m_pInputComponent->BindAction("player", "moveback", eAID_KeyboardMouse, EKeyId::eKI_S);
 	//531U
@@ -120,8 +180,8 @@ void CPlayerComponent::InitializeBackMovement()
 
 void CPlayerComponent::InitializeCursorPitchMovement()
 {
-	m_pInputComponent->RegisterAction("player", "mouse_rotate_negative_pitch", [this](int activationMode, float value) { m_cursorPositionInWorld.y -= value;});
-	m_pInputComponent->RegisterAction("player", "mouse_rotate_positive_pitch", [this](int activationMode, float value) {m_cursorPositionInWorld.y += value;});
+	m_pInputComponent->RegisterAction("player", "mouse_rotate_negative_pitch", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::CursorPitch, activationMode, -value); });
+	m_pInputComponent->RegisterAction("player", "mouse_rotate_positive_pitch", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::CursorPitch, activationMode, value); });
 	m_pInputComponent->BindAction("player", "mouse_rotate_negative_pitch", eAID_KeyboardMouse, EKeyId::eKI_MouseY);
 	m_pInputComponent->BindAction("player", "mouse_rotate_negative_pitch", eAID_XboxPad, EKeyId::eKI_XI_ThumbRDown);
 	m_pInputComponent->BindAction("player", "mouse_rotate_positive_pitch", eAID_XboxPad, EKeyId::eKI_XI_ThumbRUp);
@@ -130,8 +190,8 @@ void CPlayerComponent::InitializeCursorPitchMovement()
 
 void CPlayerComponent::InitializeCursorYawMovement()
 {
-	m_pInputComponent->RegisterAction("player", "mouse_negative_rotateyaw", [this](int activationMode, float value) {m_cursorPositionInWorld.x -= value; });
-	m_pInputComponent->RegisterAction("player", "mouse_positive_rotateyaw", [this](int activationMode, float value) {m_cursorPositionInWorld.x += value; });
+	m_pInputComponent->RegisterAction("player", "mouse_negative_rotateyaw", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::CursorYaw, activationMode, -value); });
+	m_pInputComponent->RegisterAction("player", "mouse_positive_rotateyaw", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::CursorYaw, activationMode, value); });
 	m_pInputComponent->BindAction("player", "mouse_negative_rotateyaw", eAID_KeyboardMouse, EKeyId::eKI_MouseX);
 	m_pInputComponent->BindAction("player", "mouse_positive_rotateyaw", eAID_KeyboardMouse, EKeyId::eKI_MouseX);
 	m_pInputComponent->BindAction("player", "mouse_negative_rotateyaw", eAID_XboxPad, EKeyId::eKI_XI_ThumbRLeft);
@@ -141,14 +201,7 @@ void CPlayerComponent::InitializeCursorYawMovement()
 void CPlayerComponent::InitializeShooting()
 {
 	// Register the shoot action
-	m_pInputComponent->RegisterAction("player", "shoot", [this](int activationMode, float value)
-	{
-		// Only fire on press, not release
-		if (activationMode == eAAM_OnPress)
-		{
-				WeaponSelection();
-		}
-	});
+	m_pInputComponent->RegisterAction("player", "shoot", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::Shoot, activationMode, value); });
 
 	/* Weapon fire*/
 	// Bind the shoot action to left mouse click
@@ -163,19 +216,13 @@ void CPlayerComponent::InitializeWeaponSelection()
 	/* Weapon Selection*/
 
 	// Register the selection action
-	m_pInputComponent->RegisterAction("player", "selectweaponone", [this](int activationMode, float value)
-	{
-		selection = 0;
-	});
+	m_pInputComponent->RegisterAction("player", "selectweaponone", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::SelectWeaponOne, activationMode, value); });
 	//1U
 	m_pInputComponent->BindAction("player", "selectweaponone", eAID_KeyboardMouse, EKeyId::eKI_1);
 	//520U
 	m_pInputComponent->BindAction("player", "selectweaponone", eAID_XboxPad, EKeyId::eKI_XI_ShoulderL);
 	// Register the selection action
-	m_pInputComponent->RegisterAction("player", "selectweapontwo", [this](int activationMode, float value)
-	{
-		selection = 1;
-	});
+	m_pInputComponent->RegisterAction("player", "selectweapontwo", [this](int activationMode, float value) { QueueInputEvent(PlayerKernels::EInputAction::SelectWeaponTwo, activationMode, value); });
 	//2U
 	m_pInputComponent->BindAction("player", "selectweapontwo", eAID_KeyboardMouse, EKeyId::eKI_2);
 	//526U
@@ -215,29 +262,110 @@ void CPlayerComponent::ProcessEvent(const SEntityEvent& event)
 		// Don't update the player if we haven't spawned yet
 		if (!m_isAlive)
 			return;
-		// C++ version of implementing / creating frame time in CE.
-		const float frameTime = event.fParam[0];
+		// With the job-parallel update on, the plug-in updates every player at once instead
+		if (CGamePlugin::GetInstance()->GetPlayerUpdateSystem().IsEnabled())
+			return;
+		GAMEPLAY_PROFILE_SCOPE(PlayerUpdate);
+		PrepareUpdate(event.fParam[0]);
+		ComputeUpdate();
+		ApplyUpdate();
+	}
+	break;
+	case Cry::Entity::EEvent::Reset:
+	{
+		ResetPlayer();
+	}
+	break;
+	}
+}
+
+bool CPlayerComponent::PrepareUpdate(float frameTime)
+{
+	if (!m_isAlive)
+		return false;
+
+	// C++ version of implementing / creating frame time in CE.
+	// While an input recording is replayed the recorded frame time is used, so that the replay is deterministic.
+	m_pendingUpdate.frameTime = CGamePlugin::GetInstance()->GetInputRecorder().ProcessPlayerInput(m_inputEvents, frameTime);
+
+	// Apply this frame's input before anything reads it, shots are fired from here
+	DrainInputEvents();
 
-		// Update the in-world cursor position
-		UpdateCursor(frameTime);
+	// Read the mouse for the in-world cursor position
+	UpdateCursor(m_pendingUpdate.frameTime);
+
+	// Movement runs in simulation ticks, with the fixed timestep off that is one tick of the frame time.
+	// The plug-in advanced the clock for this frame before the player update.
+	CSimulationClock& simulationClock = CGamePlugin::GetInstance()->GetSimulationClock();
+	m_pendingUpdate.tickCount = m_isRemotelySimulated ? 0 : simulationClock.GetTickCount();
+	m_pendingUpdate.tickInterval = simulationClock.GetTickInterval();
+	m_pendingUpdate.isOnGround = m_pCharacterController->IsOnGround();
+	m_pendingUpdate.rotation = m_pEntity->GetWorldRotation();
+
+	// Where the previous ticks left the character, it is drawn between the last two of these
+	if (m_pendingUpdate.tickCount > 0)
+	{
+		m_previousTickPosition = m_hasTickPositions ? m_lastTickPosition : m_pEntity->GetWorldPos();
+		m_lastTickPosition = m_pEntity->GetWorldPos();
+		m_hasTickPositions = true;
+	}
+	m_pendingUpdate.isInterpolated = simulationClock.IsFixedTimestep() && !m_isRemotelySimulated && m_hasTickPositions;
+	m_pendingUpdate.interpolationAlpha = simulationClock.GetInterpolationAlpha();
+	return true;
+}
 
+void CPlayerComponent::ComputeUpdate()
+{
+	ComputeCursorRay();
+
+	if (m_isRemotelySimulated)
+	{
+		UpdateRemotePresentation(m_pendingUpdate.frameTime);
+	}
+	else if (m_pendingUpdate.tickCount > 0)
+	{
 		// Start by updating the movement request we want to send to the character controller
-		// This results in the physical representation of the character moving
-		UpdateMovementRequest(frameTime);
+		// This results in the physical representation of the character moving.
+		UpdateMovementRequest(m_pendingUpdate.tickInterval);
+	}
 
-		// Update the animation state of the character
-		UpdateAnimation(frameTime);
+	// Update the camera component offset
+	CameraMode(m_pendingUpdate.frameTime);
+}
 
-		// Update the camera component offset
-		CameraMode(frameTime);
+void CPlayerComponent::ApplyUpdate()
+{
+	if (m_pendingUpdate.hasCursorRay)
+	{
+		m_pendingUpdate.hasCursorRay = false;
+		// Queue the ray instead of casting it here, the player itself is skipped so the cursor lands behind it
+		const unsigned int rayFlags = rwi_stop_at_pierceable | rwi_colltype_any;
+		m_cursorRayQuery = CGamePlugin::GetInstance()->GetRayQueryService().Submit(m_pendingUpdate.cursorRayOrigin, m_pendingUpdate.cursorRayDirection * gEnv->p3DEngine->GetMaxViewDistance(),
+			ent_all, rayFlags, m_pEntity->GetPhysics(), [this](const SRayQueryResult& result) { OnCursorRayResult(result); });
 	}
-	break;
-	case Cry::Entity::EEvent::Reset:
+
+	if (m_pendingUpdate.hasRemoteTransform)
 	{
-		ResetPlayer();
+		m_pendingUpdate.hasRemoteTransform = false;
+		m_pEntity->SetPosRotScale(m_pendingUpdate.remotePosition, m_pendingUpdate.rotation, m_pEntity->GetScale());
 	}
-	break;
+
+	{
+		GAMEPLAY_PROFILE_SCOPE(ApplyMovement);
+		// update the character controller's velocity based off the velocity value as it changes.
+		for (uint32 tick = 0; tick < m_pendingUpdate.tickCount; ++tick)
+		{
+			m_engineState.AddVelocity(*m_pCharacterController, m_pendingUpdate.velocity);
+		}
+		m_pendingUpdate.tickCount = 0;
 	}
+
+	// Update the animation state of the character
+	UpdateAnimation(m_pendingUpdate.frameTime);
+	UpdateTickPresentation();
+
+	GAMEPLAY_PROFILE_SCOPE(ApplyCamera);
+	m_cameraRig.Apply();
 }
 
 void CPlayerComponent::SpawnCursorEntity()
@@ -252,18 +380,22 @@ void CPlayerComponent::SpawnCursorEntity()
 
 	// Spawn the cursor
 	m_pCursorEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams);
+	m_cursorEntityId = m_pCursorEntity->GetId();
 
-	// Load geometry for the cursor, in our case, it is just a sphere.
+	// Bind geometry for the cursor, in our case, it is just a sphere.
+	CAssetCache& assetCache = CGamePlugin::GetInstance()->GetAssetCache();
 	const int geometrySlot = 0;
-	m_pCursorEntity->LoadGeometry(geometrySlot, "%ENGINE%/EngineAssets/Objects/primitive_sphere.cgf");
+	m_pCursorEntity->SetStatObj(assetCache.GetGeometry(EGeometryAsset::Sphere), geometrySlot, false);
 
 	// Scale the cursor down a bit
 	m_pCursorEntity->SetScale(Vec3(0.1f));
 	m_pCursorEntity->SetViewDistRatio(255);
 
-	// Load the custom cursor material
-	IMaterial* pCursorMaterial = gEnv->p3DEngine->GetMaterialManager()->LoadMaterial("Materials/cursor");
-	m_pCursorEntity->SetMaterial(pCursorMaterial);
+	// Bind the custom cursor material
+	m_pCursorEntity->SetMaterial(assetCache.GetMaterial(EMaterialAsset::Cursor));
+
+	// The player turns to face the cursor on the ground plane
+	CGamePlugin::GetInstance()->GetFacingSystem().SetFacingTarget(GetEntityId(), m_pCursorEntity->GetId());
 }
 
 void CPlayerComponent::InitializeCamera()
@@ -282,170 +414,160 @@ void CPlayerComponent::InitializeCamera()
 
 void CPlayerComponent::CameraMode(float frameTime)
 {
-	SEntitySpawnParams spawnParams;
-	spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
-	if (m_pCameraComponent != nullptr) {
-		if (IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
+	if (m_pCameraComponent != nullptr)
+	{
+		switch (cameraSelection)
 		{
-			switch (cameraSelection)
-			{
-			case 3:
-			{
-				UpdateTopDownCamera(frameTime);
-				m_SideView = false;
-				m_TopDown = true;
-			}
-			break;
-			case 4:
-			{
-				UpdateSideViewCamera(frameTime);
-				m_TopDown = false;
-				m_SideView = true;
-			}
-			break;
-			}
+		case 3:
+		{
+			m_cameraRig.SetMode(ECameraMode::TopDown);
+			m_SideView = false;
+			m_TopDown = true;
+		}
+		break;
+		case 4:
+		{
+			m_cameraRig.SetMode(ECameraMode::SideView);
+			m_TopDown = false;
+			m_SideView = true;
+		}
+		break;
 		}
+		// Only prepares a new transform when the mode or the player rotation changed, ApplyUpdate pushes it
+		m_cameraRig.Compute(frameTime, m_pendingUpdate.rotation);
 	}
 }
 
 void CPlayerComponent::UpdateMovementRequest(float frameTime)
 {
+	m_pendingUpdate.velocity = ZERO;
 	// Don't handle input if we are in air
-	if (!m_pCharacterController->IsOnGround())
+	if (!m_pendingUpdate.isOnGround)
 		return;
-	// initialize our velocity variable to be a zero vector
-	Vec3 velocity = ZERO;
 	// create a move speed float value, 20.5 is a smooth movement speed.
 	const float moveSpeed = 20.5f;
 	// Utilizing our input flags, we can manipulate how the player moves.
-	if (m_TopDown != false)
-	{
-		if (m_inputFlags & EInputFlag::MoveLeft)
-		{
-			velocity.x -= moveSpeed * frameTime;
-		}
-		if (m_inputFlags & EInputFlag::MoveRight)
-		{
-			velocity.x += moveSpeed * frameTime;
-		}
-	}
-	if (m_TopDown != false)
-	{
-		if (m_inputFlags & EInputFlag::MoveForward)
-		{
-			velocity.y += moveSpeed * frameTime;
-		}
-		if (m_inputFlags & EInputFlag::MoveBack)
-		{
-			velocity.y -= moveSpeed * frameTime;
-		}
-	}
-	else
-	{
-		if (m_inputFlags & EInputFlag::MoveForward)
-		{
-			velocity.y -= moveSpeed * frameTime;
-		}
-		if (m_inputFlags & EInputFlag::MoveBack)
-		{
-			velocity.y += moveSpeed * frameTime;
-		}
-	}
-	// update the character controller's velocity based off the velocity value as it changes.
-	m_pCharacterController->AddVelocity(velocity);
+	const PlayerKernels::SPlanarVelocity planarVelocity = PlayerKernels::ComputeMovementVelocity(static_cast<uint8>(m_inputFlags.UnderlyingValue()), m_TopDown, moveSpeed, frameTime);
+	m_pendingUpdate.velocity = Vec3(planarVelocity.x, planarVelocity.y, 0.f);
 }
 
 void CPlayerComponent::UpdateAnimation(float frameTime)
 {
+	GAMEPLAY_PROFILE_SCOPE(UpdateAnimation);
 	// Update the Mannequin tags
-	m_pAnimationComponent->SetTagWithId(m_walkTagId, true);
-	// if the cursor is null, don't update the animation.
-	if (m_pCursorEntity == nullptr)
+	m_engineState.SetTag(*m_pAnimationComponent, m_walkTagId, true);
+	// Facing the cursor is done for every character at once by the plug-in's facing system
+}
+
+void CPlayerComponent::UpdateTickPresentation()
+{
+	if (!m_pendingUpdate.isInterpolated)
 	{
+		if (m_hasPresentationOffset)
+		{
+			m_pAnimationComponent->SetTransformMatrix(m_characterTransform);
+			m_hasPresentationOffset = false;
+		}
 		return;
 	}
-	// Dir is a direction vector 3 value, it will be the difference between the cursor's world position and 
-	// the player character' world position.
-	Vec3 dir = m_pCursorEntity->GetWorldPos() - m_pEntity->GetWorldPos();
-	// normalize the results.
-	dir = dir.Normalize();
-	// newRotation is a Quaternion which will be a rotation v direction
-	// which is based off the direction vector we created.
-	Quat newRotation = Quat::CreateRotationVDir(dir);
-	// ypr is Yaw Pit Rotation from Angles3. It will be created from the Camera Components'
-	// function to create angles YPR. The parameter is a 3x3 matrix based off our newRotation variable.
-	Ang3 ypr = CCamera::CreateAnglesYPR(Matrix33(newRotation));
-
-	// We only want to affect Z-axis rotation, zero pitch and roll
-	ypr.y = 0;
-	ypr.z = 0;
-
-	// Re-calculate the quaternion based on the corrected yaw
-	newRotation = Quat(CCamera::CreateOrientationYPR(ypr));
-
-	// If the character controller is walking
-	if (m_pCharacterController->IsWalking())
-	{
-		// Send updated transform to the entity, only orientation changes
-		m_pEntity->SetPosRotScale(m_pEntity->GetWorldPos(), newRotation, Vec3(1, 1, 1));
-	}
-	// If the character controller is not walking
-	else
-	{
-		// Update only the player rotation
-		m_pEntity->SetRotation(newRotation);
-	}
+
+	// With the fixed timestep the character moves in tick sized steps, so it is drawn the frame's fraction of a tick
+	// between the last two tick positions. The offset is in entity space, like the rest of the character transform.
+	const Vec3 presentedPosition = Vec3::CreateLerp(m_previousTickPosition, m_lastTickPosition, m_pendingUpdate.interpolationAlpha);
+	const Vec3 offset = m_pEntity->GetWorldRotation().GetInverted() * (presentedPosition - m_pEntity->GetWorldPos());
+	Matrix34 transform = m_characterTransform;
+	transform.SetTranslation(m_characterTransform.GetTranslation() + offset);
+	m_pAnimationComponent->SetTransformMatrix(transform);
+	m_hasPresentationOffset = true;
 }
 
-void CPlayerComponent::UpdateTopDownCamera(float frameTime)
+void CPlayerComponent::UpdateRemotePresentation(float frameTime)
 {
-	// Start with rotating the camera to face downwards
-	Matrix34 localTransform = IDENTITY;
-	localTransform.SetRotation33(Matrix33(m_pEntity->GetWorldRotation().GetInverted()) * Matrix33::CreateRotationX(DEG2RAD(-90)));
-
-	// change this to have fun results of the camera's distance from the character.
-	const float viewDistanceFromPlayer = 5.f;
+	if (!m_remotePresentation.hasState)
+		return;
 
-	// Offset the player along the forward axis (normally back)
-	// Also offset upwards. This affects the camera and the audio components.
-	localTransform.SetTranslation(Vec3(0, 0, viewDistanceFromPlayer));
-	m_pCameraComponent->SetTransformMatrix(localTransform);
-	m_pAudioListenerComponent->SetOffset(localTransform.GetTranslation());
+	m_remotePresentation.Advance(frameTime);
+	float x, y, z, yaw;
+	m_remotePresentation.Evaluate(x, y, z, yaw);
+	// The camera follows the presented rotation, not the one from before this frame
+	m_pendingUpdate.hasRemoteTransform = true;
+	m_pendingUpdate.remotePosition = Vec3(x, y, z);
+	m_pendingUpdate.rotation = Quat::CreateRotationZ(yaw);
 }
 
-void CPlayerComponent::UpdateSideViewCamera(float frameTime)
+void CPlayerComponent::UpdateCursor(float frameTime)
 {
-	Matrix34 localTransform = IDENTITY;
-
-	const float viewDistance = 5;
-	const float viewOffsetUp = 2.f;
-
-	// Offset the player along the forward axis (normally back)
-	// Also offset upwards
-	localTransform.SetTranslation(Vec3(viewDistance, 0, viewOffsetUp));
+	GAMEPLAY_PROFILE_SCOPE(UpdateCursor);
+	// Wait for the previous mouse ray, its result arrives the frame after it was submitted
+	if (m_cursorRayQuery != CRayQueryService::InvalidHandle)
+		return;
+	// There is no mouse to follow on a dedicated server
+	if (gEnv->IsDedicated())
+		return;
+	// Read through the input recorder, a replay aims with the recorded mouse instead of the live one
+	if (!CGamePlugin::GetInstance()->GetInputRecorder().GetMousePosition(m_pendingUpdate.mouseX, m_pendingUpdate.mouseY))
+		return;
+	// Invert mouse Y
+	m_pendingUpdate.mouseY = gEnv->pRenderer->GetHeight() - m_pendingUpdate.mouseY;
+	// Copied here, the system camera may change while ComputeCursorRay runs on a worker thread
+	m_pendingUpdate.viewCamera = gEnv->pSystem->GetViewCamera();
+	m_pendingUpdate.hasCursorRay = true;
+}
 
-	localTransform.SetRotation33(Matrix33::CreateRotationZ(DEG2RAD(90)));
+void CPlayerComponent::ComputeCursorRay()
+{
+	if (!m_pendingUpdate.hasCursorRay)
+		return;
 
-	m_pCameraComponent->SetTransformMatrix(localTransform);
-	m_pAudioListenerComponent->SetOffset(localTransform.GetTranslation());
+	// Build a ray from the camera through the mouse position
+	const CCamera& systemCamera = m_pendingUpdate.viewCamera;
+	Vec3 vPos0(0, 0, 0);
+	systemCamera.Unproject(Vec3(m_pendingUpdate.mouseX, m_pendingUpdate.mouseY, 0), vPos0);
+	Vec3 vPos1(0, 0, 0);
+	systemCamera.Unproject(Vec3(m_pendingUpdate.mouseX, m_pendingUpdate.mouseY, 1), vPos1);
+	m_pendingUpdate.cursorRayOrigin = vPos0;
+	m_pendingUpdate.cursorRayDirection = (vPos1 - vPos0).Normalize();
 }
 
-void CPlayerComponent::UpdateCursor(float frameTime)
+void CPlayerComponent::OnCursorRayResult(const SRayQueryResult& result)
 {
-	offset = Vec3(0, 0, 10.f);
-	m_cursorPositionInWorld = m_pEntity->GetWorldPos() + offset;
-	// Don't handle input if we are in air
-	if (!m_pCharacterController->IsOnGround())
+	m_cursorRayQuery = CRayQueryService::InvalidHandle;
+	// Keep the cursor where it was if the mouse points at nothing
+	if (!result.hasHit)
 		return;
+
+	m_cursorPositionInWorld = result.point;
+	if (m_pCursorEntity != nullptr)
+	{
+		m_pCursorEntity->SetPosRotScale(m_cursorPositionInWorld, IDENTITY, m_pCursorEntity->GetScale());
+	}
 }
 
 void CPlayerComponent::ResetPlayer()
 {
 	// Apply character to the entity
 	m_pAnimationComponent->ResetCharacter();
+	// The new character starts without our tags, push them again
+	m_engineState.Invalidate();
+	// Resolve the weapon sockets on the new character instance
+	m_socketCache.Resolve(m_pAnimationComponent->GetCharacter());
 	m_pCharacterController->Physicalize();
+	// The first reset after Initialize completes the character set up, later ones are respawns
+	if (m_isCharacterLoadPending)
+	{
+		m_isCharacterLoadPending = false;
+		if (m_pCharacterTemplate != nullptr)
+		{
+			CGamePlugin::GetInstance()->GetCharacterTemplateRegistry().EndInstance(*m_pCharacterTemplate, m_characterLoadMeasurement);
+			m_isCharacterInstanceLive = true;
+		}
+		CGamePlugin::GetInstance()->GetStartupWarmup().OnPlayerLoaded(m_characterLoadMeasurement.startTime);
+	}
+	// The respawn moved the character, it is not drawn between the ticks before it
+	m_hasTickPositions = false;
 	// Reset input now that the player respawned
 	m_inputFlags.Clear();
+	m_inputEvents.Clear();
 	cameraSelection = 3;
 	maxRegularAmmo = 5;
 	regularAmmoCount = maxRegularAmmo;
@@ -455,20 +577,25 @@ void CPlayerComponent::ResetPlayer()
 
 void CPlayerComponent::WeaponSelection() 
 {
+	GAMEPLAY_PROFILE_SCOPE(WeaponFire);
+	// Both weapons fire from the barrel, without it there is nothing to shoot from
+	QuatTS bulletOrigin;
+	if (!m_socketCache.GetWorldTransform(m_pAnimationComponent->GetCharacter(), ECharacterSocket::BarrelOut, bulletOrigin))
+		return;
+
 	switch (selection)
 	{
 		case 0:
 		{
-			if (regularAmmoCount > 0) {
-				m_pRegularBullet->Fire(m_pAnimationComponent, regularAmmoCount);
+			// Shots faster than the fire rate are refused and do not use up ammo
+			if (regularAmmoCount > 0 && RegularBulletComponent::Fire(bulletOrigin, GetEntityId())) {
 				regularAmmoCount -= 1;
 			}
 		}
 		break;
 		case 1:
 		{
-			if (waterAmmoCount > 0) {
-			m_pWaterBullet->Fire(m_pAnimationComponent, waterAmmoCount);
+			if (waterAmmoCount > 0 && WaterBulletComponent::Fire(bulletOrigin, GetEntityId())) {
 			waterAmmoCount -= 1;
 			}
 		}
@@ -476,30 +603,109 @@ void CPlayerComponent::WeaponSelection()
 	}
 }
 
-void CPlayerComponent::HandleInputFlagChange(const CEnumFlags<EInputFlag> flags, const CEnumFlags<EActionActivationMode> activationMode, const EInputFlagType type)
+void CPlayerComponent::SimulateShot(int weapon)
+{
+	// Refill the magazine so that synthetic shots never run dry and always reach the spawn path
+	selection = weapon;
+	regularAmmoCount = maxRegularAmmo;
+	waterAmmoCount = maxWaterAmmo;
+	WeaponSelection();
+}
+
+NetKernels::SPlayerState CPlayerComponent::GetSnapshotState() const
 {
-	switch (type)
+	const Vec3 position = m_pEntity->GetWorldPos();
+	NetKernels::SPlayerState state;
+	state.playerId = GetEntityId();
+	state.positionX = position.x;
+	state.positionY = position.y;
+	state.positionZ = position.z;
+	state.yaw = m_pEntity->GetWorldRotation().GetRotZ();
+	state.inputFlags = static_cast<uint8>(m_inputFlags.UnderlyingValue());
+	state.selection = static_cast<uint8>(selection);
+	state.regularAmmo = static_cast<uint8>(max(regularAmmoCount, 0.f));
+	state.waterAmmo = static_cast<uint8>(max(waterAmmoCount, 0.f));
+	state.cameraMode = static_cast<uint8>(cameraSelection);
+	return state;
+}
+
+void CPlayerComponent::ApplySnapshotState(const NetKernels::SPlayerState& state, float snapshotInterval)
+{
+	if (!m_isRemotelySimulated)
 	{
-	case EInputFlagType::Hold:
+		// The snapshot yaw is the facing the other machine computed, the local facing system must not override it
+		CGamePlugin::GetInstance()->GetFacingSystem().RemoveCharacter(GetEntityId());
+		m_isRemotelySimulated = true;
+	}
+	m_remotePresentation.PushTick(state.positionX, state.positionY, state.positionZ, state.yaw, snapshotInterval);
+	// Movement flags drive the walk animation and the local movement prediction
+	m_inputFlags = CEnumFlags<EInputFlag>(static_cast<EInputFlag>(state.inputFlags));
+	selection = state.selection;
+	regularAmmoCount = state.regularAmmo;
+	waterAmmoCount = state.waterAmmo;
+	cameraSelection = state.cameraMode;
+}
+
+void CPlayerComponent::QueueInputEvent(PlayerKernels::EInputAction action, int activationMode, float value)
+{
+	// Counted here and reported once per frame when the queue is drained, a full queue would flood the log otherwise
+	if (!m_inputEvents.Push(action, static_cast<uint8>(activationMode), value))
 	{
-		if (activationMode == eAAM_OnRelease)
-		{
-			m_inputFlags &= ~flags;
-		}
-		else
-		{
-			m_inputFlags |= flags;
-		}
+		++m_droppedInputEvents;
 	}
-	break;
-	case EInputFlagType::Toggle:
+}
+
+void CPlayerComponent::DrainInputEvents()
+{
+	if (m_droppedInputEvents > 0)
 	{
-		if (activationMode == eAAM_OnRelease)
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "[Player] Input event queue full, dropped %u input events this frame", m_droppedInputEvents);
+		m_droppedInputEvents = 0;
+	}
+
+	m_inputEvents.Drain([this](const PlayerKernels::SInputEvent& inputEvent)
+	{
+		switch (inputEvent.action)
 		{
-			// Toggle the bit(s)
-			m_inputFlags ^= flags;
+		case PlayerKernels::EInputAction::MoveLeft:
+			HandleInputFlagChange(EInputFlag::MoveLeft, (EActionActivationMode)inputEvent.activationMode);
+			break;
+		case PlayerKernels::EInputAction::MoveRight:
+			HandleInputFlagChange(EInputFlag::MoveRight, (EActionActivationMode)inputEvent.activationMode);
+			break;
+		case PlayerKernels::EInputAction::MoveForward:
+			HandleInputFlagChange(EInputFlag::MoveForward, (EActionActivationMode)inputEvent.activationMode);
+			break;
+		case PlayerKernels::EInputAction::MoveBack:
+			HandleInputFlagChange(EInputFlag::MoveBack, (EActionActivationMode)inputEvent.activationMode);
+			break;
+		case PlayerKernels::EInputAction::Shoot:
+			// Only fire on press, not release
+			if (inputEvent.activationMode == eAAM_OnPress)
+			{
+				WeaponSelection();
+			}
+			break;
+		case PlayerKernels::EInputAction::SelectWeaponOne:
+			selection = 0;
+			break;
+		case PlayerKernels::EInputAction::SelectWeaponTwo:
+			selection = 1;
+			break;
+		case PlayerKernels::EInputAction::CursorPitch:
+			m_cursorPositionInWorld.y += inputEvent.value;
+			break;
+		case PlayerKernels::EInputAction::CursorYaw:
+			m_cursorPositionInWorld.x += inputEvent.value;
+			break;
+		default:
+			break;
 		}
-	}
-	break;
-	}
+	});
+}
+
+void CPlayerComponent::HandleInputFlagChange(const CEnumFlags<EInputFlag> flags, const CEnumFlags<EActionActivationMode> activationMode, const EInputFlagType type)
+{
+	const bool isRelease = activationMode == eAAM_OnRelease;
+	m_inputFlags = PlayerKernels::ApplyInputFlagChange(m_inputFlags, flags, isRelease, type == EInputFlagType::Toggle);
 }
\ No newline at end of file
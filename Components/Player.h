@@ -5,6 +5,14 @@
 #include <ICryMannequin.h>
 #include "WaterBullet.h"
 #include "RegularBullet.h"
+#include "CameraRig.h"
+#include "Systems/EngineWriteFilter.h"
+#include "AttachmentSocketCache.h"
+#include "Systems/RayQueryService.h"
+#include "Systems/CharacterTemplateRegistry.h"
+#include "Core/InputEventQueue.h"
+#include "Core/PlayerSnapshot.h"
+#include "Core/FixedTimestep.h"
 #include <CrySchematyc/Utils/EnumFlags.h>
 #include <DefaultComponents/Cameras/CameraComponent.h>
 #include <DefaultComponents/Physics/CharacterControllerComponent.h>
@@ -39,8 +47,8 @@ class CPlayerComponent  : public IEntityComponent
 public:
 	// Constructor for CPlayerComponent is the default constructor provided by Crytek.
 	CPlayerComponent() = default;
-	// Destructor for CPlayerComponent is the default destructor provided by Crytek.
-	virtual ~CPlayerComponent() = default;
+	// Destructor for CPlayerComponent, cancels any ray query that still refers to this player.
+	virtual ~CPlayerComponent();
 	int cameraSelection;
 	void CameraMode(float frameTime);
 	// We need the initialization function and we will override it to suit our purposes.
@@ -55,6 +63,20 @@ public:
 	{
 		desc.SetGUID("{63F4C0C6-32AF-4ACB-8FB0-57D45DD14725}"_cry_guid);
 	}
+	// Fires the given weapon through the normal weapon path with a full magazine, used by the stress test.
+	void SimulateShot(int weapon);
+	// The state that is replicated: position, yaw, movement flags, selected weapon, ammo and camera mode.
+	NetKernels::SPlayerState GetSnapshotState() const;
+	// Applies a state received in a snapshot, for players simulated on another machine.
+	// The transform is presented interpolated over the snapshot interval instead of snapping to it.
+	void ApplySnapshotState(const NetKernels::SPlayerState& state, float snapshotInterval);
+	// The frame update split in three for CPlayerUpdateSystem, ProcessEvent runs them back to back when the system is off.
+	// Applies input and reads engine state on the main thread, returns false if the player has not spawned yet.
+	bool PrepareUpdate(float frameTime);
+	// Pure computation on what PrepareUpdate read, runs on a worker thread and must not call into the engine.
+	void ComputeUpdate();
+	// Pushes the results of ComputeUpdate to the engine, on the main thread.
+	void ApplyUpdate();
 	// The below functions are private and are self defined.
 protected:
 	// Functions for each input type
@@ -68,15 +90,20 @@ protected:
 	void InitializeCursorPitchMovement();
 	void InitializeCursorYawMovement();
 	// We need a request for updating movement and will require the frameTime value in the parameter.
+	// Only computes the velocity, ApplyUpdate adds it to the character controller once per simulation tick.
 	void UpdateMovementRequest(float frameTime);
 	// We need a request for updating animation and will require the frameTime value in the parameter.
 	void UpdateAnimation(float frameTime);
-	// We need a request for updating the camera and will require the frameTime value in the parameter.
-	virtual void UpdateTopDownCamera(float frameTime);
-	// We need a request for updating the camera and will require the frameTime value in the parameter.
-	virtual void UpdateSideViewCamera(float frameTime);
+	// Draws the character between its last two simulation tick positions while the fixed timestep is on.
+	void UpdateTickPresentation();
+	// Moves a player simulated on another machine along the interpolated snapshot transforms.
+	void UpdateRemotePresentation(float frameTime);
 	// We need a request for updating the cursor and will require the frameTime value in the parameter.
+	// Reads the mouse position, ComputeCursorRay builds the ray through it and ApplyUpdate submits it.
 	virtual void UpdateCursor(float frameTime);
+	void ComputeCursorRay();
+	// Moves the cursor to where the mouse ray hit the world, called a frame after the ray was submitted.
+	void OnCursorRayResult(const SRayQueryResult& result);
 	// We need to actually spawn our cursor.
 	virtual void SpawnCursorEntity();
 	// We need to initialize the player and will be called in the default initialize function that we overrided.
@@ -85,6 +112,10 @@ protected:
 	void ResetPlayer();
 	// We select which weapon part we want to spawn.
 	void WeaponSelection();
+	// Appends an input action to this frame's queue, called from the input callbacks.
+	void QueueInputEvent(PlayerKernels::EInputAction action, int activationMode, float value);
+	// Applies every queued input event in order, called once per frame before movement is computed.
+	void DrainInputEvents();
 	// We need a function to actually handle our input flag changes. Will be done here.
 	void HandleInputFlagChange(CEnumFlags<EInputFlag> flags, CEnumFlags<EActionActivationMode> activationMode, EInputFlagType type = EInputFlagType::Hold);
 // The below properties are private.
@@ -102,20 +133,75 @@ private:
 	Cry::DefaultComponents::CAdvancedAnimationComponent* m_pAnimationComponent = nullptr;
 	// Definining of our input component variable and instantiating it as null.
 	Cry::DefaultComponents::CInputComponent* m_pInputComponent = nullptr;
-	WaterBulletComponent* m_pWaterBullet = nullptr;
-	RegularBulletComponent* m_pRegularBullet = nullptr;
 	// Definining of our audio listener component variable and instantiating it as null.
 	Cry::Audio::DefaultComponents::CListenerComponent* m_pAudioListenerComponent = nullptr;
+	// Resolves the barrel_out attachment once per character instance, so firing does no name lookups.
+	CAttachmentSocketCache m_socketCache;
+	// Holds the top down and side view camera modes and pushes the camera transform when it changes.
+	CCameraRig m_cameraRig;
+	// Last tag and velocity writes, so that an idle player does not push anything to the engine.
+	CEngineStateCache m_engineState;
+	// Shared character data this player's character was set up from, nullptr if it could not be loaded.
+	const SCharacterTemplate* m_pCharacterTemplate = nullptr;
+	// Taken when Initialize starts setting up the character, ended by the next ResetPlayer once the instance exists.
+	CCharacterTemplateRegistry::SInstanceMeasurement m_characterLoadMeasurement;
+	bool m_isCharacterLoadPending = false;
+	// Set once the instance was counted in the template, so that it is released exactly once.
+	bool m_isCharacterInstanceLive = false;
 	// Defining of a TagID which is needed for the advanced animation component.
 	TagID m_walkTagId;
 	// Definining of our input flags to be able to handle player movement.
 	CEnumFlags<EInputFlag> m_inputFlags;
+	// Input received since the last update, a frame rarely has more than a handful of events.
+	PlayerKernels::TPlayerInputEventQueue m_inputEvents;
+	// Events that did not fit into the queue since it was last drained.
+	uint32 m_droppedInputEvents = 0;
 	// Definining of our Vector2 which will store the mouse position and initializing it to zero vector position.
 	Vec3 m_cursorPositionInWorld = ZERO;
 	// Definining of our mouse cursor and initializing it as a null pointer.
 	IEntity* m_pCursorEntity = nullptr;
-	// Definining of our Vector value for offsetting the cursor's position.
-	Vec3 offset = ZERO;
+	// Kept apart from the pointer, so that the destructor can check whether the cursor still exists.
+	EntityId m_cursorEntityId = INVALID_ENTITYID;
+	// Handle of the deferred mouse ray that places the cursor, invalid while no ray is in flight.
+	RayQueryHandle m_cursorRayQuery = CRayQueryService::InvalidHandle;
+	// Set once the player's state comes from snapshots instead of local input.
+	bool m_isRemotelySimulated = false;
+	// Last snapshot transforms of a remotely simulated player.
+	SimulationKernels::STransformInterpolator m_remotePresentation;
+	// Entity positions when the last two frames with simulation ticks started.
+	Vec3 m_previousTickPosition = ZERO;
+	Vec3 m_lastTickPosition = ZERO;
+	bool m_hasTickPositions = false;
+	// Character transform on the entity without the tick interpolation offset, and whether the offset is applied.
+	Matrix34 m_characterTransform = Matrix34(IDENTITY);
+	bool m_hasPresentationOffset = false;
+
+	// What PrepareUpdate read from the engine and what ComputeUpdate wants to write back, for the current frame.
+	struct SPendingUpdate
+	{
+		float frameTime = 0.f;
+		uint32 tickCount = 0;
+		float tickInterval = 0.f;
+		// Set while the character is drawn between its tick positions, alpha is the fraction of a tick since the last one.
+		bool isInterpolated = false;
+		float interpolationAlpha = 1.f;
+		bool isOnGround = false;
+		// Player rotation the camera is placed for.
+		Quat rotation = IDENTITY;
+		// Velocity to add in every simulation tick.
+		Vec3 velocity = ZERO;
+		// Set while a cursor ray has to be built from the mouse position and this copy of the view camera.
+		bool hasCursorRay = false;
+		CCamera viewCamera;
+		float mouseX = 0.f;
+		float mouseY = 0.f;
+		Vec3 cursorRayOrigin = ZERO;
+		Vec3 cursorRayDirection = ZERO;
+		// Interpolated position of a remotely simulated player, presented with the rotation above.
+		bool hasRemoteTransform = false;
+		Vec3 remotePosition = ZERO;
+	};
+	SPendingUpdate m_pendingUpdate;
 	float regularAmmoCount;
 	float maxRegularAmmo;
 	float waterAmmoCount;
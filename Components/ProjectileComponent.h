@@ -0,0 +1,131 @@
+#pragma once
+#include <CryEntitySystem/IEntityComponent.h>
+#include "GamePlugin.h"
+////////////////////////////////////////////////////////
+// Physicalized bullet shot from weaponry.
+// Everything that differs between weapon types comes from the constexpr Traits, so each type compiles to its own
+// specialization without runtime checks. A traits struct needs:
+//   Type               - EProjectileType the projectile is pooled and tracked as
+//   InitialVelocity    - impulse applied along the muzzle forward axis on launch
+//   Mass               - mass of the rigid body
+//   Scale              - uniform scale of the sphere
+//   Lifetime           - seconds before the projectile manager expires the projectile
+//   DespawnOnCollision - whether the first collision returns the projectile to the pool
+//   SupportsHitscan    - whether the weapon honours the hitscan fire mode
+//   FireRate           - rounds per second a shooter can fire, the default of the weapon's fire rate CVar
+//   GetGUID()          - unique Schematyc GUID of the specialization
+////////////////////////////////////////////////////////
+template<typename Traits>
+class CProjectileComponent final : public IEntityComponent
+{
+public:
+	// Destructor for the bullet component.
+	virtual ~CProjectileComponent() {}
+
+	// Fires from the muzzle transform. The fire scheduler launches the shot through the projectile manager or as a
+	// hitscan shot within the frame's spawn budget. Returns false if the shooter is firing faster than the fire rate.
+	static bool Fire(const QuatTS& bulletOrigin, EntityId shooterId)
+	{
+		return CGamePlugin::GetInstance()->GetFireScheduler().RequestShot(Traits::Type, bulletOrigin, shooterId);
+	}
+
+	// Speed the launch impulse gives the bullet.
+	static constexpr float LaunchSpeed = Traits::InitialVelocity / Traits::Mass;
+
+	// Launches the bullet, called by the projectile pool every time this bullet is handed out.
+	// A replicated copy only shows a shot the server fired the age ago. It gets the velocity the server's bullet has
+	// by now and next to no mass, so that it cannot push anything around itself.
+	void Launch(bool isReplicatedCopy, float age)
+	{
+		auto* pPhysics = GetEntity()->GetPhysics();
+		if (pPhysics == nullptr)
+			return;
+
+		// The mass only changes when a pooled bullet switches between shots and copies
+		if (isReplicatedCopy != m_isReplicatedCopy)
+		{
+			pe_params_part partParams;
+			partParams.ipart = 0;
+			partParams.mass = isReplicatedCopy ? ReplicatedCopyMass : Traits::Mass;
+			pPhysics->SetParams(&partParams);
+			m_isReplicatedCopy = isReplicatedCopy;
+		}
+
+		const Vec3 forward = GetEntity()->GetWorldRotation().GetColumn1();
+		if (isReplicatedCopy)
+		{
+			pe_action_set_velocity setVelocity;
+			setVelocity.v = forward * LaunchSpeed + gEnv->pPhysicalWorld->GetPhysVars()->gravity * age;
+			pPhysics->Action(&setVelocity);
+			return;
+		}
+
+		// Apply an impulse so that the bullet flies forward
+		pe_action_impulse impulseAction;
+		// Set the actual impulse, in this case the initial velocity of the weapon type in bullet's forward direction
+		impulseAction.impulse = forward * Traits::InitialVelocity;
+		// Send to the physical entity
+		pPhysics->Action(&impulseAction);
+	}
+
+	// Set while the bullet sits in the pool's free list, so that a second release of the same bullet is ignored.
+	bool IsParked() const { return m_isParked; }
+	void SetParked(bool isParked) { m_isParked = isParked; }
+
+	// implement the initialize function here.
+	virtual void Initialize() override
+	{
+		// Set the model, the geometry and material are resolved once per level by the asset cache
+		CAssetCache& assetCache = CGamePlugin::GetInstance()->GetAssetCache();
+		const int geometrySlot = 0;
+		m_pEntity->SetStatObj(assetCache.GetGeometry(EGeometryAsset::Sphere), geometrySlot, false);
+
+		// Bind the custom bullet material.
+		m_pEntity->SetMaterial(assetCache.GetMaterial(EMaterialAsset::Bullet));
+
+		// Now create the physical representation of the entity
+		SEntityPhysicalizeParams physParams;
+		// Rigid physicalization type
+		physParams.type = PE_RIGID;
+		physParams.mass = Traits::Mass;
+		m_pEntity->Physicalize(physParams);
+
+		// Make sure that bullets are always rendered regardless of distance
+		// Ratio is 0 - 255, 255 being 100% visibility
+		GetEntity()->SetViewDistRatio(255);
+	}
+
+	// Reflect type to set a unique identifier for this component
+	static void ReflectType(Schematyc::CTypeDesc<CProjectileComponent<Traits>>& desc)
+	{
+		desc.SetGUID(Traits::GetGUID());
+	}
+
+	// Lifetime is aged by the projectile manager, so only types that despawn on impact need events.
+	virtual Cry::Entity::EventFlags GetEventMask() const override
+	{
+		if (Traits::DespawnOnCollision)
+		{
+			return { ENTITY_EVENT_COLLISION };
+		}
+		return {};
+	}
+
+	// Handling our event flags.
+	virtual void ProcessEvent(const SEntityEvent& event) override
+	{
+		// this event is triggered when collision occurs.
+		if (Traits::DespawnOnCollision && event.event == ENTITY_EVENT_COLLISION)
+		{
+			// return the bullet to the pool.
+			CGamePlugin::GetInstance()->GetProjectileManager().Despawn(GetEntityId());
+		}
+	}
+
+private:
+	// Mass of replicated copies, light enough that their collisions do not move anything.
+	static constexpr float ReplicatedCopyMass = 0.01f;
+
+	bool m_isParked = false;
+	bool m_isReplicatedCopy = false;
+};
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#include "RegularBullet.h"
+#include "WaterBullet.h"
+
+// Calls the function with a default constructed traits object of the projectile type, so that systems working
+// with runtime projectile types can reach the constexpr traits and the matching CProjectileComponent.
+// Adding a weapon type costs its traits struct and a case here.
+template<typename TFunction>
+void DispatchProjectileType(EProjectileType type, TFunction&& function)
+{
+	switch (type)
+	{
+	case EProjectileType::Regular:
+		function(SRegularBulletTraits());
+		break;
+	case EProjectileType::Water:
+		function(SWaterBulletTraits());
+		break;
+	}
+}
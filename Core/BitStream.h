@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Bit packed writer and reader for the network formats.
+// Values are written least significant bit first into a byte buffer, so a field only costs the bits it needs.
+// Engine independent like PlayerKernels.h.
+////////////////////////////////////////////////////////
+namespace NetKernels
+{
+	class CBitWriter
+	{
+	public:
+		explicit CBitWriter(std::vector<uint8_t>& buffer)
+			: m_buffer(buffer)
+		{
+			m_buffer.clear();
+		}
+
+		// Writes the lowest bitCount bits of the value, up to 32.
+		void WriteBits(uint32_t value, uint32_t bitCount)
+		{
+			for (uint32_t written = 0; written < bitCount;)
+			{
+				const uint32_t bitInByte = m_bitCount & 7;
+				if (bitInByte == 0)
+				{
+					m_buffer.push_back(0);
+				}
+
+				const uint32_t chunk = std::min(8 - bitInByte, bitCount - written);
+				const uint32_t bits = (value >> written) & ((1u << chunk) - 1);
+				m_buffer.back() |= static_cast<uint8_t>(bits << bitInByte);
+				written += chunk;
+				m_bitCount += chunk;
+			}
+		}
+
+		void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+
+		// Small values in few bits, larger ones in more: 0 as one bit, then up to the given widths.
+		// Used for deltas, which are zero or small most of the time.
+		void WriteVarBits(uint32_t value, uint32_t smallBitCount, uint32_t largeBitCount)
+		{
+			if (value == 0)
+			{
+				WriteBits(0, 1);
+			}
+			else if (value < (1u << smallBitCount))
+			{
+				WriteBits(1, 2);
+				WriteBits(value, smallBitCount);
+			}
+			else
+			{
+				WriteBits(3, 2);
+				WriteBits(value, largeBitCount);
+			}
+		}
+
+		uint32_t GetBitCount() const { return m_bitCount; }
+		uint32_t GetByteCount() const { return static_cast<uint32_t>(m_buffer.size()); }
+
+	private:
+		std::vector<uint8_t>& m_buffer;
+		uint32_t m_bitCount = 0;
+	};
+
+	class CBitReader
+	{
+	public:
+		CBitReader(const uint8_t* pData, uint32_t byteCount)
+			: m_pData(pData)
+			, m_bitLimit(byteCount * 8)
+		{
+		}
+
+		// Reads bitCount bits, up to 32. Reading past the end returns zeros and marks the reader as failed.
+		uint32_t ReadBits(uint32_t bitCount)
+		{
+			if (m_bitPosition + bitCount > m_bitLimit)
+			{
+				m_hasOverflowed = true;
+				m_bitPosition = m_bitLimit;
+				return 0;
+			}
+
+			uint32_t value = 0;
+			for (uint32_t read = 0; read < bitCount;)
+			{
+				const uint32_t bitInByte = m_bitPosition & 7;
+				const uint32_t chunk = std::min(8 - bitInByte, bitCount - read);
+				const uint32_t bits = (m_pData[m_bitPosition >> 3] >> bitInByte) & ((1u << chunk) - 1);
+				value |= bits << read;
+				read += chunk;
+				m_bitPosition += chunk;
+			}
+			return value;
+		}
+
+		bool ReadBool() { return ReadBits(1) != 0; }
+
+		uint32_t ReadVarBits(uint32_t smallBitCount, uint32_t largeBitCount)
+		{
+			if (ReadBits(1) == 0)
+				return 0;
+
+			return ReadBits(1) == 0 ? ReadBits(smallBitCount) : ReadBits(largeBitCount);
+		}
+
+		bool HasOverflowed() const { return m_hasOverflowed; }
+		uint32_t GetBitPosition() const { return m_bitPosition; }
+		uint32_t GetRemainingBits() const { return m_bitLimit - m_bitPosition; }
+
+	private:
+		const uint8_t* m_pData;
+		uint32_t m_bitLimit;
+		uint32_t m_bitPosition = 0;
+		bool m_hasOverflowed = false;
+	};
+
+	// Cube of the level that positions are quantized in, starting at the level origin and 512m below the ground.
+	struct SLevelGrid
+	{
+		float originX = 0.f;
+		float originY = 0.f;
+		float originZ = -512.f;
+		float extent = 4096.f;
+	};
+
+	// Maps a value in [minimum, maximum] to an unsigned integer of bitCount bits, clamping values outside the range.
+	inline uint32_t QuantizeFloat(float value, float minimum, float maximum, uint32_t bitCount)
+	{
+		const uint32_t steps = (bitCount >= 32 ? 0xFFFFFFFFu : (1u << bitCount) - 1);
+		const float normalized = (value - minimum) / (maximum - minimum);
+		const float clamped = normalized < 0.f ? 0.f : (normalized > 1.f ? 1.f : normalized);
+		return static_cast<uint32_t>(clamped * static_cast<float>(steps) + 0.5f);
+	}
+
+	inline float DequantizeFloat(uint32_t quantized, float minimum, float maximum, uint32_t bitCount)
+	{
+		const uint32_t steps = (bitCount >= 32 ? 0xFFFFFFFFu : (1u << bitCount) - 1);
+		return minimum + (maximum - minimum) * (static_cast<float>(quantized) / static_cast<float>(steps));
+	}
+
+	// Zig-zag encoding keeps small negative deltas small: 0, -1, 1, -2, 2 become 0, 1, 2, 3, 4.
+	inline uint32_t ZigZagEncode(int32_t value)
+	{
+		return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+	}
+
+	inline int32_t ZigZagDecode(uint32_t value)
+	{
+		return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+	}
+
+	// Unit quaternion as the three smallest components, 2 bits for the index of the largest and bitsPerComponent each.
+	// The dropped component is rebuilt from the unit length, its sign is folded into the others.
+	inline void WriteQuaternion(CBitWriter& writer, float x, float y, float z, float w, uint32_t bitsPerComponent)
+	{
+		const float components[4] = { x, y, z, w };
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; ++i)
+		{
+			if (std::fabs(components[i]) > std::fabs(components[largest]))
+			{
+				largest = i;
+			}
+		}
+
+		const float sign = components[largest] < 0.f ? -1.f : 1.f;
+		// The other components of a unit quaternion are at most 1/sqrt(2) in magnitude
+		const float range = 0.70710678f;
+		writer.WriteBits(largest, 2);
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i != largest)
+			{
+				writer.WriteBits(QuantizeFloat(components[i] * sign, -range, range, bitsPerComponent), bitsPerComponent);
+			}
+		}
+	}
+
+	inline void ReadQuaternion(CBitReader& reader, float& x, float& y, float& z, float& w, uint32_t bitsPerComponent)
+	{
+		const float range = 0.70710678f;
+		const uint32_t largest = reader.ReadBits(2);
+		float components[4];
+		float sumOfSquares = 0.f;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i != largest)
+			{
+				components[i] = DequantizeFloat(reader.ReadBits(bitsPerComponent), -range, range, bitsPerComponent);
+				sumOfSquares += components[i] * components[i];
+			}
+		}
+		components[largest] = std::sqrt(std::fmax(0.f, 1.f - sumOfSquares));
+
+		x = components[0];
+		y = components[1];
+		z = components[2];
+		w = components[3];
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "BitStream.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Compact fire events for replicating weapon fire.
+// Instead of a networked entity per bullet, the server sends one event per shot: who fired which weapon, the
+// quantized muzzle transform, when and with which random seed. Clients simulate the trajectory themselves from
+// the event and only show them, the server alone resolves hits.
+// Engine independent like PlayerKernels.h.
+////////////////////////////////////////////////////////
+namespace NetKernels
+{
+	struct SFireEvent
+	{
+		// Network index of the shooting entity.
+		uint16_t shooterIndex;
+		// EProjectileType of the weapon.
+		uint8_t weaponType;
+		// Set if the server resolved the shot with a ray query, there is no projectile to show then.
+		bool isHitscan;
+		float positionX, positionY, positionZ;
+		// Unit quaternion of the muzzle, the projectile flies along its forward (y) axis.
+		float rotationX, rotationY, rotationZ, rotationW;
+		float scale;
+		// Server time the shot was fired at, in milliseconds.
+		uint32_t timestampMs;
+		// Seed for any per-shot randomness, so that server and clients roll the same numbers.
+		uint16_t seed;
+	};
+
+	// Bit widths of the packed event.
+	// 20 bits over a 4 km level keeps positions within 2 mm, 11 bits per quaternion component keep the
+	// direction within about a milliradian.
+	const uint32_t FireEventShooterBits = 16;
+	const uint32_t FireEventWeaponBits = 2;
+	const uint32_t FireEventPositionBits = 20;
+	const uint32_t FireEventRotationBits = 11;
+	const uint32_t FireEventScaleBits = 12;
+	const float FireEventMaxScale = 8.f;
+	const uint32_t FireEventSeedBits = 16;
+	// Events in one packet at most, so that a packet stays below the usual 1200 byte payload.
+	const uint32_t MaxFireEventsPerPacket = 64;
+
+	inline void WriteFireEvent(CBitWriter& writer, const SLevelGrid& grid, const SFireEvent& event, uint32_t baseTimestampMs)
+	{
+		writer.WriteBits(event.shooterIndex, FireEventShooterBits);
+		writer.WriteBits(event.weaponType, FireEventWeaponBits);
+		writer.WriteBool(event.isHitscan);
+
+		writer.WriteBits(QuantizeFloat(event.positionX, grid.originX, grid.originX + grid.extent, FireEventPositionBits), FireEventPositionBits);
+		writer.WriteBits(QuantizeFloat(event.positionY, grid.originY, grid.originY + grid.extent, FireEventPositionBits), FireEventPositionBits);
+		writer.WriteBits(QuantizeFloat(event.positionZ, grid.originZ, grid.originZ + grid.extent, FireEventPositionBits), FireEventPositionBits);
+		WriteQuaternion(writer, event.rotationX, event.rotationY, event.rotationZ, event.rotationW, FireEventRotationBits);
+
+		// Muzzles are nearly always unscaled, that case costs a single bit
+		const bool isUnitScale = std::fabs(event.scale - 1.f) < 0.001f;
+		writer.WriteBool(isUnitScale);
+		if (!isUnitScale)
+		{
+			writer.WriteBits(QuantizeFloat(event.scale, 0.f, FireEventMaxScale, FireEventScaleBits), FireEventScaleBits);
+		}
+
+		// Shots in a packet were fired within a few frames of each other, so the time is a small offset from the packet
+		writer.WriteVarBits(event.timestampMs - baseTimestampMs, 6, 32);
+		writer.WriteBits(event.seed, FireEventSeedBits);
+	}
+
+	inline SFireEvent ReadFireEvent(CBitReader& reader, const SLevelGrid& grid, uint32_t baseTimestampMs)
+	{
+		SFireEvent event;
+		event.shooterIndex = static_cast<uint16_t>(reader.ReadBits(FireEventShooterBits));
+		event.weaponType = static_cast<uint8_t>(reader.ReadBits(FireEventWeaponBits));
+		event.isHitscan = reader.ReadBool();
+
+		event.positionX = DequantizeFloat(reader.ReadBits(FireEventPositionBits), grid.originX, grid.originX + grid.extent, FireEventPositionBits);
+		event.positionY = DequantizeFloat(reader.ReadBits(FireEventPositionBits), grid.originY, grid.originY + grid.extent, FireEventPositionBits);
+		event.positionZ = DequantizeFloat(reader.ReadBits(FireEventPositionBits), grid.originZ, grid.originZ + grid.extent, FireEventPositionBits);
+		ReadQuaternion(reader, event.rotationX, event.rotationY, event.rotationZ, event.rotationW, FireEventRotationBits);
+
+		event.scale = reader.ReadBool() ? 1.f : DequantizeFloat(reader.ReadBits(FireEventScaleBits), 0.f, FireEventMaxScale, FireEventScaleBits);
+		event.timestampMs = baseTimestampMs + reader.ReadVarBits(6, 32);
+		event.seed = static_cast<uint16_t>(reader.ReadBits(FireEventSeedBits));
+		return event;
+	}
+
+	// Packs up to MaxFireEventsPerPacket events into the packet: a 32 bit base time, the event count, then the events.
+	// The first event's time is used as the base, so events have to be in the order they were fired.
+	inline void EncodeFireEvents(const SLevelGrid& grid, const SFireEvent* pEvents, uint32_t count, std::vector<uint8_t>& packet)
+	{
+		CBitWriter writer(packet);
+		const uint32_t baseTimestampMs = count > 0 ? pEvents[0].timestampMs : 0;
+		const uint32_t packedCount = std::min(count, MaxFireEventsPerPacket);
+		writer.WriteBits(baseTimestampMs, 32);
+		writer.WriteBits(packedCount, 7);
+		for (uint32_t i = 0; i < packedCount; ++i)
+		{
+			WriteFireEvent(writer, grid, pEvents[i], baseTimestampMs);
+		}
+	}
+
+	// Appends the events of the packet, returns false if the packet was truncated or malformed.
+	inline bool DecodeFireEvents(const SLevelGrid& grid, const uint8_t* pPacket, uint32_t byteCount, std::vector<SFireEvent>& events)
+	{
+		CBitReader reader(pPacket, byteCount);
+		const uint32_t baseTimestampMs = reader.ReadBits(32);
+		const uint32_t count = reader.ReadBits(7);
+		if (count > MaxFireEventsPerPacket)
+			return false;
+
+		for (uint32_t i = 0; i < count && !reader.HasOverflowed(); ++i)
+		{
+			events.push_back(ReadFireEvent(reader, grid, baseTimestampMs));
+		}
+		return !reader.HasOverflowed();
+	}
+
+	// Speed a bullet entity leaves the muzzle with. CProjectileComponent launches it with an impulse, so the speed
+	// is that impulse divided by the mass of the rigid body.
+	inline float GetLaunchSpeed(float launchImpulse, float mass)
+	{
+		return mass > 0.f ? launchImpulse / mass : 0.f;
+	}
+
+	// Position of the projectile the given seconds after the shot, flying along the muzzle's forward axis
+	// at the launch speed and falling with gravity, the same flight a launched bullet entity has.
+	inline void EvaluateFireTrajectory(const SFireEvent& event, float launchSpeed, float gravityZ, float time, float& x, float& y, float& z)
+	{
+		// Forward (y) axis of the muzzle rotation
+		const float forwardX = 2.f * (event.rotationX * event.rotationY - event.rotationW * event.rotationZ);
+		const float forwardY = 1.f - 2.f * (event.rotationX * event.rotationX + event.rotationZ * event.rotationZ);
+		const float forwardZ = 2.f * (event.rotationY * event.rotationZ + event.rotationW * event.rotationX);
+
+		x = event.positionX + forwardX * launchSpeed * time;
+		y = event.positionY + forwardY * launchSpeed * time;
+		z = event.positionZ + forwardZ * launchSpeed * time + 0.5f * gravityZ * time * time;
+	}
+
+	// Bytes a projectile costs when it is replicated as a networked entity: a spawn with class, id and full transform,
+	// a physics state update (position, rotation, linear and angular velocity) every snapshot while it flies,
+	// and a removal. Used to put the fire event sizes into perspective.
+	const uint32_t EntitySpawnMessageBytes = 4 + 2 + 12 + 16 + 4 + 2;
+	const uint32_t EntityStateMessageBytes = 4 + 12 + 16 + 12 + 12;
+	const uint32_t EntityRemoveMessageBytes = 4;
+
+	inline uint32_t GetEntityReplicationBytes(float lifetime, float snapshotRate)
+	{
+		const uint32_t stateUpdates = static_cast<uint32_t>(std::ceil(lifetime * snapshotRate));
+		return EntitySpawnMessageBytes + stateUpdates * EntityStateMessageBytes + EntityRemoveMessageBytes;
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+////////////////////////////////////////////////////////
+// Fixed timestep simulation and render interpolation.
+// Frame time is accumulated and paid out in whole ticks of a fixed interval, so the simulation does the same
+// work per simulated second at any frame rate. What is left over is the interpolation fraction between the
+// last two ticks, used to present transforms smoothly in between.
+// Engine independent like PlayerKernels.h.
+////////////////////////////////////////////////////////
+namespace SimulationKernels
+{
+	class CFixedTimestep
+	{
+	public:
+		// Ticks per second, clamped to at least one.
+		void SetTickRate(float ticksPerSecond)
+		{
+			const float tickInterval = 1.f / (ticksPerSecond > 1.f ? ticksPerSecond : 1.f);
+			if (tickInterval != m_tickInterval)
+			{
+				// Keep the fraction of the current tick, not the seconds, so a rate change does not jump
+				m_accumulator = m_accumulator / m_tickInterval * tickInterval;
+				m_tickInterval = tickInterval;
+			}
+		}
+
+		// At most this many ticks run per frame. A frame that would need more drops the rest, so a long hitch
+		// slows the simulation down for a moment instead of making the next frames even longer.
+		void SetMaxTicksPerFrame(uint32_t maxTicks) { m_maxTicksPerFrame = maxTicks > 0 ? maxTicks : 1; }
+
+		// Adds the frame time and returns the number of ticks to run this frame, which may be zero.
+		uint32_t Advance(float frameTime)
+		{
+			m_accumulator += frameTime > 0.f ? frameTime : 0.f;
+			uint32_t ticks = static_cast<uint32_t>(m_accumulator / m_tickInterval);
+			if (ticks > m_maxTicksPerFrame)
+			{
+				m_droppedTicks += ticks - m_maxTicksPerFrame;
+				ticks = m_maxTicksPerFrame;
+				m_accumulator = std::fmod(m_accumulator, m_tickInterval);
+			}
+			else
+			{
+				m_accumulator -= static_cast<float>(ticks) * m_tickInterval;
+			}
+			// Float error must not leave a full tick behind or go below zero
+			if (m_accumulator >= m_tickInterval || m_accumulator < 0.f)
+			{
+				m_accumulator = 0.f;
+			}
+			return ticks;
+		}
+
+		float GetTickInterval() const { return m_tickInterval; }
+		// How far into the next tick the frame is, from 0 to 1. Presentation lerps from the previous to the last tick by this.
+		float GetInterpolationAlpha() const { return m_accumulator / m_tickInterval; }
+		uint64_t GetDroppedTicks() const { return m_droppedTicks; }
+		void Reset() { m_accumulator = 0.f; }
+
+	private:
+		float m_tickInterval = 1.f / 30.f;
+		float m_accumulator = 0.f;
+		uint32_t m_maxTicksPerFrame = 4;
+		uint64_t m_droppedTicks = 0;
+	};
+
+	// Position and yaw of a simulated object at the last two ticks it was updated at.
+	struct STransformInterpolator
+	{
+		float previous[4] = { 0.f, 0.f, 0.f, 0.f };
+		float current[4] = { 0.f, 0.f, 0.f, 0.f };
+		// Seconds between the two ticks and seconds presented since the current one arrived.
+		float interval = 1.f / 30.f;
+		float elapsed = 0.f;
+		bool hasState = false;
+
+		// Records the transform of a new tick, the next frames move from the current transform towards it.
+		void PushTick(float x, float y, float z, float yaw, float tickInterval)
+		{
+			if (hasState)
+			{
+				// Start from where the presentation is now, so a late tick does not snap back
+				Evaluate(previous[0], previous[1], previous[2], previous[3]);
+			}
+			else
+			{
+				previous[0] = x;
+				previous[1] = y;
+				previous[2] = z;
+				previous[3] = yaw;
+			}
+
+			current[0] = x;
+			current[1] = y;
+			current[2] = z;
+			current[3] = yaw;
+			interval = tickInterval > 0.f ? tickInterval : 1.f / 30.f;
+			elapsed = 0.f;
+			hasState = true;
+		}
+
+		void Advance(float frameTime) { elapsed += frameTime; }
+
+		// Transform to present this frame. It holds at the newest tick if the next one is late.
+		void Evaluate(float& x, float& y, float& z, float& yaw) const
+		{
+			const float alpha = elapsed < interval ? elapsed / interval : 1.f;
+			x = previous[0] + (current[0] - previous[0]) * alpha;
+			y = previous[1] + (current[1] - previous[1]) * alpha;
+			z = previous[2] + (current[2] - previous[2]) * alpha;
+
+			// Turn the short way round, from 170 to -170 degrees is 20 degrees and not 340
+			const float twoPi = 6.28318531f;
+			float yawDelta = std::fmod(current[3] - previous[3], twoPi);
+			yawDelta = yawDelta > 3.14159265f ? yawDelta - twoPi : (yawDelta < -3.14159265f ? yawDelta + twoPi : yawDelta);
+			yaw = previous[3] + yawDelta * alpha;
+		}
+	};
+}
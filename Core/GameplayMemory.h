@@ -0,0 +1,347 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+////////////////////////////////////////////////////////
+// Allocators for memory the gameplay plug-in owns.
+// A linear arena hands out memory for the lifetime of a level and is rewound in one go when the level unloads,
+// and size class pools recycle small blocks of the same size, so container nodes that are inserted and erased
+// all session long stop fragmenting the general heap. Both count what they hand out.
+// Engine independent like PlayerKernels.h, neither allocator is thread safe.
+////////////////////////////////////////////////////////
+namespace MemoryKernels
+{
+	// Blocks handed out are aligned to this, enough for any gameplay type.
+	static const size_t BlockAlignment = 16;
+
+	inline size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Live and total allocations of one owner.
+	struct SAllocationCounters
+	{
+		uint64_t liveBytes = 0;
+		uint64_t liveCount = 0;
+		uint64_t peakBytes = 0;
+		uint64_t totalCount = 0;
+
+		void Add(size_t bytes)
+		{
+			liveBytes += bytes;
+			++liveCount;
+			++totalCount;
+			peakBytes = liveBytes > peakBytes ? liveBytes : peakBytes;
+		}
+
+		void Remove(size_t bytes)
+		{
+			liveBytes -= bytes;
+			--liveCount;
+		}
+	};
+
+	// Bump allocator over a list of chunks. Memory is only given back all at once with Reset.
+	class CLinearArena
+	{
+	public:
+		explicit CLinearArena(size_t chunkSize = 64 * 1024) : m_chunkSize(chunkSize) {}
+		~CLinearArena() { FreeChunks(m_pFirstChunk); }
+
+		CLinearArena(const CLinearArena&) = delete;
+		CLinearArena& operator=(const CLinearArena&) = delete;
+
+		// Size of the chunks requested from the heap, applies to the chunks allocated after the call.
+		void SetChunkSize(size_t chunkSize) { m_chunkSize = chunkSize > 1024 ? chunkSize : 1024; }
+
+		// Returns nullptr only if the heap is out of memory. Alignment must be a power of two up to BlockAlignment.
+		void* Allocate(size_t size, size_t alignment = BlockAlignment)
+		{
+			size_t offset = AlignUp(m_chunkOffset, alignment);
+			if (m_pCurrentChunk == nullptr || offset + size > m_pCurrentChunk->size)
+			{
+				// Move on to the next chunk kept from an earlier level, or get a new one from the heap
+				SChunk* pNext = m_pCurrentChunk != nullptr ? m_pCurrentChunk->pNext : m_pFirstChunk;
+				if (pNext == nullptr || pNext->size < size)
+				{
+					pNext = AllocateChunk(size > m_chunkSize ? size : m_chunkSize);
+					if (pNext == nullptr)
+						return nullptr;
+				}
+				// The rest of the chunk we leave counts as used, nothing goes back into it before the reset
+				m_usedBytes += m_pCurrentChunk != nullptr ? m_pCurrentChunk->size - m_chunkOffset : 0;
+				m_pCurrentChunk = pNext;
+				m_chunkOffset = 0;
+				offset = 0;
+			}
+
+			m_usedBytes += offset - m_chunkOffset + size;
+			m_chunkOffset = offset + size;
+			m_peakBytes = m_usedBytes > m_peakBytes ? m_usedBytes : m_peakBytes;
+			return GetChunkData(m_pCurrentChunk) + offset;
+		}
+
+		// Forgets every allocation at once. If the level needed more than one chunk, they are replaced by a single
+		// chunk as large as all of them, so that the next level of the same size is served from one block.
+		void Reset()
+		{
+			if (m_pFirstChunk != nullptr && m_pFirstChunk->pNext != nullptr)
+			{
+				const size_t totalSize = m_reservedBytes;
+				FreeChunks(m_pFirstChunk);
+				m_pFirstChunk = nullptr;
+				m_pLastChunk = nullptr;
+				m_reservedBytes = 0;
+				m_chunkCount = 0;
+				AllocateChunk(totalSize);
+			}
+			m_pCurrentChunk = nullptr;
+			m_chunkOffset = 0;
+			m_usedBytes = 0;
+		}
+
+		// Bytes handed out since the last reset, including alignment padding and the unused ends of full chunks.
+		size_t GetUsedBytes() const { return m_usedBytes; }
+		size_t GetPeakBytes() const { return m_peakBytes; }
+		// Bytes held from the heap.
+		size_t GetReservedBytes() const { return m_reservedBytes; }
+		uint32_t GetChunkCount() const { return m_chunkCount; }
+
+	private:
+		struct SChunk
+		{
+			SChunk* pNext;
+			size_t size;
+		};
+
+		static uint8_t* GetChunkData(SChunk* pChunk) { return reinterpret_cast<uint8_t*>(pChunk) + AlignUp(sizeof(SChunk), BlockAlignment); }
+
+		SChunk* AllocateChunk(size_t size)
+		{
+			SChunk* pChunk = static_cast<SChunk*>(std::malloc(AlignUp(sizeof(SChunk), BlockAlignment) + size));
+			if (pChunk == nullptr)
+				return nullptr;
+
+			pChunk->pNext = nullptr;
+			pChunk->size = size;
+			// New chunks go to the end of the list, a kept chunk that was too small is merged away by the next reset
+			if (m_pLastChunk != nullptr)
+			{
+				m_pLastChunk->pNext = pChunk;
+			}
+			else
+			{
+				m_pFirstChunk = pChunk;
+			}
+			m_pLastChunk = pChunk;
+			m_reservedBytes += size;
+			++m_chunkCount;
+			return pChunk;
+		}
+
+		static void FreeChunks(SChunk* pChunk)
+		{
+			while (pChunk != nullptr)
+			{
+				SChunk* pNext = pChunk->pNext;
+				std::free(pChunk);
+				pChunk = pNext;
+			}
+		}
+
+		SChunk* m_pFirstChunk = nullptr;
+		SChunk* m_pLastChunk = nullptr;
+		SChunk* m_pCurrentChunk = nullptr;
+		size_t m_chunkOffset = 0;
+		size_t m_chunkSize;
+		size_t m_usedBytes = 0;
+		size_t m_peakBytes = 0;
+		size_t m_reservedBytes = 0;
+		uint32_t m_chunkCount = 0;
+	};
+
+	// Free lists for blocks of 16 to 512 bytes in power of two size classes.
+	// Blocks are carved from chunks that are kept for the whole session, a freed block is handed out again for the
+	// next request of its size class. Larger requests go to the heap.
+	class CSizeClassPool
+	{
+	public:
+		static const uint32_t ClassCount = 6;
+		static const size_t MinBlockSize = 16;
+		static const size_t MaxBlockSize = MinBlockSize << (ClassCount - 1);
+
+		struct SClassStatistics
+		{
+			// Blocks carved from chunks so far and blocks currently handed out.
+			uint32_t reservedBlocks = 0;
+			uint32_t usedBlocks = 0;
+		};
+
+		explicit CSizeClassPool(size_t chunkSize = 16 * 1024) : m_chunkSize(chunkSize) {}
+		~CSizeClassPool()
+		{
+			while (m_pChunks != nullptr)
+			{
+				SChunk* pNext = m_pChunks->pNext;
+				std::free(m_pChunks);
+				m_pChunks = pNext;
+			}
+		}
+
+		CSizeClassPool(const CSizeClassPool&) = delete;
+		CSizeClassPool& operator=(const CSizeClassPool&) = delete;
+
+		static uint32_t GetSizeClass(size_t size)
+		{
+			uint32_t sizeClass = 0;
+			size_t blockSize = MinBlockSize;
+			while (blockSize < size)
+			{
+				blockSize <<= 1;
+				++sizeClass;
+			}
+			return sizeClass;
+		}
+
+		static size_t GetBlockSize(uint32_t sizeClass) { return MinBlockSize << sizeClass; }
+
+		void* Allocate(size_t size)
+		{
+			if (size > MaxBlockSize)
+			{
+				++m_oversizedCount;
+				return std::malloc(size);
+			}
+
+			const uint32_t sizeClass = GetSizeClass(size);
+			SFreeBlock* pBlock = m_freeLists[sizeClass];
+			if (pBlock == nullptr)
+			{
+				pBlock = Refill(sizeClass);
+				if (pBlock == nullptr)
+					return nullptr;
+			}
+
+			m_freeLists[sizeClass] = pBlock->pNext;
+			++m_classStatistics[sizeClass].usedBlocks;
+			return pBlock;
+		}
+
+		// Size must be the size the block was allocated with.
+		void Free(void* pMemory, size_t size)
+		{
+			if (pMemory == nullptr)
+				return;
+
+			if (size > MaxBlockSize)
+			{
+				--m_oversizedCount;
+				std::free(pMemory);
+				return;
+			}
+
+			const uint32_t sizeClass = GetSizeClass(size);
+			SFreeBlock* pBlock = static_cast<SFreeBlock*>(pMemory);
+			pBlock->pNext = m_freeLists[sizeClass];
+			m_freeLists[sizeClass] = pBlock;
+			--m_classStatistics[sizeClass].usedBlocks;
+		}
+
+		const SClassStatistics& GetClassStatistics(uint32_t sizeClass) const { return m_classStatistics[sizeClass]; }
+		// Live allocations that were too large for the size classes.
+		uint32_t GetOversizedCount() const { return m_oversizedCount; }
+		size_t GetReservedBytes() const { return m_reservedBytes; }
+
+	private:
+		struct SFreeBlock
+		{
+			SFreeBlock* pNext;
+		};
+
+		struct SChunk
+		{
+			SChunk* pNext;
+		};
+
+		// Carves a new chunk into blocks of the size class and returns the first of them.
+		SFreeBlock* Refill(uint32_t sizeClass)
+		{
+			const size_t blockSize = GetBlockSize(sizeClass);
+			const size_t blockCount = m_chunkSize / blockSize > 0 ? m_chunkSize / blockSize : 1;
+			const size_t headerSize = AlignUp(sizeof(SChunk), BlockAlignment);
+			SChunk* pChunk = static_cast<SChunk*>(std::malloc(headerSize + blockCount * blockSize));
+			if (pChunk == nullptr)
+				return nullptr;
+
+			pChunk->pNext = m_pChunks;
+			m_pChunks = pChunk;
+			m_reservedBytes += blockCount * blockSize;
+			m_classStatistics[sizeClass].reservedBlocks += static_cast<uint32_t>(blockCount);
+
+			uint8_t* pData = reinterpret_cast<uint8_t*>(pChunk) + headerSize;
+			for (size_t i = blockCount; i-- > 0;)
+			{
+				SFreeBlock* pBlock = reinterpret_cast<SFreeBlock*>(pData + i * blockSize);
+				pBlock->pNext = m_freeLists[sizeClass];
+				m_freeLists[sizeClass] = pBlock;
+			}
+			return m_freeLists[sizeClass];
+		}
+
+		SFreeBlock* m_freeLists[ClassCount] = {};
+		SClassStatistics m_classStatistics[ClassCount];
+		SChunk* m_pChunks = nullptr;
+		size_t m_chunkSize;
+		size_t m_reservedBytes = 0;
+		uint32_t m_oversizedCount = 0;
+	};
+
+	// Fixed capacity array over memory it does not own, for example a block of a level arena.
+	// The owner attaches new storage after the memory was reset, the array itself never allocates.
+	template<typename T>
+	class TFixedArray
+	{
+	public:
+		void Attach(T* pData, uint32_t capacity)
+		{
+			m_pData = pData;
+			m_capacity = pData != nullptr ? capacity : 0;
+			m_size = 0;
+		}
+		// Forgets the storage, called before the memory behind it is reset.
+		void Detach() { Attach(nullptr, 0); }
+
+		bool IsAttached() const { return m_pData != nullptr; }
+		uint32_t size() const { return m_size; }
+		uint32_t capacity() const { return m_capacity; }
+		bool empty() const { return m_size == 0; }
+		bool full() const { return m_size == m_capacity; }
+
+		// Returns false if the array is full.
+		bool push_back(const T& value)
+		{
+			if (m_size == m_capacity)
+				return false;
+			m_pData[m_size++] = value;
+			return true;
+		}
+		void pop_back() { --m_size; }
+		void clear() { m_size = 0; }
+
+		T* data() { return m_pData; }
+		T* begin() { return m_pData; }
+		T* end() { return m_pData + m_size; }
+		T& back() { return m_pData[m_size - 1]; }
+		T& operator[](size_t index) { return m_pData[index]; }
+		const T& operator[](size_t index) const { return m_pData[index]; }
+
+	private:
+		T* m_pData = nullptr;
+		uint32_t m_size = 0;
+		uint32_t m_capacity = 0;
+	};
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+////////////////////////////////////////////////////////
+// Fixed size per player queue of input events.
+// The input callbacks only append to it and the player drains it once per frame before movement is computed,
+// so input is handled in one ordered pass over a small flat array.
+// Engine independent like PlayerKernels.h.
+////////////////////////////////////////////////////////
+namespace PlayerKernels
+{
+	// Every input action the player reacts to. The mouse axes are merged into one signed action per axis.
+	enum class EInputAction : uint8_t
+	{
+		MoveLeft = 0,
+		MoveRight,
+		MoveForward,
+		MoveBack,
+		Shoot,
+		SelectWeaponOne,
+		SelectWeaponTwo,
+		CursorPitch,
+		CursorYaw,
+		Count
+	};
+
+	struct SInputEvent
+	{
+		EInputAction action;
+		// EActionActivationMode bits, these all fit in 8 bits.
+		uint8_t activationMode;
+		float value;
+	};
+
+	// Axis actions only carry a delta, so two of them in a row can be merged into one.
+	inline bool IsAxisInputAction(EInputAction action)
+	{
+		return action == EInputAction::CursorPitch || action == EInputAction::CursorYaw;
+	}
+
+	template<uint32_t Capacity>
+	class CInputEventQueue
+	{
+	public:
+		// Appends an event, merging repeated axis deltas into the previous event.
+		// Returns false if the queue was full and the event was dropped.
+		bool Push(EInputAction action, uint8_t activationMode, float value)
+		{
+			if (IsAxisInputAction(action) && m_count > 0 && m_events[m_count - 1].action == action)
+			{
+				m_events[m_count - 1].value += value;
+				return true;
+			}
+
+			if (m_count == Capacity)
+			{
+				++m_droppedCount;
+				return false;
+			}
+
+			SInputEvent& event = m_events[m_count++];
+			event.action = action;
+			event.activationMode = activationMode;
+			event.value = value;
+			return true;
+		}
+
+		// Calls the handler for every queued event in the order they arrived and empties the queue.
+		template<typename THandler>
+		void Drain(THandler&& handler)
+		{
+			for (uint32_t i = 0; i < m_count; ++i)
+			{
+				handler(m_events[i]);
+			}
+			m_count = 0;
+		}
+
+		void Clear() { m_count = 0; }
+
+		uint32_t GetCount() const { return m_count; }
+		const SInputEvent& GetEvent(uint32_t index) const { return m_events[index]; }
+		// Events dropped because more than Capacity arrived in one frame.
+		uint32_t GetDroppedCount() const { return m_droppedCount; }
+
+	private:
+		SInputEvent m_events[Capacity];
+		uint32_t m_count = 0;
+		uint32_t m_droppedCount = 0;
+	};
+
+	// The queue every player collects its input in, the input recorder replays frames into the same type.
+	typedef CInputEventQueue<64> TPlayerInputEventQueue;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define PLAYER_KERNELS_SSE 1
+#else
+	#define PLAYER_KERNELS_SSE 0
+#endif
+
+////////////////////////////////////////////////////////
+// Engine independent player math and state logic.
+// CPlayerComponent calls these with engine types, the headless benchmarks call them with stand-ins,
+// so this header must not include anything from the engine.
+////////////////////////////////////////////////////////
+namespace PlayerKernels
+{
+	// Movement bits, these match CPlayerComponent::EInputFlag.
+	enum EMovementFlag : uint8_t
+	{
+		MovementFlag_Left = 1 << 0,
+		MovementFlag_Right = 1 << 1,
+		MovementFlag_Forward = 1 << 2,
+		MovementFlag_Back = 1 << 3,
+	};
+
+	// Applies an input flag change to the current flags.
+	// Held flags are set on press and cleared on release, toggled flags flip on release.
+	// Works with raw integers as well as CEnumFlags.
+	template<typename TFlags>
+	inline TFlags ApplyInputFlagChange(TFlags current, const TFlags& flags, bool isRelease, bool isToggle)
+	{
+		if (isToggle)
+		{
+			if (isRelease)
+			{
+				// Toggle the bit(s)
+				current ^= flags;
+			}
+		}
+		else if (isRelease)
+		{
+			current &= ~flags;
+		}
+		else
+		{
+			current |= flags;
+		}
+		return current;
+	}
+
+	struct SPlanarVelocity
+	{
+		float x;
+		float y;
+	};
+
+	// Velocity to add to the character controller for the held movement flags.
+	// Left and right only move in the top down view, and forward and back are mirrored in the side view.
+	inline SPlanarVelocity ComputeMovementVelocity(uint8_t flags, bool isTopDown, float moveSpeed, float frameTime)
+	{
+		const float step = moveSpeed * frameTime;
+		// Turn each bit into 0 or 1 so that the result is computed without branches
+		const float left = static_cast<float>((flags >> 0) & 1);
+		const float right = static_cast<float>((flags >> 1) & 1);
+		const float forward = static_cast<float>((flags >> 2) & 1);
+		const float back = static_cast<float>((flags >> 3) & 1);
+		const float forwardSign = isTopDown ? 1.f : -1.f;
+
+		SPlanarVelocity velocity;
+		velocity.x = isTopDown ? (right - left) * step : 0.f;
+		velocity.y = (forward - back) * step * forwardSign;
+		return velocity;
+	}
+
+	// Yaw in radians that turns the +Y forward axis towards the direction on the XY plane.
+	// Equivalent to extracting the yaw from Quat::CreateRotationVDir through CCamera::CreateAnglesYPR.
+	inline float ComputeFacingYaw(float directionX, float directionY)
+	{
+		return atan2f(-directionX, directionY);
+	}
+
+	// Rotation about Z that turns the +Y forward axis towards the direction, as the W and Z of a quaternion.
+	// Same rotation as Quat::CreateRotationZ(ComputeFacingYaw(x, y)), but built from the half vector
+	// between +Y and the direction so that no trigonometry is needed. A zero direction gives the identity.
+	inline void ComputeFacingRotation(float directionX, float directionY, float& rotationW, float& rotationZ)
+	{
+		const float lengthSquared = directionX * directionX + directionY * directionY;
+		if (lengthSquared < 1e-12f)
+		{
+			rotationW = 1.f;
+			rotationZ = 0.f;
+			return;
+		}
+
+		const float inverseLength = 1.f / sqrtf(lengthSquared);
+		float w = 1.f + directionY * inverseLength;
+		float z = -directionX * inverseLength;
+		const float halfLengthSquared = w * w + z * z;
+		// Facing exactly backwards, any half turn about Z will do
+		if (halfLengthSquared < 1e-12f)
+		{
+			rotationW = 0.f;
+			rotationZ = 1.f;
+			return;
+		}
+
+		const float inverseHalfLength = 1.f / sqrtf(halfLengthSquared);
+		rotationW = w * inverseHalfLength;
+		rotationZ = z * inverseHalfLength;
+	}
+
+	// ComputeFacingRotation for many characters at once over structure of arrays buffers, four per instruction.
+	inline void ComputeFacingRotations(const float* pDirectionX, const float* pDirectionY, float* pRotationW, float* pRotationZ, uint32_t count)
+	{
+		uint32_t i = 0;
+#if PLAYER_KERNELS_SSE
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 epsilon = _mm_set1_ps(1e-12f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(pDirectionX + i);
+			const __m128 y = _mm_loadu_ps(pDirectionY + i);
+			const __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+			// Zero directions are replaced by +Y so that they come out as the identity
+			const __m128 isZero = _mm_cmplt_ps(lengthSquared, epsilon);
+			const __m128 inverseLength = _mm_andnot_ps(isZero, _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(lengthSquared, epsilon))));
+
+			// The masked product of a zero or tiny negative y is -0, so it is masked out again instead of or'ed with +1
+			__m128 w = _mm_add_ps(one, _mm_or_ps(_mm_andnot_ps(isZero, _mm_mul_ps(y, inverseLength)), _mm_and_ps(isZero, one)));
+			__m128 z = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(x, inverseLength));
+
+			const __m128 halfLengthSquared = _mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(z, z));
+			// Facing exactly backwards becomes a half turn
+			const __m128 isBackwards = _mm_cmplt_ps(halfLengthSquared, epsilon);
+			const __m128 inverseHalfLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(halfLengthSquared, epsilon)));
+			w = _mm_andnot_ps(isBackwards, _mm_mul_ps(w, inverseHalfLength));
+			z = _mm_or_ps(_mm_andnot_ps(isBackwards, _mm_mul_ps(z, inverseHalfLength)), _mm_and_ps(isBackwards, one));
+
+			_mm_storeu_ps(pRotationW + i, w);
+			_mm_storeu_ps(pRotationZ + i, z);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			ComputeFacingRotation(pDirectionX[i], pDirectionY[i], pRotationW[i], pRotationZ[i]);
+		}
+	}
+
+	// Number of batches to split count players into for worker threads. Each batch has at least minBatchSize
+	// players so that a job is worth its scheduling cost, and there are never more than maxBatches.
+	inline uint32_t ComputeBatchCount(uint32_t count, uint32_t minBatchSize, uint32_t maxBatches)
+	{
+		if (count == 0)
+			return 0;
+
+		const uint32_t batchSize = minBatchSize > 0 ? minBatchSize : 1;
+		const uint32_t batchCount = (count + batchSize - 1) / batchSize;
+		return batchCount < maxBatches ? batchCount : (maxBatches > 0 ? maxBatches : 1);
+	}
+
+	// Players [begin, end) of one batch. The batches are contiguous and differ in size by one player at most.
+	inline void GetBatchRange(uint32_t count, uint32_t batchCount, uint32_t batch, uint32_t& begin, uint32_t& end)
+	{
+		const uint32_t baseSize = count / batchCount;
+		const uint32_t remainder = count % batchCount;
+		begin = batch * baseSize + (batch < remainder ? batch : remainder);
+		end = begin + baseSize + (batch < remainder ? 1 : 0);
+	}
+}
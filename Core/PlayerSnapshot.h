@@ -0,0 +1,426 @@
+#pragma once
+
+#include "BitStream.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Bit packed snapshots of the player state that matters over the network.
+// Every field is quantized to the bits it needs, and each snapshot is delta encoded against the last snapshot the
+// receiver acknowledged, so a player that stands still costs a single bit and a walking player a few bytes.
+// Every entry carries the id of its player, so a slot that changes hands is sent in full instead of as a delta.
+// Engine independent like PlayerKernels.h.
+////////////////////////////////////////////////////////
+namespace NetKernels
+{
+	struct SPlayerState
+	{
+		// Entity id of the player in this slot, 0 for an empty slot.
+		uint32_t playerId;
+		float positionX, positionY, positionZ;
+		// Rotation about the up axis in radians.
+		float yaw;
+		// The four movement flags of CPlayerComponent::EInputFlag.
+		uint8_t inputFlags;
+		// Selected weapon, 0 or 1.
+		uint8_t selection;
+		uint8_t regularAmmo;
+		uint8_t waterAmmo;
+		// CPlayerComponent::cameraSelection.
+		uint8_t cameraMode;
+	};
+
+	struct SQuantizedPlayerState
+	{
+		uint32_t playerId;
+		uint32_t positionX, positionY, positionZ;
+		uint16_t yaw;
+		uint8_t inputFlags;
+		uint8_t selection;
+		uint8_t regularAmmo;
+		uint8_t waterAmmo;
+		uint8_t cameraMode;
+
+		bool operator==(const SQuantizedPlayerState& other) const
+		{
+			return playerId == other.playerId && positionX == other.positionX && positionY == other.positionY && positionZ == other.positionZ && yaw == other.yaw
+				&& inputFlags == other.inputFlags && selection == other.selection && regularAmmo == other.regularAmmo
+				&& waterAmmo == other.waterAmmo && cameraMode == other.cameraMode;
+		}
+		bool operator!=(const SQuantizedPlayerState& other) const { return !(*this == other); }
+	};
+
+	// Bit widths of the snapshot fields.
+	// 20 bits over a 4 km level keep positions within 2 mm, 16 bits of yaw are a tenth of a milliradian.
+	const uint32_t SnapshotPlayerIdBits = 32;
+	const uint32_t SnapshotPositionBits = 20;
+	const uint32_t SnapshotYawBits = 16;
+	const uint32_t SnapshotInputFlagBits = 4;
+	const uint32_t SnapshotSelectionBits = 1;
+	const uint32_t SnapshotAmmoBits = 8;
+	const uint32_t SnapshotCameraModeBits = 3;
+	// A walking player moves a few hundred grid steps per tick at most, that fits the small position delta
+	const uint32_t SnapshotSmallPositionDeltaBits = 9;
+	const uint32_t SnapshotSmallYawDeltaBits = 7;
+	// Snapshots the sender remembers, an acknowledgement older than this falls back to a full snapshot.
+	const uint32_t SnapshotHistorySize = 32;
+
+	inline SQuantizedPlayerState QuantizePlayerState(const SLevelGrid& grid, const SPlayerState& state)
+	{
+		const float twoPi = 6.28318531f;
+		SQuantizedPlayerState quantized;
+		quantized.playerId = state.playerId;
+		quantized.positionX = QuantizeFloat(state.positionX, grid.originX, grid.originX + grid.extent, SnapshotPositionBits);
+		quantized.positionY = QuantizeFloat(state.positionY, grid.originY, grid.originY + grid.extent, SnapshotPositionBits);
+		quantized.positionZ = QuantizeFloat(state.positionZ, grid.originZ, grid.originZ + grid.extent, SnapshotPositionBits);
+		// Wrap the yaw into a full turn, 65536 steps map back onto 0
+		const float turns = state.yaw / twoPi;
+		quantized.yaw = static_cast<uint16_t>(static_cast<int32_t>(std::floor((turns - std::floor(turns)) * 65536.f + 0.5f)) & 0xFFFF);
+		quantized.inputFlags = state.inputFlags & 0xF;
+		quantized.selection = state.selection & 0x1;
+		quantized.regularAmmo = state.regularAmmo;
+		quantized.waterAmmo = state.waterAmmo;
+		quantized.cameraMode = state.cameraMode & 0x7;
+		return quantized;
+	}
+
+	inline SPlayerState DequantizePlayerState(const SLevelGrid& grid, const SQuantizedPlayerState& quantized)
+	{
+		const float twoPi = 6.28318531f;
+		SPlayerState state;
+		state.playerId = quantized.playerId;
+		state.positionX = DequantizeFloat(quantized.positionX, grid.originX, grid.originX + grid.extent, SnapshotPositionBits);
+		state.positionY = DequantizeFloat(quantized.positionY, grid.originY, grid.originY + grid.extent, SnapshotPositionBits);
+		state.positionZ = DequantizeFloat(quantized.positionZ, grid.originZ, grid.originZ + grid.extent, SnapshotPositionBits);
+		// Back into -pi to pi, the range the entity rotation reports
+		const float yaw = static_cast<float>(quantized.yaw) / 65536.f * twoPi;
+		state.yaw = yaw > 3.14159265f ? yaw - twoPi : yaw;
+		state.inputFlags = quantized.inputFlags;
+		state.selection = quantized.selection;
+		state.regularAmmo = quantized.regularAmmo;
+		state.waterAmmo = quantized.waterAmmo;
+		state.cameraMode = quantized.cameraMode;
+		return state;
+	}
+
+	inline void WritePositionDelta(CBitWriter& writer, uint32_t value, uint32_t baseline)
+	{
+		writer.WriteVarBits(ZigZagEncode(static_cast<int32_t>(value) - static_cast<int32_t>(baseline)), SnapshotSmallPositionDeltaBits, SnapshotPositionBits + 1);
+	}
+
+	inline uint32_t ReadPositionDelta(CBitReader& reader, uint32_t baseline)
+	{
+		return static_cast<uint32_t>(static_cast<int32_t>(baseline) + ZigZagDecode(reader.ReadVarBits(SnapshotSmallPositionDeltaBits, SnapshotPositionBits + 1)));
+	}
+
+	// Full state without a baseline, about 17 bytes.
+	inline void WritePlayerState(CBitWriter& writer, const SQuantizedPlayerState& state)
+	{
+		writer.WriteBits(state.playerId, SnapshotPlayerIdBits);
+		writer.WriteBits(state.positionX, SnapshotPositionBits);
+		writer.WriteBits(state.positionY, SnapshotPositionBits);
+		writer.WriteBits(state.positionZ, SnapshotPositionBits);
+		writer.WriteBits(state.yaw, SnapshotYawBits);
+		writer.WriteBits(state.inputFlags, SnapshotInputFlagBits);
+		writer.WriteBits(state.selection, SnapshotSelectionBits);
+		writer.WriteBits(state.regularAmmo, SnapshotAmmoBits);
+		writer.WriteBits(state.waterAmmo, SnapshotAmmoBits);
+		writer.WriteBits(state.cameraMode, SnapshotCameraModeBits);
+	}
+
+	inline SQuantizedPlayerState ReadPlayerState(CBitReader& reader)
+	{
+		SQuantizedPlayerState state;
+		state.playerId = reader.ReadBits(SnapshotPlayerIdBits);
+		state.positionX = reader.ReadBits(SnapshotPositionBits);
+		state.positionY = reader.ReadBits(SnapshotPositionBits);
+		state.positionZ = reader.ReadBits(SnapshotPositionBits);
+		state.yaw = static_cast<uint16_t>(reader.ReadBits(SnapshotYawBits));
+		state.inputFlags = static_cast<uint8_t>(reader.ReadBits(SnapshotInputFlagBits));
+		state.selection = static_cast<uint8_t>(reader.ReadBits(SnapshotSelectionBits));
+		state.regularAmmo = static_cast<uint8_t>(reader.ReadBits(SnapshotAmmoBits));
+		state.waterAmmo = static_cast<uint8_t>(reader.ReadBits(SnapshotAmmoBits));
+		state.cameraMode = static_cast<uint8_t>(reader.ReadBits(SnapshotCameraModeBits));
+		return state;
+	}
+
+	// Delta against the baseline: one bit if nothing changed, otherwise a bit per field group and only the changed groups.
+	// A slot that now holds another player has nothing in common with its baseline and is sent in full.
+	inline void WritePlayerStateDelta(CBitWriter& writer, const SQuantizedPlayerState& state, const SQuantizedPlayerState& baseline)
+	{
+		const bool playerChanged = state.playerId != baseline.playerId;
+		const bool positionChanged = state.positionX != baseline.positionX || state.positionY != baseline.positionY || state.positionZ != baseline.positionZ;
+		const bool yawChanged = state.yaw != baseline.yaw;
+		const bool inputChanged = state.inputFlags != baseline.inputFlags || state.selection != baseline.selection;
+		const bool ammoChanged = state.regularAmmo != baseline.regularAmmo || state.waterAmmo != baseline.waterAmmo;
+		const bool cameraChanged = state.cameraMode != baseline.cameraMode;
+
+		const bool anyChanged = playerChanged || positionChanged || yawChanged || inputChanged || ammoChanged || cameraChanged;
+		writer.WriteBool(anyChanged);
+		if (!anyChanged)
+			return;
+
+		writer.WriteBool(playerChanged);
+		if (playerChanged)
+		{
+			WritePlayerState(writer, state);
+			return;
+		}
+
+		writer.WriteBool(positionChanged);
+		if (positionChanged)
+		{
+			WritePositionDelta(writer, state.positionX, baseline.positionX);
+			WritePositionDelta(writer, state.positionY, baseline.positionY);
+			WritePositionDelta(writer, state.positionZ, baseline.positionZ);
+		}
+
+		writer.WriteBool(yawChanged);
+		if (yawChanged)
+		{
+			// The 16 bit difference wraps around, so turning across zero is a small delta too
+			writer.WriteVarBits(ZigZagEncode(static_cast<int16_t>(state.yaw - baseline.yaw)), SnapshotSmallYawDeltaBits, SnapshotYawBits);
+		}
+
+		writer.WriteBool(inputChanged);
+		if (inputChanged)
+		{
+			writer.WriteBits(state.inputFlags, SnapshotInputFlagBits);
+			writer.WriteBits(state.selection, SnapshotSelectionBits);
+		}
+
+		writer.WriteBool(ammoChanged);
+		if (ammoChanged)
+		{
+			writer.WriteBits(state.regularAmmo, SnapshotAmmoBits);
+			writer.WriteBits(state.waterAmmo, SnapshotAmmoBits);
+		}
+
+		writer.WriteBool(cameraChanged);
+		if (cameraChanged)
+		{
+			writer.WriteBits(state.cameraMode, SnapshotCameraModeBits);
+		}
+	}
+
+	inline SQuantizedPlayerState ReadPlayerStateDelta(CBitReader& reader, const SQuantizedPlayerState& baseline)
+	{
+		SQuantizedPlayerState state = baseline;
+		if (!reader.ReadBool())
+			return state;
+
+		if (reader.ReadBool())
+			return ReadPlayerState(reader);
+
+		if (reader.ReadBool())
+		{
+			state.positionX = ReadPositionDelta(reader, baseline.positionX);
+			state.positionY = ReadPositionDelta(reader, baseline.positionY);
+			state.positionZ = ReadPositionDelta(reader, baseline.positionZ);
+		}
+
+		if (reader.ReadBool())
+		{
+			state.yaw = static_cast<uint16_t>(baseline.yaw + ZigZagDecode(reader.ReadVarBits(SnapshotSmallYawDeltaBits, SnapshotYawBits)));
+		}
+
+		if (reader.ReadBool())
+		{
+			state.inputFlags = static_cast<uint8_t>(reader.ReadBits(SnapshotInputFlagBits));
+			state.selection = static_cast<uint8_t>(reader.ReadBits(SnapshotSelectionBits));
+		}
+
+		if (reader.ReadBool())
+		{
+			state.regularAmmo = static_cast<uint8_t>(reader.ReadBits(SnapshotAmmoBits));
+			state.waterAmmo = static_cast<uint8_t>(reader.ReadBits(SnapshotAmmoBits));
+		}
+
+		if (reader.ReadBool())
+		{
+			state.cameraMode = static_cast<uint8_t>(reader.ReadBits(SnapshotCameraModeBits));
+		}
+		return state;
+	}
+
+	// Server side of a connection. Remembers the snapshots it sent and encodes every new one against the newest
+	// snapshot the client acknowledged. Players keep their slot, the index in the state array, for as long as they exist.
+	class CSnapshotSender
+	{
+	public:
+		explicit CSnapshotSender(const SLevelGrid& grid = SLevelGrid())
+			: m_grid(grid)
+		{
+		}
+
+		// Encodes the states as the next snapshot: sequence, baseline sequence if any, player count, then the players.
+		void Encode(const SPlayerState* pStates, uint32_t count, std::vector<uint8_t>& packet)
+		{
+			const uint16_t sequence = m_nextSequence++;
+			SHistoryEntry& entry = m_history[sequence % SnapshotHistorySize];
+			entry.sequence = sequence;
+			entry.isValid = true;
+			entry.states.resize(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				entry.states[i] = QuantizePlayerState(m_grid, pStates[i]);
+			}
+
+			// The baseline is only usable while it is still in the history
+			const SHistoryEntry* pBaseline = nullptr;
+			if (m_hasAcknowledged && static_cast<uint16_t>(sequence - m_acknowledgedSequence) < SnapshotHistorySize)
+			{
+				pBaseline = &m_history[m_acknowledgedSequence % SnapshotHistorySize];
+			}
+
+			m_wasDelta = pBaseline != nullptr;
+			CBitWriter writer(packet);
+			writer.WriteBits(sequence, 16);
+			writer.WriteBool(pBaseline != nullptr);
+			if (pBaseline != nullptr)
+			{
+				writer.WriteBits(pBaseline->sequence, 16);
+			}
+			writer.WriteBits(count, 16);
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				// Players that joined after the baseline are sent in full
+				if (pBaseline != nullptr && i < pBaseline->states.size())
+				{
+					WritePlayerStateDelta(writer, entry.states[i], pBaseline->states[i]);
+				}
+				else
+				{
+					WritePlayerState(writer, entry.states[i]);
+				}
+			}
+		}
+
+		// The client received and decoded the snapshot, later snapshots are encoded against it.
+		void Acknowledge(uint16_t sequence)
+		{
+			const SHistoryEntry& entry = m_history[sequence % SnapshotHistorySize];
+			// Ignore acknowledgements older than the current baseline or for snapshots no longer remembered
+			if (!entry.isValid || entry.sequence != sequence || (m_hasAcknowledged && static_cast<int16_t>(sequence - m_acknowledgedSequence) <= 0))
+				return;
+
+			m_acknowledgedSequence = sequence;
+			m_hasAcknowledged = true;
+		}
+
+		// Forgets every baseline, the next snapshot is sent in full.
+		void Reset()
+		{
+			m_hasAcknowledged = false;
+			for (SHistoryEntry& entry : m_history)
+			{
+				entry.isValid = false;
+				entry.states.clear();
+			}
+		}
+
+		void SetGrid(const SLevelGrid& grid) { m_grid = grid; Reset(); }
+		const SLevelGrid& GetGrid() const { return m_grid; }
+		// False if the last snapshot had no acknowledged baseline and went out in full.
+		bool WasLastSnapshotDelta() const { return m_wasDelta; }
+
+	private:
+		struct SHistoryEntry
+		{
+			uint16_t sequence = 0;
+			bool isValid = false;
+			std::vector<SQuantizedPlayerState> states;
+		};
+
+		SLevelGrid m_grid;
+		std::array<SHistoryEntry, SnapshotHistorySize> m_history;
+		uint16_t m_nextSequence = 0;
+		uint16_t m_acknowledgedSequence = 0;
+		bool m_hasAcknowledged = false;
+		bool m_wasDelta = false;
+	};
+
+	// Client side of a connection. Keeps the snapshots it decoded so that it can apply deltas against any of them.
+	class CSnapshotReceiver
+	{
+	public:
+		explicit CSnapshotReceiver(const SLevelGrid& grid = SLevelGrid())
+			: m_grid(grid)
+		{
+		}
+
+		// Decodes the snapshot into the states, returns false if the packet is malformed or its baseline is unknown.
+		// The sequence to acknowledge comes back in the sequence argument.
+		bool Decode(const uint8_t* pPacket, uint32_t byteCount, std::vector<SPlayerState>& states, uint16_t& sequence)
+		{
+			CBitReader reader(pPacket, byteCount);
+			sequence = static_cast<uint16_t>(reader.ReadBits(16));
+			const SHistoryEntry* pBaseline = nullptr;
+			if (reader.ReadBool())
+			{
+				const uint16_t baselineSequence = static_cast<uint16_t>(reader.ReadBits(16));
+				pBaseline = &m_history[baselineSequence % SnapshotHistorySize];
+				if (pBaseline->sequence != baselineSequence || !pBaseline->isValid)
+					return false;
+			}
+			const uint32_t count = reader.ReadBits(16);
+			// Every player takes at least one bit, a larger count comes from a broken packet and must not size the arrays
+			if (reader.HasOverflowed() || count > reader.GetRemainingBits())
+				return false;
+
+			// Decoded into scratch first, the history entry may be the baseline itself
+			m_decoded.resize(count);
+			for (uint32_t i = 0; i < count && !reader.HasOverflowed(); ++i)
+			{
+				m_decoded[i] = pBaseline != nullptr && i < pBaseline->states.size() ? ReadPlayerStateDelta(reader, pBaseline->states[i]) : ReadPlayerState(reader);
+			}
+			if (reader.HasOverflowed())
+				return false;
+
+			SHistoryEntry& entry = m_history[sequence % SnapshotHistorySize];
+			entry.sequence = sequence;
+			entry.isValid = true;
+			entry.states.swap(m_decoded);
+
+			states.resize(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				states[i] = DequantizePlayerState(m_grid, entry.states[i]);
+			}
+			return true;
+		}
+
+		// Quantized states of the last decoded snapshot of the sequence, for comparing with what the sender had.
+		const std::vector<SQuantizedPlayerState>* GetQuantizedStates(uint16_t sequence) const
+		{
+			const SHistoryEntry& entry = m_history[sequence % SnapshotHistorySize];
+			return entry.isValid && entry.sequence == sequence ? &entry.states : nullptr;
+		}
+
+		void Reset()
+		{
+			for (SHistoryEntry& entry : m_history)
+			{
+				entry.isValid = false;
+				entry.states.clear();
+			}
+		}
+
+		void SetGrid(const SLevelGrid& grid) { m_grid = grid; Reset(); }
+
+	private:
+		struct SHistoryEntry
+		{
+			uint16_t sequence = 0;
+			bool isValid = false;
+			std::vector<SQuantizedPlayerState> states;
+		};
+
+		SLevelGrid m_grid;
+		std::array<SHistoryEntry, SnapshotHistorySize> m_history;
+		std::vector<SQuantizedPlayerState> m_decoded;
+	};
+}
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define TRIGGER_BROADPHASE_SSE 1
+#else
+	#define TRIGGER_BROADPHASE_SSE 0
+#endif
+
+////////////////////////////////////////////////////////
+// Broadphase for large numbers of static trigger volumes.
+// Trigger boxes are bucketed into a uniform spatial hash whose cells store their boxes as contiguous
+// min/max arrays, so a player box is tested against four triggers per instruction.
+// Players are tested once per frame and the overlap changes come back as enter and leave events.
+// Triggers that would touch too many cells are kept in a separate list and tested against every player instead.
+// Engine independent like PlayerKernels.h.
+////////////////////////////////////////////////////////
+namespace TriggerKernels
+{
+	struct SBounds
+	{
+		float minX, minY, minZ;
+		float maxX, maxY, maxZ;
+	};
+
+	struct SOverlapEvent
+	{
+		uint32_t playerId;
+		uint32_t triggerId;
+		// True when the player entered the trigger, false when it left.
+		bool isEnter;
+	};
+
+	inline bool Overlaps(const SBounds& a, const SBounds& b)
+	{
+		return a.minX <= b.maxX && a.maxX >= b.minX
+			&& a.minY <= b.maxY && a.maxY >= b.minY
+			&& a.minZ <= b.maxZ && a.maxZ >= b.minZ;
+	}
+
+	class CTriggerBroadphase
+	{
+	public:
+		explicit CTriggerBroadphase(float cellSize = 8.f)
+			: m_cellSize(cellSize)
+			, m_inverseCellSize(1.f / cellSize)
+		{
+		}
+
+		// Cell edge length in meters, triggers are usually a few meters so cells a few times larger keep
+		// the number of cells per trigger low without putting too many triggers into one cell.
+		void SetCellSize(float cellSize)
+		{
+			m_cellSize = cellSize;
+			m_inverseCellSize = 1.f / cellSize;
+			m_isDirty = true;
+		}
+
+		// Trigger ids must be unique, they are reported back in the overlap events.
+		void AddTrigger(uint32_t triggerId, const SBounds& bounds)
+		{
+			m_triggerIndices[triggerId] = static_cast<uint32_t>(m_triggerIds.size());
+			m_triggerIds.push_back(triggerId);
+			m_triggerBounds.push_back(bounds);
+			m_isDirty = true;
+		}
+
+		bool MoveTrigger(uint32_t triggerId, const SBounds& bounds)
+		{
+			const size_t index = FindTrigger(triggerId);
+			if (index == m_triggerIds.size())
+				return false;
+
+			m_triggerBounds[index] = bounds;
+			m_isDirty = true;
+			return true;
+		}
+
+		// Players inside a removed trigger get a leave event on the next update.
+		bool RemoveTrigger(uint32_t triggerId)
+		{
+			const size_t index = FindTrigger(triggerId);
+			if (index == m_triggerIds.size())
+				return false;
+
+			m_triggerIndices.erase(triggerId);
+			if (index + 1 != m_triggerIds.size())
+			{
+				m_triggerIds[index] = m_triggerIds.back();
+				m_triggerBounds[index] = m_triggerBounds.back();
+				m_triggerIndices[m_triggerIds[index]] = static_cast<uint32_t>(index);
+			}
+			m_triggerIds.pop_back();
+			m_triggerBounds.pop_back();
+			m_isDirty = true;
+			return true;
+		}
+
+		// Forgets every trigger and player without emitting events.
+		void Clear()
+		{
+			m_triggerIds.clear();
+			m_triggerBounds.clear();
+			m_triggerIndices.clear();
+			m_players.clear();
+			m_isDirty = true;
+		}
+
+		uint32_t GetTriggerCount() const { return static_cast<uint32_t>(m_triggerIds.size()); }
+		// True while any player is still inside a trigger, they get their leave events on the next update.
+		bool HasOverlaps() const
+		{
+			for (const auto& player : m_players)
+			{
+				if (!player.second.overlaps.empty())
+					return true;
+			}
+			return false;
+		}
+		uint32_t GetCellCount() const { return static_cast<uint32_t>(m_cellKeys.size()); }
+		// Triggers too large for the cells, tested against every player.
+		uint32_t GetLargeTriggerCount() const { return static_cast<uint32_t>(m_largeTriggers.size()); }
+
+		// Tests every player against the triggers and appends the enter and leave events since the last update.
+		// Players missing from this update leave every trigger they were in.
+		void Update(const uint32_t* pPlayerIds, const SBounds* pPlayerBounds, uint32_t playerCount, std::vector<SOverlapEvent>& events)
+		{
+			if (m_isDirty)
+			{
+				Rebuild();
+			}
+
+			++m_updateCount;
+			for (uint32_t i = 0; i < playerCount; ++i)
+			{
+				const uint32_t playerId = pPlayerIds[i];
+				QueryOverlaps(pPlayerBounds[i], m_overlaps);
+
+				SPlayerState& state = m_players[playerId];
+				state.lastUpdate = m_updateCount;
+				EmitChanges(playerId, state.overlaps, m_overlaps, events);
+				state.overlaps.swap(m_overlaps);
+			}
+
+			for (auto it = m_players.begin(); it != m_players.end();)
+			{
+				if (it->second.lastUpdate != m_updateCount)
+				{
+					m_overlaps.clear();
+					EmitChanges(it->first, it->second.overlaps, m_overlaps, events);
+					it = m_players.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		// Ids of the triggers overlapping the box, sorted and without duplicates.
+		void QueryOverlaps(const SBounds& bounds, std::vector<uint32_t>& triggerIds)
+		{
+			if (m_isDirty)
+			{
+				Rebuild();
+			}
+
+			triggerIds.clear();
+			if (m_cellKeys.empty() && m_largeTriggers.empty())
+				return;
+
+			for (const uint32_t trigger : m_largeTriggers)
+			{
+				if (Overlaps(m_triggerBounds[trigger], bounds))
+				{
+					triggerIds.push_back(m_triggerIds[trigger]);
+				}
+			}
+
+			const int32_t minCellX = ToCell(bounds.minX), maxCellX = ToCell(bounds.maxX);
+			const int32_t minCellY = ToCell(bounds.minY), maxCellY = ToCell(bounds.maxY);
+			const int32_t minCellZ = ToCell(bounds.minZ), maxCellZ = ToCell(bounds.maxZ);
+
+			for (int32_t z = minCellZ; z <= maxCellZ; ++z)
+			{
+				for (int32_t y = minCellY; y <= maxCellY; ++y)
+				{
+					for (int32_t x = minCellX; x <= maxCellX; ++x)
+					{
+						const uint32_t cell = FindCell(MakeCellKey(x, y, z));
+						if (cell != InvalidCell)
+						{
+							TestCell(cell, bounds, triggerIds);
+						}
+					}
+				}
+			}
+
+			// A trigger spanning several cells the box also spans is found once per cell
+			std::sort(triggerIds.begin(), triggerIds.end());
+			triggerIds.erase(std::unique(triggerIds.begin(), triggerIds.end()), triggerIds.end());
+		}
+
+	private:
+		struct SPlayerState
+		{
+			// Sorted ids of the triggers the player overlapped in the last update.
+			std::vector<uint32_t> overlaps;
+			uint64_t lastUpdate = 0;
+		};
+
+		static const uint32_t InvalidCell = 0xFFFFFFFF;
+		// Cell coordinates are packed into 21 bits each.
+		static const int32_t CellCoordinateLimit = (1 << 20) - 1;
+		// Triggers touching more cells than this go to the large trigger list, so a small cell size
+		// cannot blow the entries of a large preload box up into the hundred thousands.
+		static const uint64_t MaxCellsPerTrigger = 64;
+
+		// Index into the trigger arrays, or the trigger count if the id is unknown.
+		size_t FindTrigger(uint32_t triggerId) const
+		{
+			auto it = m_triggerIndices.find(triggerId);
+			return it != m_triggerIndices.end() ? it->second : m_triggerIds.size();
+		}
+
+		int32_t ToCell(float coordinate) const
+		{
+			const float cell = std::floor(coordinate * m_inverseCellSize);
+			return static_cast<int32_t>(std::max(std::min(cell, static_cast<float>(CellCoordinateLimit)), static_cast<float>(-CellCoordinateLimit)));
+		}
+
+		static uint64_t MakeCellKey(int32_t x, int32_t y, int32_t z)
+		{
+			const uint64_t mask = (1u << 21) - 1;
+			return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) | ((static_cast<uint64_t>(z) & mask) << 42);
+		}
+
+		static uint32_t HashCellKey(uint64_t key)
+		{
+			key ^= key >> 33;
+			key *= 0xFF51AFD7ED558CCDull;
+			key ^= key >> 33;
+			return static_cast<uint32_t>(key);
+		}
+
+		uint32_t FindCell(uint64_t key) const
+		{
+			for (uint32_t slot = HashCellKey(key) & m_hashMask;; slot = (slot + 1) & m_hashMask)
+			{
+				const uint32_t cell = m_hashSlots[slot];
+				if (cell == InvalidCell || m_cellKeys[cell] == key)
+					return cell;
+			}
+		}
+
+		// Appends the ids of the cell's triggers that overlap the box.
+		void TestCell(uint32_t cell, const SBounds& bounds, std::vector<uint32_t>& triggerIds) const
+		{
+			const uint32_t begin = m_cellStarts[cell];
+			const uint32_t end = m_cellStarts[cell + 1];
+
+#if TRIGGER_BROADPHASE_SSE
+			const __m128 boundsMinX = _mm_set1_ps(bounds.minX), boundsMaxX = _mm_set1_ps(bounds.maxX);
+			const __m128 boundsMinY = _mm_set1_ps(bounds.minY), boundsMaxY = _mm_set1_ps(bounds.maxY);
+			const __m128 boundsMinZ = _mm_set1_ps(bounds.minZ), boundsMaxZ = _mm_set1_ps(bounds.maxZ);
+
+			// The entry arrays are padded by three so the last group of four can always be loaded
+			for (uint32_t i = begin; i < end; i += 4)
+			{
+				__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&m_entryMinX[i]), boundsMaxX), _mm_cmpge_ps(_mm_loadu_ps(&m_entryMaxX[i]), boundsMinX));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&m_entryMinY[i]), boundsMaxY), _mm_cmpge_ps(_mm_loadu_ps(&m_entryMaxY[i]), boundsMinY)));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&m_entryMinZ[i]), boundsMaxZ), _mm_cmpge_ps(_mm_loadu_ps(&m_entryMaxZ[i]), boundsMinZ)));
+
+				// Drop the lanes past the end of the cell
+				const uint32_t validLanes = std::min(end - i, 4u);
+				int mask = _mm_movemask_ps(overlap) & ((1 << validLanes) - 1);
+				while (mask != 0)
+				{
+					const uint32_t lane = static_cast<uint32_t>(CountTrailingZeros(mask));
+					triggerIds.push_back(m_entryTriggerIds[i + lane]);
+					mask &= mask - 1;
+				}
+			}
+#else
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				if (m_entryMinX[i] <= bounds.maxX && m_entryMaxX[i] >= bounds.minX
+					&& m_entryMinY[i] <= bounds.maxY && m_entryMaxY[i] >= bounds.minY
+					&& m_entryMinZ[i] <= bounds.maxZ && m_entryMaxZ[i] >= bounds.minZ)
+				{
+					triggerIds.push_back(m_entryTriggerIds[i]);
+				}
+			}
+#endif
+		}
+
+		static int CountTrailingZeros(int mask)
+		{
+			// Only called with the four lane bits, a small loop is as fast as an intrinsic here
+			int count = 0;
+			while ((mask & 1) == 0)
+			{
+				mask >>= 1;
+				++count;
+			}
+			return count;
+		}
+
+		// Diffs two sorted id lists into enter and leave events.
+		static void EmitChanges(uint32_t playerId, const std::vector<uint32_t>& previous, const std::vector<uint32_t>& current, std::vector<SOverlapEvent>& events)
+		{
+			size_t p = 0, c = 0;
+			while (p < previous.size() || c < current.size())
+			{
+				if (c == current.size() || (p < previous.size() && previous[p] < current[c]))
+				{
+					events.push_back(SOverlapEvent { playerId, previous[p++], false });
+				}
+				else if (p == previous.size() || current[c] < previous[p])
+				{
+					events.push_back(SOverlapEvent { playerId, current[c++], true });
+				}
+				else
+				{
+					++p;
+					++c;
+				}
+			}
+		}
+
+		// Buckets every trigger into the cells it touches, called lazily after triggers changed.
+		void Rebuild()
+		{
+			struct SEntry
+			{
+				uint64_t cellKey;
+				uint32_t trigger;
+			};
+			std::vector<SEntry> entries;
+			entries.reserve(m_triggerIds.size());
+			m_largeTriggers.clear();
+
+			for (uint32_t trigger = 0; trigger < static_cast<uint32_t>(m_triggerIds.size()); ++trigger)
+			{
+				const SBounds& bounds = m_triggerBounds[trigger];
+				const uint64_t cellCount = static_cast<uint64_t>(ToCell(bounds.maxX) - ToCell(bounds.minX) + 1)
+					* static_cast<uint64_t>(ToCell(bounds.maxY) - ToCell(bounds.minY) + 1)
+					* static_cast<uint64_t>(ToCell(bounds.maxZ) - ToCell(bounds.minZ) + 1);
+				if (cellCount > MaxCellsPerTrigger)
+				{
+					m_largeTriggers.push_back(trigger);
+					continue;
+				}
+
+				for (int32_t z = ToCell(bounds.minZ); z <= ToCell(bounds.maxZ); ++z)
+					for (int32_t y = ToCell(bounds.minY); y <= ToCell(bounds.maxY); ++y)
+						for (int32_t x = ToCell(bounds.minX); x <= ToCell(bounds.maxX); ++x)
+							entries.push_back(SEntry { MakeCellKey(x, y, z), trigger });
+			}
+
+			std::sort(entries.begin(), entries.end(), [](const SEntry& a, const SEntry& b) { return a.cellKey < b.cellKey || (a.cellKey == b.cellKey && a.trigger < b.trigger); });
+
+			m_cellKeys.clear();
+			m_cellStarts.clear();
+			const size_t paddedSize = entries.size() + 3;
+			for (std::vector<float>* pArray : { &m_entryMinX, &m_entryMinY, &m_entryMinZ, &m_entryMaxX, &m_entryMaxY, &m_entryMaxZ })
+			{
+				pArray->assign(paddedSize, 0.f);
+			}
+			m_entryTriggerIds.assign(paddedSize, 0);
+
+			for (uint32_t i = 0; i < static_cast<uint32_t>(entries.size()); ++i)
+			{
+				if (m_cellKeys.empty() || m_cellKeys.back() != entries[i].cellKey)
+				{
+					m_cellKeys.push_back(entries[i].cellKey);
+					m_cellStarts.push_back(i);
+				}
+
+				const SBounds& bounds = m_triggerBounds[entries[i].trigger];
+				m_entryMinX[i] = bounds.minX;
+				m_entryMinY[i] = bounds.minY;
+				m_entryMinZ[i] = bounds.minZ;
+				m_entryMaxX[i] = bounds.maxX;
+				m_entryMaxY[i] = bounds.maxY;
+				m_entryMaxZ[i] = bounds.maxZ;
+				m_entryTriggerIds[i] = m_triggerIds[entries[i].trigger];
+			}
+			m_cellStarts.push_back(static_cast<uint32_t>(entries.size()));
+
+			// Open addressing table at most half full, so probe sequences stay short
+			uint32_t slotCount = 16;
+			while (slotCount < m_cellKeys.size() * 2)
+			{
+				slotCount *= 2;
+			}
+			m_hashMask = slotCount - 1;
+			m_hashSlots.assign(slotCount, InvalidCell);
+			for (uint32_t cell = 0; cell < static_cast<uint32_t>(m_cellKeys.size()); ++cell)
+			{
+				uint32_t slot = HashCellKey(m_cellKeys[cell]) & m_hashMask;
+				while (m_hashSlots[slot] != InvalidCell)
+				{
+					slot = (slot + 1) & m_hashMask;
+				}
+				m_hashSlots[slot] = cell;
+			}
+
+			m_isDirty = false;
+		}
+
+		float m_cellSize;
+		float m_inverseCellSize;
+		bool m_isDirty = true;
+
+		// Triggers as they were added, the cells below are rebuilt from these.
+		std::vector<uint32_t> m_triggerIds;
+		std::vector<SBounds> m_triggerBounds;
+		// Trigger id to its index in the arrays above.
+		std::unordered_map<uint32_t, uint32_t> m_triggerIndices;
+		// Indices of the triggers that are not stored in the cells.
+		std::vector<uint32_t> m_largeTriggers;
+
+		// Sorted cell keys, the entries of cell i are [m_cellStarts[i], m_cellStarts[i + 1]).
+		std::vector<uint64_t> m_cellKeys;
+		std::vector<uint32_t> m_cellStarts;
+		std::vector<uint32_t> m_hashSlots;
+		uint32_t m_hashMask = 0;
+
+		// One entry per trigger and cell it touches, stored per component for the four wide tests.
+		std::vector<float> m_entryMinX, m_entryMinY, m_entryMinZ;
+		std::vector<float> m_entryMaxX, m_entryMaxY, m_entryMaxZ;
+		std::vector<uint32_t> m_entryTriggerIds;
+
+		std::unordered_map<uint32_t, SPlayerState> m_players;
+		std::vector<uint32_t> m_overlaps;
+		uint64_t m_updateCount = 0;
+	};
+}
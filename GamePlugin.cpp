@@ -25,9 +25,76 @@ bool CGamePlugin::Initialize(SSystemGlobalEnvironment& env, const SSystemInitPar
 {
 	// Register for engine system events, in our case we need ESYSTEM_EVENT_GAME_POST_INIT to load the map
 	gEnv->pSystem->GetISystemEventDispatcher()->RegisterListener(this, "CGamePlugin");
+	m_gameplayProfiler.RegisterCVars();
+	m_gameplayMemory.RegisterCVars();
+	m_characterTemplateRegistry.RegisterCVars();
+	// Start reading the player character while the rest of the engine initializes
+	m_startupWarmup.RegisterCVars();
+	m_startupWarmup.Start();
+	m_engineWriteFilter.RegisterCVars();
+	m_assetCache.RegisterCVars();
+	m_projectilePool.RegisterCVars();
+	m_fireScheduler.RegisterCVars();
+	m_fireReplication.RegisterCVars();
+	m_hitscanSystem.RegisterCVars();
+	m_rayQueryService.RegisterCVars();
+	m_stressTest.RegisterCVars();
+	m_inputRecorder.RegisterCVars();
+	m_levelPreloader.RegisterCVars();
+	m_triggerSystem.RegisterCVars();
+	m_facingSystem.RegisterCVars();
+	m_snapshotSystem.RegisterCVars();
+	m_simulationClock.RegisterCVars();
+	m_playerUpdateSystem.RegisterCVars();
+	// Receive MainUpdate calls every frame to tick the plug-in level systems
+	EnableUpdate(EUpdateStep::MainUpdate, true);
 	return true;
 }
 
+void CGamePlugin::MainUpdate(float frameTime)
+{
+	m_startupWarmup.Update();
+	m_levelPreloader.Update();
+	m_stressTest.Update(frameTime);
+	m_rayQueryService.Update();
+	// Players and projectiles tick from the same clock, advanced with the frame time the players simulate,
+	// which is the recorded one while an input recording is replayed
+	if (IsGameplayPaused())
+	{
+		m_simulationClock.Pause();
+	}
+	else
+	{
+		m_simulationClock.Advance(m_inputRecorder.GetSimulationFrameTime(frameTime));
+	}
+	// The players face their cursors first, so that the cameras follow this frame's facing and not the last one
+	m_facingSystem.Update();
+	// Players move before the triggers test their new positions
+	m_playerUpdateSystem.Update(frameTime);
+	m_triggerSystem.Update();
+	m_fireScheduler.Update();
+	m_fireReplication.Update();
+	m_hitscanSystem.Update(frameTime);
+	// Projectiles age in simulation ticks
+	for (uint32 tick = 0; tick < m_simulationClock.GetTickCount(); ++tick)
+	{
+		m_projectileManager.Update(m_simulationClock.GetTickInterval());
+	}
+	m_inputRecorder.Update(frameTime);
+	m_snapshotSystem.Update(frameTime);
+	m_gameplayProfiler.EndFrame();
+}
+
+bool CGamePlugin::HasRemoteClients() const
+{
+	// Single player is a server as well, but nobody receives what it would send
+	return gEnv->bServer && gEnv->bMultiplayer && m_playerUpdateSystem.GetRemotePlayerCount() > 0;
+}
+
+bool CGamePlugin::IsGameplayPaused() const
+{
+	return gEnv->pGameFramework->IsGamePaused() || (gEnv->IsEditor() && !gEnv->IsEditorGameMode());
+}
 
 void CGamePlugin::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR lparam)
 {
@@ -54,15 +121,68 @@ void CGamePlugin::OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR lp
 					)
 			);
 		}
+		break;
 	}
 	case ESYSTEM_EVENT_GAME_POST_INIT:
 	{
+		// Load the warmed up character data before the map command spawns the first player
+		m_startupWarmup.Bind();
 		if (!gEnv->IsEditor())
 		{
 			gEnv->pConsole->ExecuteString("map example", false, true);
 		}
 		break;
 	}
+	case ESYSTEM_EVENT_LEVEL_LOAD_START:
+	{
+		m_levelPreloader.OnLevelLoadStart();
+		m_startupWarmup.OnLevelLoadStart();
+		break;
+	}
+	case ESYSTEM_EVENT_LEVEL_LOAD_END:
+	{
+		m_levelPreloader.OnLevelLoadEnd();
+		m_startupWarmup.OnLevelLoadEnd();
+		m_fireReplication.OnLevelLoadEnd();
+		m_snapshotSystem.OnLevelLoadEnd();
+		// Resolve the runtime spawned assets once per level, before the bullet pool needs them
+		m_assetCache.Resolve();
+		break;
+	}
+	case ESYSTEM_EVENT_LEVEL_LOAD_ERROR:
+	{
+		m_levelPreloader.OnLevelLoadError();
+		break;
+	}
+	case ESYSTEM_EVENT_LEVEL_GAMEPLAY_START:
+	{
+		// Spawn and physicalize the pooled bullets up front instead of on the first shots
+		m_projectilePool.Prewarm();
+		m_levelPreloader.OnGameplayStart();
+		m_startupWarmup.OnGameplayStart();
+		break;
+	}
+	case ESYSTEM_EVENT_LEVEL_UNLOAD:
+	{
+		// Pooled bullets are removed together with the rest of the level entities
+		m_levelPreloader.Reset();
+		m_triggerSystem.Reset();
+		m_facingSystem.Reset();
+		m_snapshotSystem.Reset();
+		m_simulationClock.Reset();
+		m_inputRecorder.Stop();
+		m_stressTest.Reset();
+		m_rayQueryService.Reset();
+		m_fireScheduler.Reset();
+		m_fireReplication.Reset();
+		m_hitscanSystem.Reset();
+		m_projectileManager.Reset();
+		m_projectilePool.Reset();
+		m_assetCache.Release();
+		// Last, once no system refers to its level storage anymore
+		m_gameplayMemory.OnLevelUnload();
+		break;
+	}
 	}
 }
 // Register the factory that can create this plug-in instance
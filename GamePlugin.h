@@ -2,6 +2,26 @@
 #include <CrySystem/ICryPlugin.h>
 #include <CryGame/IGameFramework.h>
 #include <CryEntitySystem/IEntityClass.h>
+#include "Systems/AssetCache.h"
+#include "Systems/CharacterTemplateRegistry.h"
+#include "Systems/EngineWriteFilter.h"
+#include "Systems/FacingSystem.h"
+#include "Systems/GameplayMemory.h"
+#include "Systems/FireReplication.h"
+#include "Systems/FireScheduler.h"
+#include "Systems/GameplayProfiler.h"
+#include "Systems/HitscanSystem.h"
+#include "Systems/InputRecorder.h"
+#include "Systems/LevelPreloader.h"
+#include "Systems/PlayerUpdateSystem.h"
+#include "Systems/ProjectilePool.h"
+#include "Systems/RayQueryService.h"
+#include "Systems/SimulationClock.h"
+#include "Systems/SnapshotSystem.h"
+#include "Systems/StartupWarmup.h"
+#include "Systems/ProjectileManager.h"
+#include "Systems/StressTest.h"
+#include "Systems/TriggerSystem.h"
 // The entry-point of the application
 // An instance of CGamePlugin is automatically created when the library is loaded
 // IEnginePlugin:  On startup, the engine parses the Game.cryproject file in your project directory, which in turn contains a path to our game plug-in DLL. 
@@ -22,6 +42,78 @@ public:
 		// Called shortly after loading the plug-in from disk
 		// This is usually where you would initialize any third-party APIs and custom code
 		virtual bool Initialize(SSystemGlobalEnvironment& env, const SSystemInitParams& initParams) override;
+		// Called every frame once EnableUpdate has been called for the MainUpdate step
+		virtual void MainUpdate(float frameTime) override;
 		// ISystemEventListener
 		virtual void OnSystemEvent(ESystemEvent event, UINT_PTR wparam, UINT_PTR lparam) override;
+
+		// Helper function to get the CGamePlugin instance
+		// Note that CGamePlugin is declared as a singleton, so the CreateClassInstance will always return the same pointer
+		static CGamePlugin* GetInstance()
+		{
+			return cryinterface_cast<CGamePlugin>(CGamePlugin::s_factory.CreateClassInstance().get());
+		}
+
+		// Pools and the level arena for memory the plug-in owns.
+		CGameplayMemory& GetGameplayMemory() { return m_gameplayMemory; }
+		// Character data loaded once and shared by every player of the same character.
+		CCharacterTemplateRegistry& GetCharacterTemplateRegistry() { return m_characterTemplateRegistry; }
+		// Loads the player character ahead of the first spawn and times the startup.
+		CStartupWarmup& GetStartupWarmup() { return m_startupWarmup; }
+		// Shared geometry and material handles for runtime spawned entities.
+		CAssetCache& GetAssetCache() { return m_assetCache; }
+		// Recycles bullet entities so that firing does not spawn and remove entities.
+		CProjectilePool& GetProjectilePool() { return m_projectilePool; }
+		// Ages and expires every projectile in flight in one batch per frame.
+		CProjectileManager& GetProjectileManager() { return m_projectileManager; }
+		// Applies the weapon fire rates and spreads projectile spawns over frames within a budget.
+		CFireScheduler& GetFireScheduler() { return m_fireScheduler; }
+		CFireReplication& GetFireReplication() { return m_fireReplication; }
+		// Resolves the shots of weapons in hitscan fire mode in one batch per frame.
+		CHitscanSystem& GetHitscanSystem() { return m_hitscanSystem; }
+		// Deferred ray queries with results delivered the next frame.
+		CRayQueryService& GetRayQueryService() { return m_rayQueryService; }
+		// Spawns load and records scaling numbers from the console.
+		CStressTest& GetStressTest() { return m_stressTest; }
+		// Records player input to a file and replays it in place of live input.
+		CInputRecorder& GetInputRecorder() { return m_inputRecorder; }
+		// Streams the next level in the background so that level change triggers do not stall the game.
+		CLevelPreloader& GetLevelPreloader() { return m_levelPreloader; }
+		// Tests every trigger volume against the players in one batch per frame.
+		CTriggerSystem& GetTriggerSystem() { return m_triggerSystem; }
+		// Turns every character towards its target in one batch per frame.
+		CFacingSystem& GetFacingSystem() { return m_facingSystem; }
+		CSnapshotSystem& GetSnapshotSystem() { return m_snapshotSystem; }
+		CSimulationClock& GetSimulationClock() { return m_simulationClock; }
+		// Computes the player updates in parallel on the job system.
+		CPlayerUpdateSystem& GetPlayerUpdateSystem() { return m_playerUpdateSystem; }
+
+		// True on a multiplayer server that has players of other clients, replication is skipped without them.
+		bool HasRemoteClients() const;
+		// True while the game is paused and in the editor outside game mode, when entity updates stop and gameplay does too.
+		bool IsGameplayPaused() const;
+
+protected:
+		// Constructed first so that every other system can report to it.
+		CGameplayProfiler m_gameplayProfiler;
+		// Outlives every system whose containers allocate from it.
+		CGameplayMemory m_gameplayMemory;
+		CCharacterTemplateRegistry m_characterTemplateRegistry;
+		CStartupWarmup m_startupWarmup;
+		CEngineWriteFilter m_engineWriteFilter;
+		CAssetCache m_assetCache;
+		CProjectilePool m_projectilePool;
+		CProjectileManager m_projectileManager{ m_projectilePool };
+		CFireScheduler m_fireScheduler;
+		CFireReplication m_fireReplication;
+		CHitscanSystem m_hitscanSystem;
+		CRayQueryService m_rayQueryService;
+		CStressTest m_stressTest;
+		CInputRecorder m_inputRecorder;
+		CLevelPreloader m_levelPreloader;
+		CTriggerSystem m_triggerSystem;
+		CFacingSystem m_facingSystem;
+		CSnapshotSystem m_snapshotSystem;
+		CSimulationClock m_simulationClock;
+		CPlayerUpdateSystem m_playerUpdateSystem;
 };
\ No newline at end of file
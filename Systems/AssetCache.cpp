@@ -0,0 +1,136 @@
+#include "StdAfx.h"
+#include "AssetCache.h"
+#include "GamePlugin.h"
+
+namespace
+{
+	void LogAssetCacheStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CAssetCache& assetCache = CGamePlugin::GetInstance()->GetAssetCache();
+		assetCache.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			assetCache.ResetStatistics();
+		}
+	}
+}
+
+CAssetCache::~CAssetCache()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->RemoveCommand("g_assetCacheStats");
+	}
+}
+
+void CAssetCache::RegisterCVars()
+{
+	REGISTER_COMMAND("g_assetCacheStats", LogAssetCacheStatsCommand, VF_NULL, "Prints asset cache hits and misses. Pass 'reset' to clear the counters afterwards");
+}
+
+const char* CAssetCache::GetGeometryPath(EGeometryAsset asset)
+{
+	switch (asset)
+	{
+	case EGeometryAsset::Sphere: return "%ENGINE%/EngineAssets/Objects/primitive_sphere.cgf";
+	}
+	return nullptr;
+}
+
+const char* CAssetCache::GetMaterialPath(EMaterialAsset asset)
+{
+	switch (asset)
+	{
+	// This material has the 'mat_bullet' surface type applied, which is set up to play sounds on collision with 'mat_default' objects in Libs/MaterialEffects
+	case EMaterialAsset::Bullet: return "Materials/bullet";
+	case EMaterialAsset::Cursor: return "Materials/cursor";
+	}
+	return nullptr;
+}
+
+void CAssetCache::Resolve()
+{
+	for (size_t i = 0; i < m_geometry.size(); ++i)
+	{
+		if (!m_geometry[i])
+		{
+			LoadGeometry(static_cast<EGeometryAsset>(i));
+		}
+	}
+
+	for (size_t i = 0; i < m_materials.size(); ++i)
+	{
+		if (!m_materials[i])
+		{
+			LoadMaterial(static_cast<EMaterialAsset>(i));
+		}
+	}
+}
+
+void CAssetCache::Release()
+{
+	for (_smart_ptr<IStatObj>& pGeometry : m_geometry)
+	{
+		pGeometry.reset();
+	}
+
+	for (_smart_ptr<IMaterial>& pMaterial : m_materials)
+	{
+		pMaterial.reset();
+	}
+}
+
+IStatObj* CAssetCache::GetGeometry(EGeometryAsset asset)
+{
+	if (IStatObj* pGeometry = m_geometry[static_cast<size_t>(asset)])
+	{
+		++m_statistics.hits;
+		return pGeometry;
+	}
+
+	++m_statistics.misses;
+	return LoadGeometry(asset);
+}
+
+IMaterial* CAssetCache::GetMaterial(EMaterialAsset asset)
+{
+	if (IMaterial* pMaterial = m_materials[static_cast<size_t>(asset)])
+	{
+		++m_statistics.hits;
+		return pMaterial;
+	}
+
+	++m_statistics.misses;
+	return LoadMaterial(asset);
+}
+
+void CAssetCache::LogStatistics() const
+{
+	uint32 resolvedCount = 0;
+	for (const _smart_ptr<IStatObj>& pGeometry : m_geometry)
+	{
+		resolvedCount += pGeometry ? 1 : 0;
+	}
+	for (const _smart_ptr<IMaterial>& pMaterial : m_materials)
+	{
+		resolvedCount += pMaterial ? 1 : 0;
+	}
+
+	CryLogAlways("[AssetCache] resolved %u/%u, hits %u, misses %u", resolvedCount,
+		static_cast<uint32>(m_geometry.size() + m_materials.size()), m_statistics.hits, m_statistics.misses);
+}
+
+IStatObj* CAssetCache::LoadGeometry(EGeometryAsset asset)
+{
+	_smart_ptr<IStatObj>& pGeometry = m_geometry[static_cast<size_t>(asset)];
+	pGeometry = gEnv->p3DEngine->LoadStatObj(GetGeometryPath(asset));
+	return pGeometry;
+}
+
+IMaterial* CAssetCache::LoadMaterial(EMaterialAsset asset)
+{
+	_smart_ptr<IMaterial>& pMaterial = m_materials[static_cast<size_t>(asset)];
+	pMaterial = gEnv->p3DEngine->GetMaterialManager()->LoadMaterial(GetMaterialPath(asset));
+	return pMaterial;
+}
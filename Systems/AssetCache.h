@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Cry3DEngine/IStatObj.h>
+#include <Cry3DEngine/IMaterial.h>
+#include <array>
+
+// Geometry that is bound to entities spawned at runtime.
+enum class EGeometryAsset : uint8
+{
+	Sphere = 0,
+	Count
+};
+
+// Materials that are bound to entities spawned at runtime.
+enum class EMaterialAsset : uint8
+{
+	Bullet = 0,
+	Cursor,
+	Count
+};
+
+////////////////////////////////////////////////////////
+// Resolves the geometry and materials used by runtime spawned entities once per level.
+// Holds reference counted handles that entities bind directly, keeping path lookups off the firing path.
+////////////////////////////////////////////////////////
+class CAssetCache
+{
+public:
+	struct SStatistics
+	{
+		// Requests served from an already resolved handle.
+		uint32 hits = 0;
+		// Requests that had to load the asset by path.
+		uint32 misses = 0;
+	};
+
+	CAssetCache() = default;
+	~CAssetCache();
+
+	// Registers the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+	// Loads every known asset, called on level load so that the first spawns do not pay for it.
+	void Resolve();
+	// Drops the cached handles, called on level unload so that the assets can be freed with the level.
+	void Release();
+
+	IStatObj* GetGeometry(EGeometryAsset asset);
+	IMaterial* GetMaterial(EMaterialAsset asset);
+
+	// Files behind the assets, the material path is without the .mtl extension.
+	static const char* GetGeometryPath(EGeometryAsset asset);
+	static const char* GetMaterialPath(EMaterialAsset asset);
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	IStatObj* LoadGeometry(EGeometryAsset asset);
+	IMaterial* LoadMaterial(EMaterialAsset asset);
+
+	std::array<_smart_ptr<IStatObj>, static_cast<size_t>(EGeometryAsset::Count)> m_geometry;
+	std::array<_smart_ptr<IMaterial>, static_cast<size_t>(EMaterialAsset::Count)> m_materials;
+	SStatistics m_statistics;
+};
@@ -0,0 +1,180 @@
+#include "StdAfx.h"
+#include "CharacterTemplateRegistry.h"
+#include "GamePlugin.h"
+#include <CryGame/IGameFramework.h>
+
+namespace
+{
+	const char* GetCharacterTagName(ECharacterTag tag)
+	{
+		switch (tag)
+		{
+		case ECharacterTag::Walk: return "Walk";
+		}
+		return nullptr;
+	}
+
+	// Memory committed by the process, the closest the engine reports to what a load actually costs.
+	int64 GetProcessMemoryBytes()
+	{
+		IMemoryManager::SProcessMemInfo memoryInfo;
+		if (!CryGetIMemoryManager()->GetProcessMemInfo(memoryInfo))
+			return 0;
+		return static_cast<int64>(memoryInfo.PagefileUsage);
+	}
+
+	void LogCharacterTemplateStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CCharacterTemplateRegistry& registry = CGamePlugin::GetInstance()->GetCharacterTemplateRegistry();
+		registry.LogStatistics();
+		// Passing "reset" clears the instance measurements after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			registry.ResetStatistics();
+		}
+	}
+}
+
+CCharacterTemplateRegistry::~CCharacterTemplateRegistry()
+{
+	if (gEnv && gEnv->pCharacterManager)
+	{
+		for (const std::unique_ptr<SCharacterTemplate>& pTemplate : m_templates)
+		{
+			if (pTemplate->isLoaded)
+			{
+				gEnv->pCharacterManager->StreamKeepCharacterResourcesResident(pTemplate->character.c_str(), 0, false);
+			}
+		}
+	}
+
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->RemoveCommand("g_characterTemplateStats");
+	}
+}
+
+void CCharacterTemplateRegistry::RegisterCVars()
+{
+	REGISTER_COMMAND("g_characterTemplateStats", LogCharacterTemplateStatsCommand, VF_NULL, "Prints the shared and per player time and memory of every character template. Pass 'reset' to clear the instance measurements afterwards");
+}
+
+const SCharacterTemplate* CCharacterTemplateRegistry::Acquire(const SCharacterFiles& files)
+{
+	for (const std::unique_ptr<SCharacterTemplate>& pTemplate : m_templates)
+	{
+		if (pTemplate->character.compareNoCase(files.szCharacter) == 0
+			&& pTemplate->animationDatabase.compareNoCase(files.szAnimationDatabase) == 0
+			&& pTemplate->controllerDefinition.compareNoCase(files.szControllerDefinition) == 0)
+		{
+			return pTemplate->isLoaded ? pTemplate.get() : nullptr;
+		}
+	}
+
+	// Loaded once, a template that failed to load is kept so that it is not tried again for every spawn
+	m_templates.emplace_back(new SCharacterTemplate());
+	SCharacterTemplate& characterTemplate = *m_templates.back();
+	characterTemplate.character = files.szCharacter;
+	characterTemplate.animationDatabase = files.szAnimationDatabase;
+	characterTemplate.controllerDefinition = files.szControllerDefinition;
+
+	const CTimeValue loadStartTime = gEnv->pTimer->GetAsyncTime();
+	const int64 loadStartBytes = GetProcessMemoryBytes();
+
+	// Streamed in right away and kept resident by the character manager itself, no instance has to be held for it
+	const bool hasCharacter = gEnv->pCryPak->IsFileExist(files.szCharacter);
+	if (hasCharacter)
+	{
+		gEnv->pCharacterManager->StreamKeepCharacterResourcesResident(files.szCharacter, 0, true, true);
+	}
+	IAnimationDatabaseManager& databaseManager = gEnv->pGameFramework->GetMannequinInterface().GetAnimationDatabaseManager();
+	characterTemplate.pAnimationDatabase = databaseManager.Load(files.szAnimationDatabase);
+	characterTemplate.pControllerDefinition = databaseManager.LoadControllerDef(files.szControllerDefinition);
+	if (!hasCharacter || characterTemplate.pAnimationDatabase == nullptr || characterTemplate.pControllerDefinition == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "[CharacterTemplates] Could not load %s with %s and %s", files.szCharacter, files.szAnimationDatabase, files.szControllerDefinition);
+		if (hasCharacter)
+		{
+			gEnv->pCharacterManager->StreamKeepCharacterResourcesResident(files.szCharacter, 0, false);
+		}
+		return nullptr;
+	}
+	characterTemplate.isLoaded = true;
+
+	for (size_t i = 0; i < characterTemplate.tagIds.size(); ++i)
+	{
+		characterTemplate.tagIds[i] = characterTemplate.pControllerDefinition->m_tags.Find(GetCharacterTagName(static_cast<ECharacterTag>(i)));
+	}
+
+	characterTemplate.statistics.loadMilliseconds = (gEnv->pTimer->GetAsyncTime() - loadStartTime).GetMilliSeconds();
+	characterTemplate.statistics.loadBytes = GetProcessMemoryBytes() - loadStartBytes;
+	CryLogAlways("[CharacterTemplates] Loaded %s in %.1f ms, %.1f MB", files.szCharacter, characterTemplate.statistics.loadMilliseconds,
+		characterTemplate.statistics.loadBytes / (1024.f * 1024.f));
+	return &characterTemplate;
+}
+
+CCharacterTemplateRegistry::SInstanceMeasurement CCharacterTemplateRegistry::BeginInstance() const
+{
+	SInstanceMeasurement measurement;
+	measurement.startTime = gEnv->pTimer->GetAsyncTime();
+	measurement.startBytes = GetProcessMemoryBytes();
+	return measurement;
+}
+
+void CCharacterTemplateRegistry::EndInstance(const SCharacterTemplate& characterTemplate, const SInstanceMeasurement& measurement)
+{
+	if (SCharacterTemplate* pTemplate = Find(characterTemplate))
+	{
+		SCharacterTemplate::SStatistics& statistics = pTemplate->statistics;
+		++statistics.liveInstances;
+		++statistics.measuredInstances;
+		statistics.instanceMilliseconds += (gEnv->pTimer->GetAsyncTime() - measurement.startTime).GetMilliSeconds();
+		statistics.instanceBytes += GetProcessMemoryBytes() - measurement.startBytes;
+	}
+}
+
+void CCharacterTemplateRegistry::ReleaseInstance(const SCharacterTemplate& characterTemplate)
+{
+	if (SCharacterTemplate* pTemplate = Find(characterTemplate))
+	{
+		if (pTemplate->statistics.liveInstances > 0)
+		{
+			--pTemplate->statistics.liveInstances;
+		}
+	}
+}
+
+void CCharacterTemplateRegistry::ResetStatistics()
+{
+	for (const std::unique_ptr<SCharacterTemplate>& pTemplate : m_templates)
+	{
+		pTemplate->statistics.measuredInstances = 0;
+		pTemplate->statistics.instanceMilliseconds = 0.f;
+		pTemplate->statistics.instanceBytes = 0;
+	}
+}
+
+void CCharacterTemplateRegistry::LogStatistics() const
+{
+	CryLogAlways("[CharacterTemplates] %u templates", static_cast<uint32>(m_templates.size()));
+	for (const std::unique_ptr<SCharacterTemplate>& pTemplate : m_templates)
+	{
+		const SCharacterTemplate::SStatistics& statistics = pTemplate->statistics;
+		const float instances = static_cast<float>(max(statistics.measuredInstances, 1u));
+		const float instanceKB = statistics.instanceBytes / 1024.f / instances;
+		const float loadKB = statistics.loadBytes / 1024.f;
+		CryLogAlways("[CharacterTemplates] %s%s", pTemplate->character.c_str(), pTemplate->isLoaded ? "" : " (failed to load)");
+		CryLogAlways("[CharacterTemplates]   shared: %.1f ms, %.1f KB, %u players alive", statistics.loadMilliseconds, loadKB, statistics.liveInstances);
+		CryLogAlways("[CharacterTemplates]   per player: %.2f ms, %.1f KB over %u spawns", statistics.instanceMilliseconds / instances, instanceKB, statistics.measuredInstances);
+	}
+}
+
+SCharacterTemplate* CCharacterTemplateRegistry::Find(const SCharacterTemplate& characterTemplate)
+{
+	for (const std::unique_ptr<SCharacterTemplate>& pTemplate : m_templates)
+	{
+		if (pTemplate.get() == &characterTemplate)
+			return pTemplate.get();
+	}
+	return nullptr;
+}
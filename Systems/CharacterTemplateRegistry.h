@@ -0,0 +1,95 @@
+#pragma once
+
+#include <CryAnimation/ICryAnimation.h>
+#include <ICryMannequin.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+// Character, animation database and controller definition a player is set up from.
+struct SCharacterFiles
+{
+	const char* szCharacter;
+	const char* szAnimationDatabase;
+	const char* szControllerDefinition;
+};
+
+// Mannequin tags every character instance uses, resolved once per template.
+enum class ECharacterTag : uint8
+{
+	Walk = 0,
+	Count
+};
+
+// Data shared by every character set up from the same files.
+struct SCharacterTemplate
+{
+	struct SStatistics
+	{
+		// Time and process memory it took to load the shared data.
+		float loadMilliseconds = 0.f;
+		int64 loadBytes = 0;
+		uint32 liveInstances = 0;
+		// Instances measured since the last reset, with the time and process memory they took on top of the template.
+		uint32 measuredInstances = 0;
+		float instanceMilliseconds = 0.f;
+		int64 instanceBytes = 0;
+	};
+
+	string character;
+	string animationDatabase;
+	string controllerDefinition;
+
+	// Set once the shared data loaded. The character manager keeps the model, skeleton and skins resident for the
+	// template while no instance is alive, instances share them.
+	bool isLoaded = false;
+	const IAnimationDatabase* pAnimationDatabase = nullptr;
+	const SControllerDef* pControllerDefinition = nullptr;
+	std::array<TagID, static_cast<size_t>(ECharacterTag::Count)> tagIds;
+
+	SStatistics statistics;
+
+	TagID GetTagId(ECharacterTag tag) const { return tagIds[static_cast<size_t>(tag)]; }
+};
+
+////////////////////////////////////////////////////////
+// Loads each character, animation database and controller definition triple once and keeps it resident for the session.
+// Instances are still set up from the file names, the animation component has no way to take the loaded data, but
+// their loads are served from the character manager and Mannequin caches instead of the files, also after every
+// player of the character despawned. Tags are resolved once per template instead of by name per player.
+// The time and process memory of each template and of the instances set up after it are recorded,
+// g_characterTemplateStats prints the cost per player.
+////////////////////////////////////////////////////////
+class CCharacterTemplateRegistry
+{
+public:
+	// Taken before an instance is set up, and passed back once it is.
+	struct SInstanceMeasurement
+	{
+		CTimeValue startTime;
+		int64 startBytes = 0;
+	};
+
+	CCharacterTemplateRegistry() = default;
+	~CCharacterTemplateRegistry();
+
+	// Registers the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Returns the template for the files, loading it on first use. Returns nullptr if the files could not be loaded.
+	const SCharacterTemplate* Acquire(const SCharacterFiles& files);
+
+	// Instance bookkeeping, called by the components that set up characters from a template.
+	SInstanceMeasurement BeginInstance() const;
+	void EndInstance(const SCharacterTemplate& characterTemplate, const SInstanceMeasurement& measurement);
+	void ReleaseInstance(const SCharacterTemplate& characterTemplate);
+
+	void ResetStatistics();
+	void LogStatistics() const;
+
+private:
+	SCharacterTemplate* Find(const SCharacterTemplate& characterTemplate);
+
+	// Templates are never removed, instances refer to them for their whole life.
+	std::vector<std::unique_ptr<SCharacterTemplate>> m_templates;
+};
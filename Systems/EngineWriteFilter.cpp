@@ -0,0 +1,154 @@
+#include "StdAfx.h"
+#include "EngineWriteFilter.h"
+
+CEngineWriteFilter* CEngineWriteFilter::s_pInstance = nullptr;
+
+namespace
+{
+	const char* GetEngineWriteName(EEngineWrite write)
+	{
+		switch (write)
+		{
+		case EEngineWrite::AnimationTag: return "SetTagWithId";
+		case EEngineWrite::EntityRotation: return "SetRotation";
+		case EEngineWrite::Velocity: return "AddVelocity";
+		case EEngineWrite::CameraTransform: return "SetTransformMatrix";
+		case EEngineWrite::ListenerOffset: return "SetOffset";
+		}
+		return "Unknown";
+	}
+
+	void LogEngineWriteStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CEngineWriteFilter* pFilter = CEngineWriteFilter::Get();
+		pFilter->LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			pFilter->ResetStatistics();
+		}
+	}
+}
+
+CEngineWriteFilter::CEngineWriteFilter()
+{
+	s_pInstance = this;
+}
+
+CEngineWriteFilter::~CEngineWriteFilter()
+{
+	s_pInstance = nullptr;
+
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_engineWriteFilter", true);
+		gEnv->pConsole->UnregisterVariable("g_engineWriteEpsilon", true);
+		gEnv->pConsole->RemoveCommand("g_engineWriteStats");
+	}
+}
+
+void CEngineWriteFilter::RegisterCVars()
+{
+	REGISTER_CVAR2("g_engineWriteFilter", &m_isEnabled, m_isEnabled, VF_NULL, "Skips engine writes from gameplay that would not change anything\n0: Push every write\n1: Skip unchanged writes");
+	REGISTER_CVAR2("g_engineWriteEpsilon", &m_epsilon, m_epsilon, VF_NULL, "Largest per component difference from the last pushed value that still counts as unchanged");
+	REGISTER_COMMAND("g_engineWriteStats", LogEngineWriteStatsCommand, VF_NULL, "Prints pushed and suppressed engine writes per call. Pass 'reset' to clear the counters afterwards");
+}
+
+void CEngineWriteFilter::LogStatistics() const
+{
+	for (size_t i = 0; i < m_statistics.size(); ++i)
+	{
+		const SStatistics& statistics = m_statistics[i];
+		const uint32 total = statistics.pushed + statistics.suppressed;
+		CryLogAlways("[EngineWrites] %-20s pushed %8u, suppressed %8u (%.1f%%)", GetEngineWriteName(static_cast<EEngineWrite>(i)),
+			statistics.pushed, statistics.suppressed, total > 0 ? 100.f * statistics.suppressed / total : 0.f);
+	}
+}
+
+void CEngineStateCache::SetTag(Cry::DefaultComponents::CAdvancedAnimationComponent& animation, TagID tagId, bool isSet)
+{
+	STagState* pState = nullptr;
+	for (STagState& state : m_tags)
+	{
+		if (state.tagId == tagId || state.tagId == TAG_ID_INVALID)
+		{
+			pState = &state;
+			break;
+		}
+	}
+
+	// Tags that do not fit are pushed every time
+	const bool isKnown = pState != nullptr && pState->tagId == tagId;
+	if (!Filter(EEngineWrite::AnimationTag, !isKnown || pState->isSet != isSet))
+		return;
+
+	if (pState != nullptr)
+	{
+		pState->tagId = tagId;
+		pState->isSet = isSet;
+	}
+	animation.SetTagWithId(tagId, isSet);
+}
+
+void CEngineStateCache::AddVelocity(Cry::DefaultComponents::CCharacterControllerComponent& characterController, const Vec3& velocity)
+{
+	// Velocity is added on top of the current one, so only a zero velocity is a no-op
+	const float epsilon = CEngineWriteFilter::Get()->GetEpsilon();
+	if (!Filter(EEngineWrite::Velocity, !velocity.IsZero(epsilon)))
+		return;
+
+	characterController.AddVelocity(velocity);
+}
+
+void CEngineStateCache::SetCameraTransform(Cry::DefaultComponents::CCameraComponent& camera, const Matrix34& transform)
+{
+	const float epsilon = CEngineWriteFilter::Get()->GetEpsilon();
+	if (!Filter(EEngineWrite::CameraTransform, !m_hasCameraTransform || !Matrix34::IsEquivalent(m_cameraTransform, transform, epsilon)))
+		return;
+
+	m_hasCameraTransform = true;
+	m_cameraTransform = transform;
+	camera.SetTransformMatrix(transform);
+}
+
+void CEngineStateCache::SetListenerOffset(Cry::Audio::DefaultComponents::CListenerComponent& listener, const Vec3& offset)
+{
+	const float epsilon = CEngineWriteFilter::Get()->GetEpsilon();
+	if (!Filter(EEngineWrite::ListenerOffset, !m_hasListenerOffset || !m_listenerOffset.IsEquivalent(offset, epsilon)))
+		return;
+
+	m_hasListenerOffset = true;
+	m_listenerOffset = offset;
+	listener.SetOffset(offset);
+}
+
+void CEngineStateCache::Invalidate()
+{
+	m_tags = {};
+	m_hasCameraTransform = false;
+	m_hasListenerOffset = false;
+}
+
+bool CEngineStateCache::ShouldPushRotation(float& lastW, float& lastZ, float w, float z)
+{
+	const float epsilon = CEngineWriteFilter::Get()->GetEpsilon();
+	if (!Filter(EEngineWrite::EntityRotation, fabsf(lastW - w) > epsilon || fabsf(lastZ - z) > epsilon))
+		return false;
+
+	lastW = w;
+	lastZ = z;
+	return true;
+}
+
+bool CEngineStateCache::Filter(EEngineWrite write, bool isChanged)
+{
+	CEngineWriteFilter* pFilter = CEngineWriteFilter::Get();
+	if (isChanged || !pFilter->IsEnabled())
+	{
+		pFilter->CountPushed(write);
+		return true;
+	}
+
+	pFilter->CountSuppressed(write);
+	return false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <DefaultComponents/Cameras/CameraComponent.h>
+#include <DefaultComponents/Physics/CharacterControllerComponent.h>
+#include <DefaultComponents/Geometry/AdvancedAnimationComponent.h>
+#include <DefaultComponents/Audio/ListenerComponent.h>
+#include <array>
+
+// Engine calls gameplay makes every frame that are worth skipping when nothing changed.
+enum class EEngineWrite : uint8
+{
+	AnimationTag = 0,
+	EntityRotation,
+	Velocity,
+	CameraTransform,
+	ListenerOffset,
+	Count
+};
+
+////////////////////////////////////////////////////////
+// Settings and counters of the engine write filtering.
+// Each engine call goes through a CEngineStateCache owned by the caller, which compares against the last value
+// it pushed and only forwards writes that change something. This class holds the epsilon they compare with and
+// counts the forwarded and suppressed writes per call.
+////////////////////////////////////////////////////////
+class CEngineWriteFilter
+{
+public:
+	struct SStatistics
+	{
+		uint32 pushed = 0;
+		uint32 suppressed = 0;
+	};
+
+	CEngineWriteFilter();
+	~CEngineWriteFilter();
+
+	// Registers the epsilon and enable CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	bool IsEnabled() const { return m_isEnabled != 0; }
+	// Largest difference per component that still counts as unchanged, in meters for positions and offsets.
+	float GetEpsilon() const { return m_epsilon; }
+
+	void CountPushed(EEngineWrite write) { ++m_statistics[static_cast<size_t>(write)].pushed; }
+	void CountSuppressed(EEngineWrite write) { ++m_statistics[static_cast<size_t>(write)].suppressed; }
+
+	void ResetStatistics() { m_statistics = {}; }
+	void LogStatistics() const;
+
+	static CEngineWriteFilter* Get() { return s_pInstance; }
+
+private:
+	static CEngineWriteFilter* s_pInstance;
+
+	std::array<SStatistics, static_cast<size_t>(EEngineWrite::Count)> m_statistics = {};
+	int m_isEnabled = 1;
+	float m_epsilon = 0.0001f;
+};
+
+////////////////////////////////////////////////////////
+// Last values one owner pushed to the engine.
+// Wraps the engine calls and drops the ones that would not change anything, see CEngineWriteFilter.
+////////////////////////////////////////////////////////
+class CEngineStateCache
+{
+public:
+	void SetTag(Cry::DefaultComponents::CAdvancedAnimationComponent& animation, TagID tagId, bool isSet);
+	void AddVelocity(Cry::DefaultComponents::CCharacterControllerComponent& characterController, const Vec3& velocity);
+	void SetCameraTransform(Cry::DefaultComponents::CCameraComponent& camera, const Matrix34& transform);
+	void SetListenerOffset(Cry::Audio::DefaultComponents::CListenerComponent& listener, const Vec3& offset);
+
+	// Forgets the pushed values so that the next writes go through, for example after the engine side was reset.
+	void Invalidate();
+
+	// Compares and records an entity rotation about Z given as the W and Z of a quaternion.
+	// Used by batched callers that read the current values themselves, returns true if the rotation has to be pushed.
+	static bool ShouldPushRotation(float& lastW, float& lastZ, float w, float z);
+
+private:
+	// Records the outcome in the statistics and returns isChanged, or true if filtering is disabled.
+	static bool Filter(EEngineWrite write, bool isChanged);
+
+	// Mannequin tags are few per character, so a small linear list is enough.
+	static constexpr size_t MaxCachedTags = 4;
+	struct STagState
+	{
+		TagID tagId = TAG_ID_INVALID;
+		bool isSet = false;
+	};
+	std::array<STagState, MaxCachedTags> m_tags;
+
+	bool m_hasCameraTransform = false;
+	Matrix34 m_cameraTransform = Matrix34(IDENTITY);
+	bool m_hasListenerOffset = false;
+	Vec3 m_listenerOffset = ZERO;
+};
@@ -0,0 +1,105 @@
+#include "StdAfx.h"
+#include "FacingSystem.h"
+#include "GamePlugin.h"
+#include "GameplayProfiler.h"
+#include "EngineWriteFilter.h"
+#include "Core/PlayerKernels.h"
+#include <algorithm>
+
+namespace
+{
+	void LogFacingStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CryLogAlways("[FacingSystem] characters %u", CGamePlugin::GetInstance()->GetFacingSystem().GetCharacterCount());
+	}
+}
+
+CFacingSystem::~CFacingSystem()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->RemoveCommand("g_facingStats");
+	}
+}
+
+void CFacingSystem::RegisterCVars()
+{
+	REGISTER_COMMAND("g_facingStats", LogFacingStatsCommand, VF_NULL, "Prints the number of characters turned by the facing system");
+}
+
+void CFacingSystem::SetFacingTarget(EntityId characterId, EntityId targetId)
+{
+	auto it = std::find(m_characterIds.begin(), m_characterIds.end(), characterId);
+	if (it != m_characterIds.end())
+	{
+		m_targetIds[it - m_characterIds.begin()] = targetId;
+		return;
+	}
+
+	m_characterIds.push_back(characterId);
+	m_targetIds.push_back(targetId);
+}
+
+void CFacingSystem::RemoveCharacter(EntityId characterId)
+{
+	auto it = std::find(m_characterIds.begin(), m_characterIds.end(), characterId);
+	if (it == m_characterIds.end())
+		return;
+
+	// Swap with the last character, the order does not matter
+	const size_t index = it - m_characterIds.begin();
+	m_characterIds[index] = m_characterIds.back();
+	m_targetIds[index] = m_targetIds.back();
+	m_characterIds.pop_back();
+	m_targetIds.pop_back();
+}
+
+void CFacingSystem::Update()
+{
+	if (m_characterIds.empty())
+		return;
+
+	GAMEPLAY_PROFILE_SCOPE(FacingUpdate);
+
+	// Gather the direction from every character to its target on the ground plane
+	m_entities.clear();
+	m_directionX.clear();
+	m_directionY.clear();
+	for (size_t i = 0; i < m_characterIds.size(); ++i)
+	{
+		IEntity* pEntity = gEnv->pEntitySystem->GetEntity(m_characterIds[i]);
+		IEntity* pTarget = gEnv->pEntitySystem->GetEntity(m_targetIds[i]);
+		if (pEntity == nullptr || pTarget == nullptr)
+			continue;
+
+		const Vec3 direction = pTarget->GetWorldPos() - pEntity->GetWorldPos();
+		m_entities.push_back(pEntity);
+		m_directionX.push_back(direction.x);
+		m_directionY.push_back(direction.y);
+	}
+
+	const uint32 count = static_cast<uint32>(m_entities.size());
+	m_rotationW.resize(count);
+	m_rotationZ.resize(count);
+	PlayerKernels::ComputeFacingRotations(m_directionX.data(), m_directionY.data(), m_rotationW.data(), m_rotationZ.data(), count);
+
+	// We only affect Z-axis rotation, so the rotation is built from its W and Z directly
+	// Characters that did not turn are skipped, SetRotation recomputes the transform and notifies every component
+	// The entity's own rotation is compared so that rotations set elsewhere, like respawns and remote updates, are corrected
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const Quat currentRotation = m_entities[i]->GetRotation();
+		float currentW = currentRotation.w;
+		float currentZ = currentRotation.v.z;
+		if (CEngineStateCache::ShouldPushRotation(currentW, currentZ, m_rotationW[i], m_rotationZ[i]))
+		{
+			m_entities[i]->SetRotation(Quat(m_rotationW[i], 0.f, 0.f, m_rotationZ[i]));
+		}
+	}
+}
+
+void CFacingSystem::Reset()
+{
+	m_characterIds.clear();
+	m_targetIds.clear();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Turns characters on the ground plane to face their targets, all characters in one batch per frame.
+// Entity and target positions are gathered into structure of arrays buffers, the rotations are computed in one
+// vectorized pass and only the rotations that differ from the entities' current ones are written back.
+////////////////////////////////////////////////////////
+class CFacingSystem
+{
+public:
+	CFacingSystem() = default;
+	~CFacingSystem();
+
+	// Registers the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Makes the character face the target entity every frame, replacing any previous target.
+	void SetFacingTarget(EntityId characterId, EntityId targetId);
+	void RemoveCharacter(EntityId characterId);
+
+	// Computes and applies the rotations of every registered character.
+	void Update();
+	// Forgets every character, called when the level unloads.
+	void Reset();
+
+	uint32 GetCharacterCount() const { return static_cast<uint32>(m_characterIds.size()); }
+
+private:
+	// Registered characters, m_targetIds[i] is the target of m_characterIds[i].
+	std::vector<EntityId> m_characterIds;
+	std::vector<EntityId> m_targetIds;
+
+	// Per frame buffers, one entry per character that could be resolved this frame.
+	std::vector<IEntity*> m_entities;
+	std::vector<float> m_directionX;
+	std::vector<float> m_directionY;
+	std::vector<float> m_rotationW;
+	std::vector<float> m_rotationZ;
+};
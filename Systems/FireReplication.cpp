@@ -0,0 +1,145 @@
+#include "StdAfx.h"
+#include "FireReplication.h"
+#include "GamePlugin.h"
+#include "Components/ProjectileTypes.h"
+
+namespace
+{
+	static_assert(static_cast<uint32>(EProjectileType::Count) <= (1u << NetKernels::FireEventWeaponBits), "Fire events have too few bits for the weapon type");
+
+	// IPv4 and UDP headers every packet pays on the wire on top of its payload
+	const uint32 PacketHeaderBytes = 28;
+
+	void LogFireReplicationStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CFireReplication& fireReplication = CGamePlugin::GetInstance()->GetFireReplication();
+		fireReplication.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			fireReplication.ResetStatistics();
+		}
+	}
+
+	uint32 GetServerTimeMs()
+	{
+		return static_cast<uint32>(gEnv->pGameFramework->GetServerTime().GetMilliSecondsAsInt64());
+	}
+}
+
+CFireReplication::~CFireReplication()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_fireReplication", true);
+		gEnv->pConsole->UnregisterVariable("g_fireReplicationSnapshotRate", true);
+		gEnv->pConsole->RemoveCommand("g_fireReplicationStats");
+	}
+}
+
+void CFireReplication::RegisterCVars()
+{
+	REGISTER_CVAR2("g_fireReplication", &m_isEnabled, m_isEnabled, VF_NULL, "Packs the shots the server launches into compact fire events\n0: Off\n1: On");
+	REGISTER_CVAR2("g_fireReplicationSnapshotRate", &m_snapshotRate, m_snapshotRate, VF_NULL, "Snapshots per second assumed when comparing fire events with replicated bullet entities");
+	REGISTER_COMMAND("g_fireReplicationStats", LogFireReplicationStatsCommand, VF_NULL, "Prints fire event packets and bytes per shot compared to bullet entities. Pass 'reset' to clear the counters afterwards");
+}
+
+void CFireReplication::OnLevelLoadEnd()
+{
+	// Levels are square, the grid is as high as the level is wide and starts 512m below the ground
+	m_grid = NetKernels::SLevelGrid();
+	m_grid.extent = static_cast<float>(max(gEnv->p3DEngine->GetTerrainSize(), 1024));
+}
+
+void CFireReplication::OnShotLaunched(EProjectileType type, EFireMode fireMode, const QuatTS& muzzle, EntityId shooterId, float age)
+{
+	if (m_isEnabled == 0 || !CGamePlugin::GetInstance()->HasRemoteClients())
+		return;
+
+	NetKernels::SFireEvent event;
+	// The low 16 bits of an entity id are its index in the entity system, the salt is not needed to find the shooter
+	event.shooterIndex = static_cast<uint16>(shooterId & 0xFFFF);
+	event.weaponType = static_cast<uint8>(type);
+	// Clients must not decide the fire mode from their own CVars
+	event.isHitscan = fireMode == EFireMode::Hitscan;
+	event.positionX = muzzle.t.x;
+	event.positionY = muzzle.t.y;
+	event.positionZ = muzzle.t.z;
+	event.rotationX = muzzle.q.v.x;
+	event.rotationY = muzzle.q.v.y;
+	event.rotationZ = muzzle.q.v.z;
+	event.rotationW = muzzle.q.w;
+	event.scale = muzzle.s;
+	// Deferred shots keep the time they were fired at, so clients age them the same way the server did
+	event.timestampMs = GetServerTimeMs() - static_cast<uint32>(age * 1000.f);
+	event.seed = m_nextSeed++;
+	m_pendingEvents.push_back(event);
+
+	++m_statistics.shots;
+	m_statistics.entityReplicationBytes += NetKernels::GetEntityReplicationBytes(CProjectileManager::GetLifetime(type), m_snapshotRate);
+}
+
+void CFireReplication::Update()
+{
+	if (m_pendingEvents.empty())
+		return;
+
+	for (size_t first = 0; first < m_pendingEvents.size(); first += NetKernels::MaxFireEventsPerPacket)
+	{
+		const uint32 count = static_cast<uint32>(min(m_pendingEvents.size() - first, static_cast<size_t>(NetKernels::MaxFireEventsPerPacket)));
+		NetKernels::EncodeFireEvents(m_grid, &m_pendingEvents[first], count, m_packet);
+		++m_statistics.packets;
+		m_statistics.payloadBytes += m_packet.size();
+	}
+	m_pendingEvents.clear();
+}
+
+void CFireReplication::ReceivePacket(const uint8* pData, uint32 byteCount)
+{
+	m_decodedEvents.clear();
+	if (!NetKernels::DecodeFireEvents(m_grid, pData, byteCount, m_decodedEvents))
+	{
+		++m_statistics.rejectedPackets;
+		return;
+	}
+
+	const uint32 currentTimeMs = GetServerTimeMs();
+	const float gravityZ = gEnv->pPhysicalWorld->GetPhysVars()->gravity.z;
+	CGamePlugin* pGamePlugin = CGamePlugin::GetInstance();
+	for (const NetKernels::SFireEvent& event : m_decodedEvents)
+	{
+		if (event.weaponType >= static_cast<uint8>(EProjectileType::Count))
+			continue;
+
+		const EProjectileType type = static_cast<EProjectileType>(event.weaponType);
+		++m_statistics.receivedShots;
+
+		// Hitscan shots are resolved on the server and have no trajectory to show
+		if (event.isHitscan)
+			continue;
+
+		const float age = max(static_cast<float>(static_cast<int32>(currentTimeMs - event.timestampMs)) / 1000.f, 0.f);
+		if (age >= CProjectileManager::GetLifetime(type))
+			continue;
+
+		// The copy starts where the server's projectile is by now, not at the muzzle. The server alone decides what it hits
+		Vec3 position;
+		NetKernels::EvaluateFireTrajectory(event, CProjectileManager::GetLaunchSpeed(type), gravityZ, age, position.x, position.y, position.z);
+		const QuatTS origin(Quat(event.rotationW, event.rotationX, event.rotationY, event.rotationZ), position, event.scale);
+		pGamePlugin->GetProjectileManager().Spawn(type, origin, age, true);
+	}
+}
+
+void CFireReplication::Reset()
+{
+	m_pendingEvents.clear();
+}
+
+void CFireReplication::LogStatistics() const
+{
+	const float shots = static_cast<float>(max(m_statistics.shots, 1u));
+	const float wireBytes = static_cast<float>(m_statistics.payloadBytes + static_cast<uint64>(m_statistics.packets) * PacketHeaderBytes);
+	CryLogAlways("[FireReplication] shots %u in %u packets, %.1f bytes per shot (%.1f on the wire), bullet entities at %.0f Hz would take %.1f bytes per shot",
+		m_statistics.shots, m_statistics.packets, m_statistics.payloadBytes / shots, wireBytes / shots, m_snapshotRate, m_statistics.entityReplicationBytes / shots);
+	CryLogAlways("[FireReplication] received shots %u, rejected packets %u", m_statistics.receivedShots, m_statistics.rejectedPackets);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ProjectilePool.h"
+#include "HitscanSystem.h"
+#include "Core/FireEventCodec.h"
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Replicates weapon fire as compact fire events instead of networked bullet entities.
+// On a server with remote clients every launched shot becomes a quantized event, and the events of a frame are
+// packed into packets. Clients show copies of the projectiles from received packets, placed where the server's
+// projectile is by now and too light to push anything, hits are only resolved by the server.
+// The statistics compare the bytes per shot with what replicating the bullet entities would cost.
+////////////////////////////////////////////////////////
+class CFireReplication
+{
+public:
+	struct SStatistics
+	{
+		uint32 shots = 0;
+		uint32 packets = 0;
+		uint64 payloadBytes = 0;
+		// Bytes the same shots would have cost as bullet entities with a state update per snapshot.
+		uint64 entityReplicationBytes = 0;
+		uint32 receivedShots = 0;
+		uint32 rejectedPackets = 0;
+	};
+
+	CFireReplication() = default;
+	~CFireReplication();
+
+	// Registers the replication CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+	// Fits the quantization grid to the loaded level.
+	void OnLevelLoadEnd();
+
+	// Records a shot the server launched, it goes out with the next packet.
+	void OnShotLaunched(EProjectileType type, EFireMode fireMode, const QuatTS& muzzle, EntityId shooterId, float age);
+	// Packs the shots of this frame into packets.
+	void Update();
+	// Spawns copies of the projectiles of a packet received from the server, called by the client transport.
+	void ReceivePacket(const uint8* pData, uint32 byteCount);
+	// Drops pending shots, called when the level unloads.
+	void Reset();
+
+	const std::vector<uint8>& GetLastPacket() const { return m_packet; }
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	NetKernels::SLevelGrid m_grid;
+	std::vector<NetKernels::SFireEvent> m_pendingEvents;
+	std::vector<NetKernels::SFireEvent> m_decodedEvents;
+	std::vector<uint8> m_packet;
+	SStatistics m_statistics;
+	uint16 m_nextSeed = 1;
+
+	int m_isEnabled = 1;
+	// Snapshot rate the entity replication comparison assumes.
+	float m_snapshotRate = 30.f;
+};
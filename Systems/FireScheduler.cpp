@@ -0,0 +1,176 @@
+#include "StdAfx.h"
+#include "FireScheduler.h"
+#include "GamePlugin.h"
+#include "Components/ProjectileTypes.h"
+
+namespace
+{
+	void LogFireSchedulerStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CFireScheduler& fireScheduler = CGamePlugin::GetInstance()->GetFireScheduler();
+		fireScheduler.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			fireScheduler.ResetStatistics();
+		}
+	}
+}
+
+CFireScheduler::CFireScheduler()
+{
+	// Start from the fire rates of the weapon traits, the CVars can override them
+	for (size_t i = 0; i < m_fireRates.size(); ++i)
+	{
+		DispatchProjectileType(static_cast<EProjectileType>(i), [this, i](auto traits)
+		{
+			m_fireRates[i] = decltype(traits)::FireRate;
+		});
+	}
+}
+
+CFireScheduler::~CFireScheduler()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_regularFireRate", true);
+		gEnv->pConsole->UnregisterVariable("g_waterFireRate", true);
+		gEnv->pConsole->UnregisterVariable("g_fireSpawnBudget", true);
+		gEnv->pConsole->RemoveCommand("g_fireSchedulerStats");
+	}
+}
+
+void CFireScheduler::RegisterCVars()
+{
+	float& regularFireRate = m_fireRates[static_cast<size_t>(EProjectileType::Regular)];
+	float& waterFireRate = m_fireRates[static_cast<size_t>(EProjectileType::Water)];
+	REGISTER_CVAR2("g_regularFireRate", &regularFireRate, regularFireRate, VF_NULL, "Rounds per second a player can fire the regular weapon, 0 for no limit");
+	REGISTER_CVAR2("g_waterFireRate", &waterFireRate, waterFireRate, VF_NULL, "Rounds per second a player can fire the water weapon, 0 for no limit");
+	REGISTER_CVAR2("g_fireSpawnBudget", &m_spawnBudget, m_spawnBudget, VF_NULL, "Projectiles launched per frame at most, further shots wait for the next frames. 0 for no limit");
+	REGISTER_COMMAND("g_fireSchedulerStats", LogFireSchedulerStatsCommand, VF_NULL, "Prints queue depth, deferred shots and spawn budget usage. Pass 'reset' to clear the counters afterwards");
+}
+
+bool CFireScheduler::RequestShot(EProjectileType type, const QuatTS& muzzle, EntityId shooterId)
+{
+	++m_statistics.requested;
+
+	// Simulation time, so that a replayed recording is rate limited exactly like the recorded session
+	const float currentTime = CGamePlugin::GetInstance()->GetSimulationClock().GetTime();
+	const float fireRate = m_fireRates[static_cast<size_t>(type)];
+	if (fireRate > 0.f)
+	{
+		// New shooters start with every weapon ready
+		auto it = m_nextShotTimes.find(shooterId);
+		if (it == m_nextShotTimes.end())
+		{
+			it = m_nextShotTimes.emplace(shooterId, TShotTimes()).first;
+			it->second.fill(0.f);
+		}
+
+		float& nextShotTime = it->second[static_cast<size_t>(type)];
+		if (currentTime < nextShotTime)
+		{
+			++m_statistics.rateLimited;
+			return false;
+		}
+		// Held fire carries the time it was late over so that the rate does not round up to whole frames,
+		// a shooter that paused for longer than one interval starts over from now instead of saving up shots
+		const float interval = 1.f / fireRate;
+		nextShotTime = (currentTime - nextShotTime < interval ? nextShotTime : currentTime) + interval;
+	}
+
+	m_queue.push_back(SQueuedShot { muzzle, shooterId, type, currentTime, gEnv->nMainFrameID });
+	m_statistics.maxQueueDepth = max(m_statistics.maxQueueDepth, static_cast<uint32>(m_queue.size()));
+	return true;
+}
+
+void CFireScheduler::Update()
+{
+	++m_statistics.frames;
+	if (m_queue.empty())
+		return;
+
+	const float currentTime = CGamePlugin::GetInstance()->GetSimulationClock().GetTime();
+	const int frameId = gEnv->nMainFrameID;
+	const uint32 budget = m_spawnBudget > 0 ? static_cast<uint32>(m_spawnBudget) : ~0u;
+	uint32 spawns = 0;
+
+	// Oldest shots first, so no shot waits longer than the queue takes to drain
+	while (!m_queue.empty() && spawns < budget)
+	{
+		const SQueuedShot shot = m_queue.front();
+		m_queue.pop_front();
+
+		const float age = currentTime - shot.requestTime;
+		if (age >= CProjectileManager::GetLifetime(shot.type))
+		{
+			++m_statistics.expired;
+			continue;
+		}
+
+		if (shot.requestFrameId != frameId)
+		{
+			++m_statistics.deferred;
+			m_statistics.maxDeferralSeconds = max(m_statistics.maxDeferralSeconds, age);
+		}
+
+		++m_statistics.launched;
+		spawns += Launch(shot, age) ? 1 : 0;
+	}
+
+	if (!m_queue.empty())
+	{
+		++m_statistics.budgetExhaustedFrames;
+	}
+	m_statistics.maxSpawnsPerFrame = max(m_statistics.maxSpawnsPerFrame, spawns);
+	m_statistics.totalSpawns += spawns;
+}
+
+void CFireScheduler::RemoveShooter(EntityId shooterId)
+{
+	m_nextShotTimes.erase(shooterId);
+}
+
+void CFireScheduler::Reset()
+{
+	m_queue.clear();
+	m_nextShotTimes.clear();
+}
+
+void CFireScheduler::LogStatistics() const
+{
+	const float averageSpawns = m_statistics.frames > 0 ? static_cast<float>(m_statistics.totalSpawns) / m_statistics.frames : 0.f;
+	CryLogAlways("[FireScheduler] requested %u, rate limited %u, launched %u, deferred %u (max %.1f ms), expired %u",
+		m_statistics.requested, m_statistics.rateLimited, m_statistics.launched, m_statistics.deferred, m_statistics.maxDeferralSeconds * 1000.f, m_statistics.expired);
+	CryLogAlways("[FireScheduler] queue depth %u (max %u), spawns per frame avg %.2f max %u of budget %d, budget exhausted in %u of %u frames",
+		static_cast<uint32>(m_queue.size()), m_statistics.maxQueueDepth, averageSpawns, m_statistics.maxSpawnsPerFrame, m_spawnBudget,
+		m_statistics.budgetExhaustedFrames, m_statistics.frames);
+}
+
+bool CFireScheduler::Launch(const SQueuedShot& shot, float age)
+{
+	CGamePlugin* pGamePlugin = CGamePlugin::GetInstance();
+	bool isHitscan = false;
+	DispatchProjectileType(shot.type, [pGamePlugin, &shot, &isHitscan](auto traits)
+	{
+		isHitscan = decltype(traits)::SupportsHitscan && pGamePlugin->GetHitscanSystem().GetFireMode(shot.type) == EFireMode::Hitscan;
+	});
+
+	if (isHitscan)
+	{
+		// Resolved with a ray query at the end of the frame, no bullet entity is involved so it costs no budget
+		pGamePlugin->GetHitscanSystem().QueueShot(shot.muzzle, shot.shooterId);
+		// Clients get the shot as a fire event and show their own copy of it
+		pGamePlugin->GetFireReplication().OnShotLaunched(shot.type, EFireMode::Hitscan, shot.muzzle, shot.shooterId, age);
+		return false;
+	}
+
+	// The projectile pool moves a parked bullet to the barrel and launches it in the barrel's forward direction.
+	// The time the shot waited is taken off its lifetime, so deferred bullets still expire when they would have.
+	// A spawn that failed created nothing, so it leaves the budget to the next shot and is not sent to clients
+	if (pGamePlugin->GetProjectileManager().Spawn(shot.type, shot.muzzle, age) == nullptr)
+		return false;
+
+	pGamePlugin->GetFireReplication().OnShotLaunched(shot.type, EFireMode::Projectile, shot.muzzle, shot.shooterId, age);
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "ProjectilePool.h"
+#include "GameplayMemory.h"
+#include <array>
+#include <deque>
+#include <unordered_map>
+
+////////////////////////////////////////////////////////
+// Paces weapon fire.
+// Every shooter is limited to the fire rate of each weapon, and accepted shots are queued and launched in the
+// plug-in update within a global per-frame spawn budget. Shots over the budget wait for the next frames with their
+// request time kept, so a burst of input from many players is spread out instead of landing in one frame.
+////////////////////////////////////////////////////////
+class CFireScheduler
+{
+public:
+	struct SStatistics
+	{
+		uint32 requested = 0;
+		// Shots refused because the shooter fired again faster than the weapon's fire rate.
+		uint32 rateLimited = 0;
+		uint32 launched = 0;
+		// Launched shots that had to wait at least one frame for budget.
+		uint32 deferred = 0;
+		// Shots dropped because they waited longer than their projectile would have lived.
+		uint32 expired = 0;
+		uint32 frames = 0;
+		// Frames in which the budget ran out with shots still queued.
+		uint32 budgetExhaustedFrames = 0;
+		uint32 maxQueueDepth = 0;
+		uint32 maxSpawnsPerFrame = 0;
+		uint64 totalSpawns = 0;
+		float maxDeferralSeconds = 0.f;
+	};
+
+	CFireScheduler();
+	~CFireScheduler();
+
+	// Registers the fire rate and budget CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Queues a shot from the muzzle if the shooter may fire the weapon again, returns false if it was rate limited.
+	bool RequestShot(EProjectileType type, const QuatTS& muzzle, EntityId shooterId);
+	// Forgets the fire rate history of a shooter, called when its entity goes away. Its queued shots still launch.
+	void RemoveShooter(EntityId shooterId);
+	// Launches queued shots until the spawn budget of this frame is used up.
+	void Update();
+	// Drops queued shots and fire rate history, called when the level unloads.
+	void Reset();
+
+	uint32 GetQueueDepth() const { return static_cast<uint32>(m_queue.size()); }
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	struct SQueuedShot
+	{
+		QuatTS muzzle;
+		EntityId shooterId;
+		EProjectileType type;
+		float requestTime;
+		int requestFrameId;
+	};
+
+	// Returns true if the shot spawned an entity and used up budget.
+	bool Launch(const SQueuedShot& shot, float age);
+
+	typedef std::array<float, static_cast<size_t>(EProjectileType::Count)> TShotTimes;
+
+	// Queued shots and fire rate history come and go with every shot, their nodes come from the gameplay memory pools.
+	std::deque<SQueuedShot, TGameplayAllocator<SQueuedShot, EMemoryTag::FireQueue>> m_queue;
+	// Earliest time each shooter may fire each weapon again.
+	std::unordered_map<EntityId, TShotTimes, std::hash<EntityId>, std::equal_to<EntityId>,
+		TGameplayAllocator<std::pair<const EntityId, TShotTimes>, EMemoryTag::FireRateHistory>> m_nextShotTimes;
+	SStatistics m_statistics;
+
+	// Rounds per second per projectile type, bound to CVars.
+	std::array<float, static_cast<size_t>(EProjectileType::Count)> m_fireRates = {};
+	int m_spawnBudget = 8;
+};
@@ -0,0 +1,120 @@
+#include "StdAfx.h"
+#include "GameplayMemory.h"
+
+CGameplayMemory* CGameplayMemory::s_pInstance = nullptr;
+
+namespace
+{
+	const char* GetMemoryTagName(EMemoryTag tag)
+	{
+		switch (tag)
+		{
+		case EMemoryTag::FireQueue: return "FireQueue";
+		case EMemoryTag::FireRateHistory: return "FireRateHistory";
+		case EMemoryTag::RayQueryQueue: return "RayQueryQueue";
+		case EMemoryTag::TriggerListeners: return "TriggerListeners";
+		case EMemoryTag::TriggerPlayers: return "TriggerPlayers";
+		case EMemoryTag::ProjectilePool: return "ProjectilePool";
+		case EMemoryTag::ProjectileTracking: return "ProjectileTracking";
+		}
+		return "Unknown";
+	}
+
+	void LogGameplayMemoryStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CGameplayMemory::Get()->LogStatistics();
+	}
+}
+
+CGameplayMemory::CGameplayMemory()
+{
+	s_pInstance = this;
+}
+
+CGameplayMemory::~CGameplayMemory()
+{
+	s_pInstance = nullptr;
+
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_gameplayLevelArenaKB", true);
+		gEnv->pConsole->RemoveCommand("g_gameplayMemoryStats");
+	}
+}
+
+void CGameplayMemory::RegisterCVars()
+{
+	REGISTER_CVAR2("g_gameplayLevelArenaKB", &m_levelArenaChunkKB, m_levelArenaChunkKB, VF_NULL, "Kilobytes the level arena requests from the heap at a time, a level that needs more is served from one block from the next level on");
+	REGISTER_COMMAND("g_gameplayMemoryStats", LogGameplayMemoryStatsCommand, VF_NULL, "Prints the bytes and allocations the plug-in holds per owner, and the pool and level arena usage");
+	m_levelArena.SetChunkSize(static_cast<size_t>(max(m_levelArenaChunkKB, 1)) * 1024);
+}
+
+void* CGameplayMemory::Allocate(EMemoryTag tag, size_t size)
+{
+	void* pMemory = m_pools.Allocate(size);
+	if (pMemory != nullptr)
+	{
+		m_poolCounters[static_cast<size_t>(tag)].Add(size);
+	}
+	return pMemory;
+}
+
+void CGameplayMemory::Free(EMemoryTag tag, void* pMemory, size_t size)
+{
+	if (pMemory == nullptr)
+		return;
+
+	m_pools.Free(pMemory, size);
+	m_poolCounters[static_cast<size_t>(tag)].Remove(size);
+}
+
+void* CGameplayMemory::AllocateLevel(EMemoryTag tag, size_t size, size_t alignment)
+{
+	void* pMemory = m_levelArena.Allocate(size, alignment);
+	if (pMemory != nullptr)
+	{
+		m_levelCounters[static_cast<size_t>(tag)].Add(size);
+	}
+	return pMemory;
+}
+
+void CGameplayMemory::OnLevelUnload()
+{
+	m_levelArena.SetChunkSize(static_cast<size_t>(max(m_levelArenaChunkKB, 1)) * 1024);
+	m_levelArena.Reset();
+	++m_levelResets;
+
+	// Everything in the arena is gone, only the peaks and totals are kept
+	for (MemoryKernels::SAllocationCounters& counters : m_levelCounters)
+	{
+		counters.liveBytes = 0;
+		counters.liveCount = 0;
+	}
+}
+
+void CGameplayMemory::LogStatistics() const
+{
+	CryLogAlways("[GameplayMemory] %-20s %12s %8s %12s %10s", "Owner", "Live bytes", "Live", "Peak bytes", "Total");
+	for (size_t i = 0; i < m_poolCounters.size(); ++i)
+	{
+		const MemoryKernels::SAllocationCounters& pool = m_poolCounters[i];
+		const MemoryKernels::SAllocationCounters& level = m_levelCounters[i];
+		// Each owner uses either the pools or the level arena
+		const MemoryKernels::SAllocationCounters& counters = level.totalCount > 0 ? level : pool;
+		CryLogAlways("[GameplayMemory] %-20s %12llu %8llu %12llu %10llu%s", GetMemoryTagName(static_cast<EMemoryTag>(i)),
+			static_cast<unsigned long long>(counters.liveBytes), static_cast<unsigned long long>(counters.liveCount),
+			static_cast<unsigned long long>(counters.peakBytes), static_cast<unsigned long long>(counters.totalCount), level.totalCount > 0 ? " (level)" : "");
+	}
+
+	for (uint32 sizeClass = 0; sizeClass < MemoryKernels::CSizeClassPool::ClassCount; ++sizeClass)
+	{
+		const MemoryKernels::CSizeClassPool::SClassStatistics& statistics = m_pools.GetClassStatistics(sizeClass);
+		CryLogAlways("[GameplayMemory] pool %4u bytes: %u of %u blocks used", static_cast<uint32>(MemoryKernels::CSizeClassPool::GetBlockSize(sizeClass)),
+			statistics.usedBlocks, statistics.reservedBlocks);
+	}
+	CryLogAlways("[GameplayMemory] pools reserve %u KB, %u larger blocks live on the heap",
+		static_cast<uint32>(m_pools.GetReservedBytes() / 1024), m_pools.GetOversizedCount());
+	CryLogAlways("[GameplayMemory] level arena: used %u KB, peak %u KB, reserved %u KB in %u chunks, %u level resets",
+		static_cast<uint32>(m_levelArena.GetUsedBytes() / 1024), static_cast<uint32>(m_levelArena.GetPeakBytes() / 1024),
+		static_cast<uint32>(m_levelArena.GetReservedBytes() / 1024), m_levelArena.GetChunkCount(), m_levelResets);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Core/GameplayMemory.h"
+#include <array>
+#include <type_traits>
+
+// Owners of gameplay memory, the statistics are kept per tag.
+enum class EMemoryTag : uint8
+{
+	// Session pools, container nodes inserted and erased all the time.
+	FireQueue = 0,
+	FireRateHistory,
+	RayQueryQueue,
+	TriggerListeners,
+	TriggerPlayers,
+	// Level arena, arrays sized once per level.
+	ProjectilePool,
+	ProjectileTracking,
+	Count
+};
+
+////////////////////////////////////////////////////////
+// Memory the plug-in owns, kept off the general heap.
+// Small blocks come from size class pools that live for the whole session, so containers whose nodes are inserted
+// and erased every frame reuse the same blocks instead of fragmenting the heap. Storage that lives exactly as long
+// as a level comes from a linear arena that is rewound in one go when the level unloads. Every allocation is
+// counted per tag, g_gameplayMemoryStats prints what the plug-in holds. Main thread only.
+////////////////////////////////////////////////////////
+class CGameplayMemory
+{
+public:
+	CGameplayMemory();
+	~CGameplayMemory();
+
+	// Registers the arena CVar and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Blocks from the session pools, the size has to be passed again when the block is freed.
+	void* Allocate(EMemoryTag tag, size_t size);
+	void Free(EMemoryTag tag, void* pMemory, size_t size);
+
+	// Memory that stays valid until the level unloads, it is never freed on its own.
+	void* AllocateLevel(EMemoryTag tag, size_t size, size_t alignment);
+	template<typename T>
+	T* AllocateLevelArray(EMemoryTag tag, uint32 count)
+	{
+		// The arena is rewound without running destructors
+		static_assert(std::is_trivially_destructible<T>::value, "Level arrays are dropped without destruction");
+		return static_cast<T*>(AllocateLevel(tag, sizeof(T) * count, alignof(T)));
+	}
+
+	// Rewinds the level arena, called last when the level unloads, after every system let go of its level storage.
+	void OnLevelUnload();
+
+	const MemoryKernels::SAllocationCounters& GetPoolCounters(EMemoryTag tag) const { return m_poolCounters[static_cast<size_t>(tag)]; }
+	const MemoryKernels::SAllocationCounters& GetLevelCounters(EMemoryTag tag) const { return m_levelCounters[static_cast<size_t>(tag)]; }
+	void LogStatistics() const;
+
+	static CGameplayMemory* Get() { return s_pInstance; }
+
+private:
+	static CGameplayMemory* s_pInstance;
+
+	MemoryKernels::CSizeClassPool m_pools;
+	MemoryKernels::CLinearArena m_levelArena;
+	std::array<MemoryKernels::SAllocationCounters, static_cast<size_t>(EMemoryTag::Count)> m_poolCounters;
+	std::array<MemoryKernels::SAllocationCounters, static_cast<size_t>(EMemoryTag::Count)> m_levelCounters;
+	uint32 m_levelResets = 0;
+
+	int m_levelArenaChunkKB = 64;
+};
+
+////////////////////////////////////////////////////////
+// STL allocator over the gameplay memory pools, counting under the tag.
+// For containers of plug-in systems, for example std::deque<T, TGameplayAllocator<T, EMemoryTag::FireQueue>>.
+////////////////////////////////////////////////////////
+template<typename T, EMemoryTag Tag>
+class TGameplayAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef TGameplayAllocator<U, Tag> other;
+	};
+
+	TGameplayAllocator() = default;
+	template<typename U>
+	TGameplayAllocator(const TGameplayAllocator<U, Tag>&) {}
+
+	T* allocate(size_t count)
+	{
+		static_assert(alignof(T) <= MemoryKernels::BlockAlignment, "Pool blocks are only aligned to MemoryKernels::BlockAlignment");
+		return static_cast<T*>(CGameplayMemory::Get()->Allocate(Tag, count * sizeof(T)));
+	}
+
+	void deallocate(T* pMemory, size_t count)
+	{
+		CGameplayMemory::Get()->Free(Tag, pMemory, count * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const TGameplayAllocator<U, Tag>&) const { return true; }
+	template<typename U>
+	bool operator!=(const TGameplayAllocator<U, Tag>&) const { return false; }
+};
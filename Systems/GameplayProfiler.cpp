@@ -0,0 +1,157 @@
+#include "StdAfx.h"
+#include "GameplayProfiler.h"
+
+CGameplayProfiler* CGameplayProfiler::s_pInstance = nullptr;
+
+namespace
+{
+	const char* GetProfileScopeName(EProfileScope scope)
+	{
+		switch (scope)
+		{
+		case EProfileScope::PlayerUpdate: return "PlayerUpdate";
+		case EProfileScope::PlayerJobUpdate: return "PlayerJobUpdate";
+		case EProfileScope::PlayerJobCompute: return "PlayerJobCompute";
+		case EProfileScope::UpdateCursor: return "UpdateCursor";
+		case EProfileScope::ApplyMovement: return "ApplyMovement";
+		case EProfileScope::UpdateAnimation: return "UpdateAnimation";
+		case EProfileScope::ApplyCamera: return "ApplyCamera";
+		case EProfileScope::WeaponFire: return "WeaponFire";
+		case EProfileScope::ProjectileSpawn: return "ProjectileSpawn";
+		case EProfileScope::ProjectileDespawn: return "ProjectileDespawn";
+		case EProfileScope::ProjectileUpdate: return "ProjectileUpdate";
+		case EProfileScope::HitscanResolve: return "HitscanResolve";
+		case EProfileScope::RayQueryUpdate: return "RayQueryUpdate";
+		case EProfileScope::TriggerEvent: return "TriggerEvent";
+		case EProfileScope::TriggerBroadphase: return "TriggerBroadphase";
+		case EProfileScope::FacingUpdate: return "FacingUpdate";
+		}
+		return "Unknown";
+	}
+
+	// Lower bound of the first histogram bucket in microseconds.
+	const float HistogramBaseMicroseconds = 0.1f;
+
+	void GameplayProfileStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CGameplayProfiler* pProfiler = CGameplayProfiler::Get();
+		if (pProfiler == nullptr)
+			return;
+
+		pProfiler->LogStatistics();
+		// Passing "reset" clears the histograms after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			pProfiler->Reset();
+		}
+	}
+}
+
+CGameplayProfiler::CGameplayProfiler()
+{
+	s_pInstance = this;
+}
+
+CGameplayProfiler::~CGameplayProfiler()
+{
+	s_pInstance = nullptr;
+
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_gameplayProfile", true);
+		gEnv->pConsole->RemoveCommand("g_gameplayProfileStats");
+	}
+}
+
+void CGameplayProfiler::RegisterCVars()
+{
+	m_microsecondsPerTick = 1000000.f / static_cast<float>(CryGetTicksPerSec());
+
+	REGISTER_CVAR2("g_gameplayProfile", &m_isEnabled, m_isEnabled, VF_NULL, "Enables the gameplay profiler timing histograms");
+	REGISTER_COMMAND("g_gameplayProfileStats", GameplayProfileStatsCommand, VF_NULL, "Prints min/avg/p99/max timings per gameplay scope and spawn/remove counts per frame. Pass 'reset' to clear them afterwards");
+}
+
+void CGameplayProfiler::AddSample(EProfileScope scope, int64 ticks)
+{
+	SScopeStatistics& statistics = m_scopes[static_cast<size_t>(scope)];
+	statistics.minTicks = statistics.count == 0 ? ticks : min(statistics.minTicks, ticks);
+	statistics.maxTicks = max(statistics.maxTicks, ticks);
+	statistics.totalTicks += ticks;
+	++statistics.count;
+	++statistics.histogram[GetBucket(ticks)];
+}
+
+void CGameplayProfiler::EndFrame()
+{
+	AddToCounter(m_spawns, m_spawnsThisFrame);
+	AddToCounter(m_removes, m_removesThisFrame);
+	m_spawnsThisFrame = 0;
+	m_removesThisFrame = 0;
+	++m_frameCount;
+}
+
+void CGameplayProfiler::Reset()
+{
+	m_scopes.fill(SScopeStatistics());
+	m_spawns = SFrameCounter();
+	m_removes = SFrameCounter();
+	m_frameCount = 0;
+}
+
+void CGameplayProfiler::LogStatistics() const
+{
+	CryLogAlways("[GameplayProfiler] %-22s %8s %10s %10s %10s %10s", "Scope", "Count", "Min us", "Avg us", "P99 us", "Max us");
+	for (size_t i = 0; i < m_scopes.size(); ++i)
+	{
+		const SScopeStatistics& statistics = m_scopes[i];
+		if (statistics.count == 0)
+			continue;
+
+		CryLogAlways("[GameplayProfiler] %-22s %8u %10.2f %10.2f %10.2f %10.2f", GetProfileScopeName(static_cast<EProfileScope>(i)), statistics.count,
+			TicksToMicroseconds(statistics.minTicks), TicksToMicroseconds(statistics.totalTicks) / statistics.count,
+			GetPercentile(statistics, 0.99f), TicksToMicroseconds(statistics.maxTicks));
+	}
+
+	const float frameCount = static_cast<float>(max(m_frameCount, 1u));
+	CryLogAlways("[GameplayProfiler] %u frames, spawns per frame last %u avg %.2f max %u, removes per frame last %u avg %.2f max %u", m_frameCount,
+		m_spawns.last, m_spawns.total / frameCount, m_spawns.max, m_removes.last, m_removes.total / frameCount, m_removes.max);
+}
+
+size_t CGameplayProfiler::GetBucket(int64 ticks) const
+{
+	const float microseconds = TicksToMicroseconds(ticks);
+	if (microseconds <= HistogramBaseMicroseconds)
+		return 0;
+
+	// Four buckets per doubling of the duration
+	const size_t bucket = static_cast<size_t>(4.f * log2f(microseconds / HistogramBaseMicroseconds)) + 1;
+	return min(bucket, HistogramBucketCount - 1);
+}
+
+float CGameplayProfiler::GetBucketUpperBound(size_t bucket) const
+{
+	return HistogramBaseMicroseconds * exp2f(static_cast<float>(bucket) * 0.25f);
+}
+
+float CGameplayProfiler::GetPercentile(const SScopeStatistics& statistics, float percentile) const
+{
+	// Report the upper bound of the bucket the percentile falls into, never more than the slowest sample
+	const uint32 threshold = static_cast<uint32>(ceilf(statistics.count * percentile));
+	uint32 cumulative = 0;
+	for (size_t i = 0; i < statistics.histogram.size(); ++i)
+	{
+		cumulative += statistics.histogram[i];
+		if (cumulative >= threshold)
+		{
+			return min(GetBucketUpperBound(i), TicksToMicroseconds(statistics.maxTicks));
+		}
+	}
+	return TicksToMicroseconds(statistics.maxTicks);
+}
+
+void CGameplayProfiler::AddToCounter(SFrameCounter& counter, uint32 value)
+{
+	counter.last = value;
+	counter.max = max(counter.max, value);
+	counter.total += value;
+}
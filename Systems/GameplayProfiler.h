@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+
+// Gameplay code paths that are timed by the gameplay profiler.
+enum class EProfileScope : uint8
+{
+	PlayerUpdate = 0,
+	PlayerJobUpdate,
+	PlayerJobCompute,
+	UpdateCursor,
+	ApplyMovement,
+	UpdateAnimation,
+	ApplyCamera,
+	WeaponFire,
+	ProjectileSpawn,
+	ProjectileDespawn,
+	ProjectileUpdate,
+	HitscanResolve,
+	RayQueryUpdate,
+	TriggerEvent,
+	TriggerBroadphase,
+	FacingUpdate,
+	Count
+};
+
+////////////////////////////////////////////////////////
+// Lightweight timing aggregator for the plug-in's hot paths.
+// Keeps min/avg/max and a logarithmic histogram per scope to report p99, plus per-frame spawn and remove counts,
+// so plug-in cost can be watched live on builds without the engine profiler attached.
+////////////////////////////////////////////////////////
+class CGameplayProfiler
+{
+public:
+	// Times the enclosing scope and adds the sample to the profiler on destruction.
+	class CScopedTimer
+	{
+	public:
+		explicit CScopedTimer(EProfileScope scope)
+			: m_scope(scope)
+			, m_startTicks(s_pInstance != nullptr && s_pInstance->m_isEnabled != 0 ? CryGetTicks() : 0)
+		{
+		}
+
+		~CScopedTimer()
+		{
+			if (m_startTicks != 0)
+			{
+				s_pInstance->AddSample(m_scope, CryGetTicks() - m_startTicks);
+			}
+		}
+
+	private:
+		EProfileScope m_scope;
+		int64 m_startTicks;
+	};
+
+	CGameplayProfiler();
+	~CGameplayProfiler();
+
+	// Registers the enable CVar and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	void AddSample(EProfileScope scope, int64 ticks);
+	void CountSpawn() { ++m_spawnsThisFrame; }
+	void CountRemove() { ++m_removesThisFrame; }
+	// Folds this frame's spawn and remove counts into the statistics, called once per frame.
+	void EndFrame();
+
+	void Reset();
+	void LogStatistics() const;
+
+	static CGameplayProfiler* Get() { return s_pInstance; }
+
+private:
+	// Quarter octave buckets starting at 100 ns, the last one ends at 0.1 us * 2^(119/4), roughly 90 seconds, so that
+	// hitches of whole frames still land in their own bucket.
+	static constexpr size_t HistogramBucketCount = 120;
+
+	struct SScopeStatistics
+	{
+		uint32 count = 0;
+		int64 minTicks = 0;
+		int64 maxTicks = 0;
+		int64 totalTicks = 0;
+		std::array<uint32, HistogramBucketCount> histogram = {};
+	};
+
+	struct SFrameCounter
+	{
+		uint32 last = 0;
+		uint32 max = 0;
+		uint64 total = 0;
+	};
+
+	size_t GetBucket(int64 ticks) const;
+	float GetBucketUpperBound(size_t bucket) const;
+	float GetPercentile(const SScopeStatistics& statistics, float percentile) const;
+	float TicksToMicroseconds(int64 ticks) const { return static_cast<float>(ticks) * m_microsecondsPerTick; }
+	static void AddToCounter(SFrameCounter& counter, uint32 value);
+
+	static CGameplayProfiler* s_pInstance;
+
+	std::array<SScopeStatistics, static_cast<size_t>(EProfileScope::Count)> m_scopes;
+	SFrameCounter m_spawns;
+	SFrameCounter m_removes;
+	uint32 m_spawnsThisFrame = 0;
+	uint32 m_removesThisFrame = 0;
+	uint32 m_frameCount = 0;
+
+	float m_microsecondsPerTick = 0.f;
+	int m_isEnabled = 1;
+};
+
+// Marks the scope for the engine profiler and times it with the gameplay profiler.
+#define GAMEPLAY_PROFILE_SCOPE(scope)                      \
+	CRY_PROFILE_SECTION(PROFILE_GAME, #scope);               \
+	CGameplayProfiler::CScopedTimer gameplayProfileScopeTimer(EProfileScope::scope)
@@ -0,0 +1,147 @@
+#include "StdAfx.h"
+#include "HitscanSystem.h"
+#include "GamePlugin.h"
+#include "GameplayProfiler.h"
+#include <CryRenderer/IRenderAuxGeom.h>
+
+namespace
+{
+	void LogHitscanStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CHitscanSystem& hitscanSystem = CGamePlugin::GetInstance()->GetHitscanSystem();
+		hitscanSystem.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			hitscanSystem.ResetStatistics();
+		}
+	}
+}
+
+CHitscanSystem::~CHitscanSystem()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_regularFireMode", true);
+		gEnv->pConsole->UnregisterVariable("g_hitscanRange", true);
+		gEnv->pConsole->UnregisterVariable("g_hitscanImpulse", true);
+		gEnv->pConsole->UnregisterVariable("g_hitscanTracerDuration", true);
+		gEnv->pConsole->RemoveCommand("g_hitscanStats");
+	}
+}
+
+void CHitscanSystem::RegisterCVars()
+{
+	int& regularFireMode = m_fireModes[static_cast<size_t>(EProjectileType::Regular)];
+	REGISTER_CVAR2("g_regularFireMode", &regularFireMode, regularFireMode, VF_NULL, "Fire mode of the regular weapon\n0: Rigid body bullets\n1: Hitscan with tracers");
+	REGISTER_CVAR2("g_hitscanRange", &m_range, m_range, VF_NULL, "Maximum distance of a hitscan shot in meters");
+	REGISTER_CVAR2("g_hitscanImpulse", &m_impulse, m_impulse, VF_NULL, "Impulse applied to physical entities hit by a hitscan shot");
+	REGISTER_CVAR2("g_hitscanTracerDuration", &m_tracerDuration, m_tracerDuration, VF_NULL, "Seconds a hitscan tracer stays visible");
+	REGISTER_COMMAND("g_hitscanStats", LogHitscanStatsCommand, VF_NULL, "Prints hitscan shot, hit and batch counts. Pass 'reset' to clear the counters afterwards");
+}
+
+void CHitscanSystem::QueueShot(const QuatTS& muzzle, EntityId shooterId)
+{
+	m_queuedShots.push_back(SShot { muzzle, shooterId });
+}
+
+void CHitscanSystem::Update(float frameTime)
+{
+	if (!m_queuedShots.empty())
+	{
+		ResolveShots();
+	}
+
+	if (!m_tracers.empty())
+	{
+		UpdateTracers(frameTime);
+	}
+}
+
+void CHitscanSystem::Reset()
+{
+	m_queuedShots.clear();
+	m_tracers.clear();
+}
+
+void CHitscanSystem::LogStatistics() const
+{
+	CryLogAlways("[Hitscan] shots %u, hits %u, batches %u, largest batch %u, live tracers %u",
+		m_statistics.shots, m_statistics.hits, m_statistics.batches, m_statistics.largestBatch, static_cast<uint32>(m_tracers.size()));
+}
+
+void CHitscanSystem::ResolveShots()
+{
+	GAMEPLAY_PROFILE_SCOPE(HitscanResolve);
+	const uint32 batchSize = static_cast<uint32>(m_queuedShots.size());
+	++m_statistics.batches;
+	m_statistics.shots += batchSize;
+	m_statistics.largestBatch = max(m_statistics.largestBatch, batchSize);
+
+	const int objectTypes = ent_all;
+	const unsigned int rayFlags = rwi_stop_at_pierceable | rwi_colltype_any;
+
+	for (const SShot& shot : m_queuedShots)
+	{
+		// Shots leave the muzzle along its forward axis, the same direction bullets are launched in
+		const Vec3 direction = shot.muzzle.q.GetColumn1();
+		Vec3 end = shot.muzzle.t + direction * m_range;
+
+		// Never hit the shooter itself
+		IPhysicalEntity* pSkipEntity = nullptr;
+		if (IEntity* pShooter = gEnv->pEntitySystem->GetEntity(shot.shooterId))
+		{
+			pSkipEntity = pShooter->GetPhysics();
+		}
+
+		ray_hit hit;
+		if (gEnv->pPhysicalWorld->RayWorldIntersection(shot.muzzle.t, direction * m_range, objectTypes, rayFlags, &hit, 1, &pSkipEntity, pSkipEntity != nullptr ? 1 : 0) > 0)
+		{
+			++m_statistics.hits;
+			end = hit.pt;
+
+			// Push whatever we hit, like the rigid body bullet would have
+			if (hit.pCollider != nullptr)
+			{
+				pe_action_impulse impulseAction;
+				impulseAction.impulse = direction * m_impulse;
+				impulseAction.point = hit.pt;
+				hit.pCollider->Action(&impulseAction);
+			}
+		}
+
+		// Dedicated servers have nothing to draw
+		if (!gEnv->IsDedicated())
+		{
+			m_tracers.push_back(STracer { shot.muzzle.t, end, 0.f });
+		}
+	}
+
+	m_queuedShots.clear();
+}
+
+void CHitscanSystem::UpdateTracers(float frameTime)
+{
+	IRenderAuxGeom* pAuxGeom = IRenderAuxGeom::GetAux();
+	const ColorB tracerColor(255, 220, 120);
+
+	for (size_t i = 0; i < m_tracers.size();)
+	{
+		STracer& tracer = m_tracers[i];
+		tracer.age += frameTime;
+
+		if (tracer.age >= m_tracerDuration)
+		{
+			// Swap with the last tracer to keep the array contiguous
+			tracer = m_tracers.back();
+			m_tracers.pop_back();
+			continue;
+		}
+
+		// Fade the tracer out over its lifetime
+		ColorB color = tracerColor;
+		color.a = static_cast<uint8>(255.f * (1.f - tracer.age / m_tracerDuration));
+		pAuxGeom->DrawLine(tracer.from, color, tracer.to, color, 2.f);
+		++i;
+	}
+}
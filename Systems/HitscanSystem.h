@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ProjectilePool.h"
+#include <array>
+#include <vector>
+
+// How a weapon resolves its shots.
+enum class EFireMode : int
+{
+	// A physicalized bullet entity is launched from the muzzle.
+	Projectile = 0,
+	// The shot is resolved instantly with a ray query and only a tracer is drawn.
+	Hitscan
+};
+
+////////////////////////////////////////////////////////
+// Resolves hitscan shots.
+// Shots fired during a frame are collected and resolved together as a batch of ray world intersections from
+// the muzzle, without any physical entity. Each shot leaves a short lived tracer line for visual feedback.
+////////////////////////////////////////////////////////
+class CHitscanSystem
+{
+public:
+	struct SStatistics
+	{
+		uint32 shots = 0;
+		uint32 hits = 0;
+		uint32 batches = 0;
+		uint32 largestBatch = 0;
+	};
+
+	CHitscanSystem() = default;
+	~CHitscanSystem();
+
+	// Registers the per weapon fire mode CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	EFireMode GetFireMode(EProjectileType type) const { return static_cast<EFireMode>(m_fireModes[static_cast<size_t>(type)]); }
+
+	// Queues a shot from the muzzle, it is resolved with the rest of the frame's shots in the next Update.
+	void QueueShot(const QuatTS& muzzle, EntityId shooterId);
+	// Resolves the queued shots and draws the tracers.
+	void Update(float frameTime);
+	// Drops queued shots and tracers, called when the level unloads.
+	void Reset();
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	struct SShot
+	{
+		QuatTS muzzle;
+		EntityId shooterId;
+	};
+
+	struct STracer
+	{
+		Vec3 from;
+		Vec3 to;
+		float age;
+	};
+
+	void ResolveShots();
+	void UpdateTracers(float frameTime);
+
+	std::vector<SShot> m_queuedShots;
+	std::vector<STracer> m_tracers;
+	SStatistics m_statistics;
+
+	// Fire mode per projectile type, stored as int so that they can be bound to CVars.
+	std::array<int, static_cast<size_t>(EProjectileType::Count)> m_fireModes = {};
+	float m_range = 250.f;
+	float m_impulse = 1000.f;
+	float m_tracerDuration = 0.1f;
+};
@@ -0,0 +1,303 @@
+#include "StdAfx.h"
+#include "InputRecorder.h"
+#include "GamePlugin.h"
+
+namespace
+{
+	// "INRC" followed by the format version
+	const uint32 InputRecordingMagic = 0x43524E49;
+	const uint32 InputRecordingVersion = 2;
+
+	string GetInputRecordingPath(const string& name, const char* szExtension)
+	{
+		return string("%USER%/InputRecordings/") + name + szExtension;
+	}
+
+	void StartInputRecordingCommand(IConsoleCmdArgs* pArgs)
+	{
+		const char* szName = pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : "session";
+		CGamePlugin::GetInstance()->GetInputRecorder().StartRecording(szName);
+	}
+
+	void StartInputReplayCommand(IConsoleCmdArgs* pArgs)
+	{
+		const char* szName = pArgs->GetArgCount() > 1 ? pArgs->GetArg(1) : "session";
+		CGamePlugin::GetInstance()->GetInputRecorder().StartReplay(szName);
+	}
+
+	void StopInputRecorderCommand(IConsoleCmdArgs* pArgs)
+	{
+		CGamePlugin::GetInstance()->GetInputRecorder().Stop();
+	}
+
+	template<typename T>
+	void AppendValue(std::vector<uint8>& data, const T& value)
+	{
+		const uint8* pBytes = reinterpret_cast<const uint8*>(&value);
+		data.insert(data.end(), pBytes, pBytes + sizeof(T));
+	}
+
+	template<typename T>
+	bool ReadValue(const std::vector<uint8>& data, size_t& offset, T& value)
+	{
+		if (offset + sizeof(T) > data.size())
+			return false;
+
+		memcpy(&value, &data[offset], sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+}
+
+CInputRecorder::~CInputRecorder()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_inputReplayQuitOnEnd", true);
+		gEnv->pConsole->RemoveCommand("g_inputRecord");
+		gEnv->pConsole->RemoveCommand("g_inputReplay");
+		gEnv->pConsole->RemoveCommand("g_inputStop");
+	}
+}
+
+void CInputRecorder::RegisterCVars()
+{
+	REGISTER_CVAR2("g_inputReplayQuitOnEnd", &m_quitAfterReplay, m_quitAfterReplay, VF_NULL, "Quits once an input replay has played every frame, for automated comparison runs");
+	REGISTER_COMMAND("g_inputRecord", StartInputRecordingCommand, VF_NULL, "Records the player input until g_inputStop. Usage: g_inputRecord <name>");
+	REGISTER_COMMAND("g_inputReplay", StartInputReplayCommand, VF_NULL, "Replays a recording in place of live input and writes the frame times next to it. Usage: g_inputReplay <name>");
+	REGISTER_COMMAND("g_inputStop", StopInputRecorderCommand, VF_NULL, "Stops the current input recording or replay");
+}
+
+void CInputRecorder::StartRecording(const char* szName)
+{
+	Stop();
+
+	m_name = szName;
+	m_data.clear();
+	AppendValue(m_data, InputRecordingMagic);
+	AppendValue(m_data, InputRecordingVersion);
+	m_currentFrameId = -1;
+	m_mode = EMode::Recording;
+	CryLogAlways("[InputRecorder] Recording %s", m_name.c_str());
+}
+
+bool CInputRecorder::StartReplay(const char* szName)
+{
+	Stop();
+
+	m_name = szName;
+	const string filePath = GetInputRecordingPath(m_name, ".inrec");
+	FILE* pFile = gEnv->pCryPak->FOpen(filePath.c_str(), "rb");
+	if (pFile == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_ERROR, "[InputRecorder] Could not open %s", filePath.c_str());
+		return false;
+	}
+
+	m_data.resize(gEnv->pCryPak->FGetSize(pFile));
+	const size_t readSize = m_data.empty() ? 0 : gEnv->pCryPak->FReadRaw(m_data.data(), 1, m_data.size(), pFile);
+	gEnv->pCryPak->FClose(pFile);
+
+	uint32 magic = 0, version = 0;
+	m_readOffset = 0;
+	if (readSize != m_data.size() || !ReadValue(m_data, m_readOffset, magic) || !ReadValue(m_data, m_readOffset, version)
+		|| magic != InputRecordingMagic || version != InputRecordingVersion)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_ERROR, "[InputRecorder] %s is not a version %u input recording", filePath.c_str(), InputRecordingVersion);
+		m_data.clear();
+		return false;
+	}
+
+	m_replayFrameTimes.clear();
+	m_currentFrameId = -1;
+	m_mode = EMode::Replaying;
+	CryLogAlways("[InputRecorder] Replaying %s", m_name.c_str());
+	return true;
+}
+
+void CInputRecorder::Stop()
+{
+	switch (m_mode)
+	{
+	case EMode::Recording:
+		WriteRecording();
+		break;
+	case EMode::Replaying:
+		WriteReplayTimings();
+		break;
+	default:
+		break;
+	}
+
+	m_mode = EMode::Off;
+	m_data.clear();
+	m_currentEvents.clear();
+}
+
+float CInputRecorder::ProcessPlayerInput(InputEventQueue& inputEvents, float frameTime)
+{
+	if (m_mode == EMode::Off)
+		return frameTime;
+
+	// With several players in the level every player sees the same input, so only the first one per frame is recorded
+	const int frameId = gEnv->nMainFrameID;
+	const bool isNewFrame = frameId != m_currentFrameId;
+	m_currentFrameId = frameId;
+
+	if (m_mode == EMode::Recording)
+	{
+		if (isNewFrame)
+		{
+			RecordFrame(inputEvents, frameTime);
+		}
+		return frameTime;
+	}
+
+	if (isNewFrame && !ReadFrame())
+	{
+		// Out of frames, hand control back to live input
+		Stop();
+		if (m_quitAfterReplay != 0)
+		{
+			gEnv->pConsole->ExecuteString("quit", false, true);
+		}
+		return frameTime;
+	}
+
+	inputEvents.Clear();
+	for (const PlayerKernels::SInputEvent& inputEvent : m_currentEvents)
+	{
+		inputEvents.Push(inputEvent.action, inputEvent.activationMode, inputEvent.value);
+	}
+	return m_currentFrame.frameTime;
+}
+
+float CInputRecorder::GetSimulationFrameTime(float frameTime) const
+{
+	if (m_mode != EMode::Replaying)
+		return frameTime;
+
+	if (m_currentFrameId == gEnv->nMainFrameID)
+		return m_currentFrame.frameTime;
+
+	// Peek at the frame the first player will read, a replay that is out of frames hands back to the live frame time
+	size_t readOffset = m_readOffset;
+	float recordedFrameTime = frameTime;
+	return ReadValue(m_data, readOffset, recordedFrameTime) ? recordedFrameTime : frameTime;
+}
+
+bool CInputRecorder::GetMousePosition(float& mouseX, float& mouseY) const
+{
+	if (m_mode == EMode::Replaying && m_currentFrameId == gEnv->nMainFrameID)
+	{
+		mouseX = m_currentFrame.mouseX * static_cast<float>(gEnv->pRenderer->GetWidth());
+		mouseY = m_currentFrame.mouseY * static_cast<float>(gEnv->pRenderer->GetHeight());
+		return true;
+	}
+
+	if (gEnv->pHardwareMouse == nullptr)
+		return false;
+
+	gEnv->pHardwareMouse->GetHardwareMouseClientPosition(&mouseX, &mouseY);
+	return true;
+}
+
+void CInputRecorder::Update(float frameTime)
+{
+	// Frames before the first player consumed recorded input, such as the level load, are not part of the replay
+	if (m_mode == EMode::Replaying && m_currentFrameId != -1)
+	{
+		m_replayFrameTimes.push_back(gEnv->pTimer->GetRealFrameTime());
+	}
+}
+
+void CInputRecorder::RecordFrame(const InputEventQueue& inputEvents, float frameTime)
+{
+	// The players read the same mouse position later in this frame
+	float mouseX = 0.f, mouseY = 0.f;
+	if (gEnv->pHardwareMouse != nullptr && gEnv->pRenderer != nullptr)
+	{
+		gEnv->pHardwareMouse->GetHardwareMouseClientPosition(&mouseX, &mouseY);
+		mouseX /= static_cast<float>(max(gEnv->pRenderer->GetWidth(), 1));
+		mouseY /= static_cast<float>(max(gEnv->pRenderer->GetHeight(), 1));
+	}
+
+	AppendValue(m_data, frameTime);
+	AppendValue(m_data, mouseX);
+	AppendValue(m_data, mouseY);
+	AppendValue(m_data, static_cast<uint16>(inputEvents.GetCount()));
+
+	for (uint32 i = 0; i < inputEvents.GetCount(); ++i)
+	{
+		const PlayerKernels::SInputEvent& inputEvent = inputEvents.GetEvent(i);
+		AppendValue(m_data, static_cast<uint8>(inputEvent.action));
+		AppendValue(m_data, inputEvent.activationMode);
+		AppendValue(m_data, inputEvent.value);
+	}
+}
+
+bool CInputRecorder::ReadFrame()
+{
+	if (!ReadValue(m_data, m_readOffset, m_currentFrame.frameTime) || !ReadValue(m_data, m_readOffset, m_currentFrame.mouseX)
+		|| !ReadValue(m_data, m_readOffset, m_currentFrame.mouseY) || !ReadValue(m_data, m_readOffset, m_currentFrame.eventCount))
+		return false;
+
+	// A corrupt event count must not resize the event list past what the recording can hold
+	if (m_readOffset + m_currentFrame.eventCount * SerializedEventSize > m_data.size())
+		return false;
+
+	m_currentEvents.resize(m_currentFrame.eventCount);
+	for (PlayerKernels::SInputEvent& inputEvent : m_currentEvents)
+	{
+		uint8 action = 0;
+		if (!ReadValue(m_data, m_readOffset, action) || !ReadValue(m_data, m_readOffset, inputEvent.activationMode) || !ReadValue(m_data, m_readOffset, inputEvent.value))
+			return false;
+
+		if (action >= static_cast<uint8>(PlayerKernels::EInputAction::Count))
+			return false;
+
+		inputEvent.action = static_cast<PlayerKernels::EInputAction>(action);
+	}
+	return true;
+}
+
+void CInputRecorder::WriteRecording() const
+{
+	gEnv->pCryPak->MakeDir("%USER%/InputRecordings");
+	const string filePath = GetInputRecordingPath(m_name, ".inrec");
+
+	if (FILE* pFile = gEnv->pCryPak->FOpen(filePath.c_str(), "wb"))
+	{
+		gEnv->pCryPak->FWrite(m_data.data(), 1, m_data.size(), pFile);
+		gEnv->pCryPak->FClose(pFile);
+		CryLogAlways("[InputRecorder] Wrote %u bytes to %s", static_cast<uint32>(m_data.size()), filePath.c_str());
+	}
+	else
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_ERROR, "[InputRecorder] Could not write %s", filePath.c_str());
+	}
+}
+
+void CInputRecorder::WriteReplayTimings() const
+{
+	gEnv->pCryPak->MakeDir("%USER%/InputRecordings");
+	const string filePath = GetInputRecordingPath(m_name, ".frames.csv");
+
+	FILE* pFile = gEnv->pCryPak->FOpen(filePath.c_str(), "wt");
+	if (pFile == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_ERROR, "[InputRecorder] Could not write %s", filePath.c_str());
+		return;
+	}
+
+	// One line per replayed frame, so two builds' files can be diffed or plotted frame by frame
+	string line = "frame,frame_ms\n";
+	gEnv->pCryPak->FWrite(line.c_str(), line.length(), 1, pFile);
+	for (size_t i = 0; i < m_replayFrameTimes.size(); ++i)
+	{
+		line.Format("%u,%.4f\n", static_cast<uint32>(i), m_replayFrameTimes[i] * 1000.f);
+		gEnv->pCryPak->FWrite(line.c_str(), line.length(), 1, pFile);
+	}
+	gEnv->pCryPak->FClose(pFile);
+	CryLogAlways("[InputRecorder] Replayed %u frames, timings written to %s", static_cast<uint32>(m_replayFrameTimes.size()), filePath.c_str());
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Core/InputEventQueue.h"
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Records the input reaching the players to a compact binary file and replays it in place of live input.
+// Every frame stores its frame time, the mouse position and the queued input events, so a replay drives the
+// players through the same actions, aim and time steps. While replaying, the real frame time of every frame is written
+// next to the recording so that two builds can be compared frame by frame.
+////////////////////////////////////////////////////////
+class CInputRecorder
+{
+public:
+	enum class EMode
+	{
+		Off = 0,
+		Recording,
+		Replaying
+	};
+
+	// The players' input queue, replayed frames must fit into it.
+	typedef PlayerKernels::TPlayerInputEventQueue InputEventQueue;
+
+	CInputRecorder() = default;
+	~CInputRecorder();
+
+	// Registers the record and replay commands, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	void StartRecording(const char* szName);
+	bool StartReplay(const char* szName);
+	// Stops recording or replaying and writes the recording or the replay timings to disk.
+	void Stop();
+
+	EMode GetMode() const { return m_mode; }
+
+	// Called by every player before it drains its input queue.
+	// While recording the queue is captured, while replaying it is replaced with the recorded events.
+	// Returns the frame time the player should simulate with.
+	float ProcessPlayerInput(InputEventQueue& inputEvents, float frameTime);
+	// The frame time the players simulate this frame with, the recorded one while replaying.
+	// Lets the simulation clock advance before the players consumed the frame.
+	float GetSimulationFrameTime(float frameTime) const;
+	// The mouse client position the players aim with, the recorded one while replaying so that the live mouse
+	// does not steer the replay. Returns false if there is no mouse to read.
+	bool GetMousePosition(float& mouseX, float& mouseY) const;
+
+	// Samples the real frame time of a replayed frame and ends the replay once every frame was played.
+	void Update(float frameTime);
+
+private:
+	struct SFrameHeader
+	{
+		float frameTime;
+		// Stored relative to the window size, so a replay aims the same in a differently sized window.
+		float mouseX;
+		float mouseY;
+		uint16 eventCount;
+	};
+
+	// Events are stored without padding, 6 bytes each.
+	static const size_t SerializedEventSize = sizeof(uint8) + sizeof(uint8) + sizeof(float);
+
+	void RecordFrame(const InputEventQueue& inputEvents, float frameTime);
+	bool ReadFrame();
+	void WriteRecording() const;
+	void WriteReplayTimings() const;
+
+	EMode m_mode = EMode::Off;
+	string m_name;
+
+	// Serialized frames, kept in memory so that recording does no file access during gameplay.
+	std::vector<uint8> m_data;
+	size_t m_readOffset = 0;
+
+	// The frame being recorded or replayed, every player in one main frame shares it.
+	int m_currentFrameId = -1;
+	SFrameHeader m_currentFrame = {};
+	std::vector<PlayerKernels::SInputEvent> m_currentEvents;
+
+	std::vector<float> m_replayFrameTimes;
+	// Quits when a replay finishes, for automated runs on the dedicated server.
+	int m_quitAfterReplay = 0;
+};
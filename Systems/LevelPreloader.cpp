@@ -0,0 +1,252 @@
+#include "StdAfx.h"
+#include "LevelPreloader.h"
+#include "GamePlugin.h"
+#include <ILevelSystem.h>
+
+namespace
+{
+	// Level files read ahead of the switch, relative to the level folder.
+	// Together they hold the level's entities, terrain and most of its geometry and textures.
+	const char* const PreloadedLevelFiles[] =
+	{
+		"level.pak",
+		"terraintexture.pak"
+	};
+
+	// Size of each read, the files are read one chunk after another instead of in one piece
+	const uint32 PreloadChunkSize = 1024 * 1024;
+
+	void PreloadLevelCommand(IConsoleCmdArgs* pArgs)
+	{
+		if (pArgs->GetArgCount() > 1)
+		{
+			CGamePlugin::GetInstance()->GetLevelPreloader().RequestPreload(pArgs->GetArg(1));
+		}
+	}
+
+	void SwitchLevelCommand(IConsoleCmdArgs* pArgs)
+	{
+		if (pArgs->GetArgCount() > 1)
+		{
+			CGamePlugin::GetInstance()->GetLevelPreloader().RequestSwitch(pArgs->GetArg(1));
+		}
+	}
+}
+
+CLevelPreloader::~CLevelPreloader()
+{
+	CancelStreams();
+
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->RemoveCommand("g_levelPreload");
+		gEnv->pConsole->RemoveCommand("g_levelSwitch");
+	}
+}
+
+void CLevelPreloader::RegisterCVars()
+{
+	REGISTER_COMMAND("g_levelPreload", PreloadLevelCommand, VF_NULL, "Streams a level's files in the background. Usage: g_levelPreload <level>");
+	REGISTER_COMMAND("g_levelSwitch", SwitchLevelCommand, VF_NULL, "Switches to a level once its files are resident. Usage: g_levelSwitch <level>");
+}
+
+bool CLevelPreloader::RequestPreload(const char* szLevelName)
+{
+	if (m_state != EState::Idle && m_levelName.compareNoCase(szLevelName) == 0)
+		return true;
+
+	ILevelSystem* pLevelSystem = gEnv->pGameFramework->GetILevelSystem();
+	ILevelInfo* pLevelInfo = pLevelSystem->GetLevelInfo(szLevelName);
+	if (pLevelInfo == nullptr)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "[LevelPreloader] Unknown level %s", szLevelName);
+		return false;
+	}
+
+	CancelStreams();
+	m_levelName = szLevelName;
+	m_isSwitchPending = false;
+	m_completedFiles = 0;
+	m_streamedBytes = 0;
+	m_preloadStartTime = gEnv->pTimer->GetAsyncTime();
+
+	// Let the level system open the level's packs and prepare its resource lists
+	pLevelSystem->PrepareNextLevel(szLevelName);
+
+	for (const char* szFileName : PreloadedLevelFiles)
+	{
+		SPreloadFile file;
+		file.path = PathUtil::Make(pLevelInfo->GetPath(), szFileName);
+		file.size = gEnv->pCryPak->FGetSize(file.path.c_str(), true);
+		if (file.size == 0)
+			continue;
+
+		file.chunk.resize(min(file.size, PreloadChunkSize));
+		m_files.push_back(std::move(file));
+	}
+
+	// Files whose first read could not be started count as done, they are simply loaded by the map command
+	for (uint32 i = 0; i < m_files.size(); ++i)
+	{
+		if (!ReadNextChunk(i))
+		{
+			++m_completedFiles;
+		}
+	}
+
+	m_state = m_completedFiles == m_files.size() ? EState::Resident : EState::Streaming;
+	CryLogAlways("[LevelPreloader] Preloading %s, %u files", m_levelName.c_str(), static_cast<uint32>(m_files.size()));
+	if (m_state == EState::Resident)
+	{
+		m_files.clear();
+		LogPhase("resident", m_preloadStartTime);
+	}
+	return true;
+}
+
+void CLevelPreloader::RequestSwitch(const char* szLevelName)
+{
+	if (m_isSwitchPending || m_isSwitching)
+		return;
+
+	if (!RequestPreload(szLevelName))
+		return;
+
+	m_isSwitchPending = true;
+	m_switchRequestTime = gEnv->pTimer->GetAsyncTime();
+	LogPhase("switch requested", m_preloadStartTime);
+}
+
+void CLevelPreloader::Update()
+{
+	if (!m_isSwitchPending || m_state != EState::Resident)
+		return;
+
+	m_isSwitchPending = false;
+	m_isSwitching = true;
+	LogPhase("switch issued, waited for preload", m_switchRequestTime);
+
+	// Deferred so that the load starts at the beginning of the next frame and not in the middle of entity updates
+	string command;
+	command.Format("map %s", m_levelName.c_str());
+	gEnv->pConsole->ExecuteString(command.c_str(), false, true);
+}
+
+void CLevelPreloader::OnLevelLoadStart()
+{
+	m_loadStartTime = gEnv->pTimer->GetAsyncTime();
+}
+
+void CLevelPreloader::OnLevelLoadEnd()
+{
+	m_loadEndTime = gEnv->pTimer->GetAsyncTime();
+	if (m_isSwitching)
+	{
+		LogPhase("level loaded, blocking load took", m_loadStartTime);
+	}
+}
+
+void CLevelPreloader::OnGameplayStart()
+{
+	if (!m_isSwitching)
+		return;
+
+	LogPhase("gameplay started, level start took", m_loadEndTime);
+	LogPhase("transition complete", m_preloadStartTime);
+	m_isSwitching = false;
+	m_state = EState::Idle;
+	m_levelName.clear();
+}
+
+void CLevelPreloader::OnLevelLoadError()
+{
+	if (!m_isSwitching)
+		return;
+
+	LogPhase("level failed to load after", m_loadStartTime);
+	m_isSwitching = false;
+	m_state = EState::Idle;
+	m_levelName.clear();
+}
+
+void CLevelPreloader::Reset()
+{
+	// The level we are switching to is loaded after this unload, keep its state so that its timings are logged
+	if (m_isSwitching)
+		return;
+
+	CancelStreams();
+	m_state = EState::Idle;
+	m_levelName.clear();
+	m_isSwitchPending = false;
+}
+
+void CLevelPreloader::StreamOnComplete(IReadStream* pStream, unsigned nError)
+{
+	// Streams cancelled by CancelStreams are already forgotten
+	if (nError == ERROR_USER_ABORT)
+		return;
+
+	const uint32 fileIndex = static_cast<uint32>(pStream->GetUserData());
+	if (fileIndex >= m_files.size() || m_files[fileIndex].pStream != pStream)
+		return;
+
+	SPreloadFile& file = m_files[fileIndex];
+	file.pStream = nullptr;
+	if (nError != 0)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "[LevelPreloader] Could not read %s, error %u", pStream->GetName(), nError);
+	}
+	else
+	{
+		// The data itself is not kept, reading it is what moves it into the disk cache
+		m_streamedBytes += pStream->GetBytesRead();
+		file.offset += pStream->GetBytesRead();
+		if (file.offset < file.size && pStream->GetBytesRead() > 0 && ReadNextChunk(fileIndex))
+			return;
+	}
+
+	if (++m_completedFiles == m_files.size() && m_state == EState::Streaming)
+	{
+		m_state = EState::Resident;
+		m_files.clear();
+		CryLogAlways("[LevelPreloader] %s: %.1f MB streamed", m_levelName.c_str(), m_streamedBytes / (1024.f * 1024.f));
+		LogPhase("resident", m_preloadStartTime);
+	}
+}
+
+bool CLevelPreloader::ReadNextChunk(uint32 fileIndex)
+{
+	SPreloadFile& file = m_files[fileIndex];
+
+	// Read the level files at a low priority so that the current level's streaming is not held up
+	StreamReadParams readParams;
+	readParams.dwUserData = fileIndex;
+	readParams.ePriority = estpBelowNormal;
+	readParams.pBuffer = file.chunk.data();
+	readParams.nOffset = file.offset;
+	readParams.nSize = min(file.size - file.offset, static_cast<uint32>(file.chunk.size()));
+
+	file.pStream = gEnv->pSystem->GetStreamEngine()->StartRead(eStreamTaskTypePak, file.path.c_str(), this, &readParams);
+	return file.pStream != nullptr;
+}
+
+void CLevelPreloader::CancelStreams()
+{
+	// Aborted reads complete with ERROR_USER_ABORT, which StreamOnComplete ignores
+	for (SPreloadFile& file : m_files)
+	{
+		if (file.pStream)
+		{
+			file.pStream->Abort();
+		}
+	}
+	m_files.clear();
+	m_completedFiles = 0;
+}
+
+void CLevelPreloader::LogPhase(const char* szPhase, const CTimeValue& since) const
+{
+	const float milliseconds = (gEnv->pTimer->GetAsyncTime() - since).GetMilliSeconds();
+	CryLogAlways("[LevelPreloader] %s: %s %.1f ms", m_levelName.c_str(), szPhase, milliseconds);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <CrySystem/IStreamEngine.h>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Streams the files of the next level in the background and switches to it once they are resident.
+// Level change triggers request the preload when a player approaches and the switch when the player enters,
+// so the blocking part of the map load mostly reads files that are already in the disk cache. The files are read in
+// bounded chunks that are thrown away, so the preload does not hold the level in memory itself.
+// Every phase of the transition is timed and logged.
+////////////////////////////////////////////////////////
+class CLevelPreloader : public IStreamCallback
+{
+public:
+	enum class EState
+	{
+		Idle = 0,
+		// The level files are being read in the background.
+		Streaming,
+		// Every level file finished reading, switching now does not wait for the disk.
+		Resident
+	};
+
+	CLevelPreloader() = default;
+	virtual ~CLevelPreloader();
+
+	// Registers the preload commands, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Starts streaming the level's files, does nothing if that level is already streaming or resident.
+	bool RequestPreload(const char* szLevelName);
+	// Switches to the level as soon as its files are resident, starting the preload if nobody requested it yet.
+	void RequestSwitch(const char* szLevelName);
+
+	EState GetState() const { return m_state; }
+	const string& GetLevelName() const { return m_levelName; }
+
+	// Issues the pending switch once the level is resident.
+	void Update();
+
+	// Level load timings, forwarded from the plug-in's system events.
+	void OnLevelLoadStart();
+	void OnLevelLoadEnd();
+	void OnGameplayStart();
+	// Drops finished or pending preloads, called when the level unloads.
+	void Reset();
+
+	// Forgets the switch if the map load failed, so that the next switch is not blocked by it.
+	void OnLevelLoadError();
+
+	// IStreamCallback
+	virtual void StreamOnComplete(IReadStream* pStream, unsigned nError) override;
+
+private:
+	// A level file read in fixed size chunks, so that only one chunk per file is held in memory at a time.
+	struct SPreloadFile
+	{
+		string path;
+		uint32 size = 0;
+		uint32 offset = 0;
+		IReadStreamPtr pStream;
+		// Every chunk is read into this, the data itself is not kept.
+		std::vector<uint8> chunk;
+	};
+
+	// Starts reading the file's next chunk, returns false if the read could not be started.
+	bool ReadNextChunk(uint32 fileIndex);
+	void CancelStreams();
+	void LogPhase(const char* szPhase, const CTimeValue& since) const;
+
+	EState m_state = EState::Idle;
+	string m_levelName;
+	bool m_isSwitchPending = false;
+	// Set once the map command was issued, so that the level load timings belong to this transition.
+	bool m_isSwitching = false;
+
+	std::vector<SPreloadFile> m_files;
+	uint32 m_completedFiles = 0;
+	uint64 m_streamedBytes = 0;
+
+	CTimeValue m_preloadStartTime;
+	CTimeValue m_switchRequestTime;
+	CTimeValue m_loadStartTime;
+	CTimeValue m_loadEndTime;
+};
@@ -0,0 +1,144 @@
+#include "StdAfx.h"
+#include "PlayerUpdateSystem.h"
+#include "GamePlugin.h"
+#include "GameplayProfiler.h"
+#include "Components/Player.h"
+#include "Core/PlayerKernels.h"
+#include <algorithm>
+
+namespace
+{
+	// The entity flag is set when the player's entity is spawned, so it does not change while the player is registered
+	bool IsRemotePlayer(const CPlayerComponent& player)
+	{
+		return (player.GetEntity()->GetFlags() & ENTITY_FLAG_LOCAL_PLAYER) == 0;
+	}
+
+	void LogPlayerUpdateStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CPlayerUpdateSystem& playerUpdateSystem = CGamePlugin::GetInstance()->GetPlayerUpdateSystem();
+		playerUpdateSystem.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			playerUpdateSystem.ResetStatistics();
+		}
+	}
+}
+
+CPlayerUpdateSystem::~CPlayerUpdateSystem()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_playerJobUpdate", true);
+		gEnv->pConsole->UnregisterVariable("g_playerJobMinPlayers", true);
+		gEnv->pConsole->RemoveCommand("g_playerUpdateStats");
+	}
+}
+
+void CPlayerUpdateSystem::RegisterCVars()
+{
+	REGISTER_CVAR2("g_playerJobUpdate", &m_isEnabled, m_isEnabled, VF_NULL, "Computes the player updates in parallel on the job system\n0: Every player updates itself on the main thread\n1: Read, compute in jobs, then write back in order");
+	REGISTER_CVAR2("g_playerJobMinPlayers", &m_minPlayersPerJob, m_minPlayersPerJob, VF_NULL, "Players one job computes at least, fewer players are computed on the main thread");
+	REGISTER_COMMAND("g_playerUpdateStats", LogPlayerUpdateStatsCommand, VF_NULL, "Prints the players, jobs and main thread time per pass of the player update. Pass 'reset' to clear the counters afterwards");
+}
+
+void CPlayerUpdateSystem::RegisterPlayer(CPlayerComponent* pPlayer)
+{
+	if (std::find(m_players.begin(), m_players.end(), pPlayer) == m_players.end())
+	{
+		m_players.push_back(pPlayer);
+		m_remotePlayerCount += IsRemotePlayer(*pPlayer) ? 1 : 0;
+	}
+}
+
+void CPlayerUpdateSystem::UnregisterPlayer(CPlayerComponent* pPlayer)
+{
+	auto it = std::find(m_players.begin(), m_players.end(), pPlayer);
+	if (it != m_players.end())
+	{
+		m_remotePlayerCount -= IsRemotePlayer(*pPlayer) ? 1 : 0;
+		m_players.erase(it);
+	}
+}
+
+void CPlayerUpdateSystem::Update(float frameTime)
+{
+	if (m_isEnabled == 0 || m_players.empty())
+		return;
+	// Entity updates stop while the game is paused and in the editor outside game mode, and so do the players
+	if (CGamePlugin::GetInstance()->IsGameplayPaused())
+		return;
+
+	GAMEPLAY_PROFILE_SCOPE(PlayerJobUpdate);
+
+	// Input, shots and engine reads stay on the main thread
+	const int64 prepareStart = CryGetTicks();
+	m_updatedPlayers.clear();
+	for (CPlayerComponent* pPlayer : m_players)
+	{
+		if (pPlayer->PrepareUpdate(frameTime))
+		{
+			m_updatedPlayers.push_back(pPlayer);
+		}
+	}
+
+	// One batch per worker at most, the main thread computes the last batch instead of waiting idle
+	const int64 computeStart = CryGetTicks();
+	const uint32 playerCount = static_cast<uint32>(m_updatedPlayers.size());
+	const uint32 maxBatches = min(gEnv->pJobManager->GetNumWorkerThreads(), MaxJobs) + 1;
+	const uint32 batchCount = PlayerKernels::ComputeBatchCount(playerCount, static_cast<uint32>(max(m_minPlayersPerJob, 1)), maxBatches);
+	{
+		// Timed on the main thread from the first job to the last one finishing, the profiler is not used by the workers
+		GAMEPLAY_PROFILE_SCOPE(PlayerJobCompute);
+		for (uint32 batch = 0; batch + 1 < batchCount; ++batch)
+		{
+			gEnv->pJobManager->AddLambdaJob("PlayerUpdate", [this, batch, batchCount]() { ComputeBatch(batch, batchCount); }, JobManager::eRegularPriority, &m_jobStates[batch]);
+		}
+		if (batchCount > 0)
+		{
+			ComputeBatch(batchCount - 1, batchCount);
+		}
+		for (uint32 batch = 0; batch + 1 < batchCount; ++batch)
+		{
+			gEnv->pJobManager->WaitForJob(m_jobStates[batch]);
+		}
+	}
+
+	// Engine writes in registration order, the same order the players updated themselves in
+	const int64 applyStart = CryGetTicks();
+	for (CPlayerComponent* pPlayer : m_updatedPlayers)
+	{
+		pPlayer->ApplyUpdate();
+	}
+
+	const int64 applyEnd = CryGetTicks();
+	++m_statistics.frames;
+	m_statistics.players += playerCount;
+	m_statistics.jobs += batchCount > 0 ? batchCount - 1 : 0;
+	m_statistics.prepareTicks += computeStart - prepareStart;
+	m_statistics.computeTicks += applyStart - computeStart;
+	m_statistics.applyTicks += applyEnd - applyStart;
+}
+
+void CPlayerUpdateSystem::LogStatistics() const
+{
+	const float frames = static_cast<float>(max(m_statistics.frames, 1u));
+	const float millisecondsPerTick = 1000.f / static_cast<float>(CryGetTicksPerSec());
+	CryLogAlways("[PlayerUpdate] %s, players %u, frames %u, %.1f players and %.1f jobs per frame",
+		IsEnabled() ? "job update" : "entity update", static_cast<uint32>(m_players.size()), m_statistics.frames,
+		m_statistics.players / frames, m_statistics.jobs / frames);
+	CryLogAlways("[PlayerUpdate] main thread per frame: prepare %.3f ms, compute %.3f ms, apply %.3f ms",
+		m_statistics.prepareTicks * millisecondsPerTick / frames, m_statistics.computeTicks * millisecondsPerTick / frames,
+		m_statistics.applyTicks * millisecondsPerTick / frames);
+}
+
+void CPlayerUpdateSystem::ComputeBatch(uint32 batch, uint32 batchCount)
+{
+	uint32 begin, end;
+	PlayerKernels::GetBatchRange(static_cast<uint32>(m_updatedPlayers.size()), batchCount, batch, begin, end);
+	for (uint32 i = begin; i < end; ++i)
+	{
+		m_updatedPlayers[i]->ComputeUpdate();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <CryThreading/IJobManager.h>
+#include <array>
+#include <vector>
+
+class CPlayerComponent;
+
+////////////////////////////////////////////////////////
+// Updates every player in three passes instead of one entity at a time.
+// The main thread applies input and reads engine state for every player, then the pure computation of all
+// players (velocity, cursor ray, camera and remote interpolation) runs as a parallel for over batches of
+// players on the engine's job system, and finally the engine writes are applied in registration order on
+// the main thread. With g_playerJobUpdate off the players update themselves from their entity update event.
+////////////////////////////////////////////////////////
+class CPlayerUpdateSystem
+{
+public:
+	struct SStatistics
+	{
+		uint32 frames = 0;
+		uint64 players = 0;
+		uint64 jobs = 0;
+		// Main thread time of each pass, the compute pass includes waiting for the jobs.
+		int64 prepareTicks = 0;
+		int64 computeTicks = 0;
+		int64 applyTicks = 0;
+	};
+
+	CPlayerUpdateSystem() = default;
+	~CPlayerUpdateSystem();
+
+	// Registers the job update CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Players are applied in registration order.
+	void RegisterPlayer(CPlayerComponent* pPlayer);
+	void UnregisterPlayer(CPlayerComponent* pPlayer);
+	// Registered players that are not controlled by this machine.
+	uint32 GetRemotePlayerCount() const { return m_remotePlayerCount; }
+
+	// True if the players are updated by this system instead of by their own update event.
+	bool IsEnabled() const { return m_isEnabled != 0; }
+	void Update(float frameTime);
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	// Jobs per frame at most, the main thread computes one more batch itself.
+	static constexpr uint32 MaxJobs = 32;
+
+	void ComputeBatch(uint32 batch, uint32 batchCount);
+
+	std::vector<CPlayerComponent*> m_players;
+	uint32 m_remotePlayerCount = 0;
+	// Players that passed the prepare pass this frame, computed and applied in this order.
+	std::vector<CPlayerComponent*> m_updatedPlayers;
+	std::array<JobManager::SJobState, MaxJobs> m_jobStates;
+	SStatistics m_statistics;
+
+	int m_isEnabled = 1;
+	int m_minPlayersPerJob = 16;
+};
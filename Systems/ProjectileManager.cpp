@@ -0,0 +1,128 @@
+#include "StdAfx.h"
+#include "ProjectileManager.h"
+#include "GameplayMemory.h"
+#include "Components/ProjectileTypes.h"
+#include "GameplayProfiler.h"
+#include <algorithm>
+
+IEntity* CProjectileManager::Spawn(EProjectileType type, const QuatTS& origin, float age, bool isReplicatedCopy)
+{
+	GAMEPLAY_PROFILE_SCOPE(ProjectileSpawn);
+	if (!m_entityIds.IsAttached())
+	{
+		AttachLevelStorage();
+	}
+	// Only happens if the pool could not get its level storage either
+	if (m_entityIds.full())
+		return nullptr;
+
+	IEntity* pEntity = m_pool.Acquire(type, origin, isReplicatedCopy, age);
+	if (pEntity == nullptr)
+		return nullptr;
+
+	m_lifetimes.push_back(GetLifetime(type) - age);
+	m_types.push_back(type);
+	m_entityIds.push_back(pEntity->GetId());
+
+	if (CGameplayProfiler* pProfiler = CGameplayProfiler::Get())
+	{
+		pProfiler->CountSpawn();
+	}
+	return pEntity;
+}
+
+void CProjectileManager::Despawn(EntityId entityId)
+{
+	GAMEPLAY_PROFILE_SCOPE(ProjectileDespawn);
+	const EntityId* pEnd = m_entityIds.end();
+	const EntityId* pFound = std::find(m_entityIds.begin(), pEnd, entityId);
+	if (pFound != pEnd)
+	{
+		RemoveAt(static_cast<size_t>(pFound - m_entityIds.begin()));
+	}
+}
+
+void CProjectileManager::Update(float frameTime)
+{
+	GAMEPLAY_PROFILE_SCOPE(ProjectileUpdate);
+	const size_t count = m_lifetimes.size();
+	float* const pLifetimes = m_lifetimes.data();
+
+	// Age every projectile and count the expired ones in the same pass.
+	// Kept free of branches and calls so that the compiler can vectorize it.
+	uint32 expiredCount = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		pLifetimes[i] -= frameTime;
+		expiredCount += pLifetimes[i] <= 0.f ? 1 : 0;
+	}
+
+	if (expiredCount == 0)
+		return;
+
+	// Walk backwards so that swapping in the last element never skips an unvisited projectile
+	for (size_t i = count; i-- > 0;)
+	{
+		if (pLifetimes[i] <= 0.f)
+		{
+			RemoveAt(i);
+		}
+	}
+}
+
+void CProjectileManager::Reset()
+{
+	m_lifetimes.Detach();
+	m_types.Detach();
+	m_entityIds.Detach();
+}
+
+void CProjectileManager::AttachLevelStorage()
+{
+	m_pool.AttachLevelStorage();
+	const uint32 capacity = m_pool.GetLevelCapacity();
+	CGameplayMemory* pMemory = CGameplayMemory::Get();
+	m_lifetimes.Attach(pMemory->AllocateLevelArray<float>(EMemoryTag::ProjectileTracking, capacity), capacity);
+	m_types.Attach(pMemory->AllocateLevelArray<EProjectileType>(EMemoryTag::ProjectileTracking, capacity), capacity);
+	m_entityIds.Attach(pMemory->AllocateLevelArray<EntityId>(EMemoryTag::ProjectileTracking, capacity), capacity);
+}
+
+float CProjectileManager::GetLifetime(EProjectileType type)
+{
+	float lifetime = 0.f;
+	DispatchProjectileType(type, [&lifetime](auto traits)
+	{
+		lifetime = decltype(traits)::Lifetime;
+	});
+	return lifetime;
+}
+
+float CProjectileManager::GetLaunchSpeed(EProjectileType type)
+{
+	float launchSpeed = 0.f;
+	DispatchProjectileType(type, [&launchSpeed](auto traits)
+	{
+		launchSpeed = CProjectileComponent<decltype(traits)>::LaunchSpeed;
+	});
+	return launchSpeed;
+}
+
+void CProjectileManager::RemoveAt(size_t index)
+{
+	m_pool.Release(m_types[index], m_entityIds[index]);
+
+	// Swap with the last projectile to keep the arrays contiguous
+	const size_t last = m_entityIds.size() - 1;
+	m_lifetimes[index] = m_lifetimes[last];
+	m_types[index] = m_types[last];
+	m_entityIds[index] = m_entityIds[last];
+
+	m_lifetimes.pop_back();
+	m_types.pop_back();
+	m_entityIds.pop_back();
+
+	if (CGameplayProfiler* pProfiler = CGameplayProfiler::Get())
+	{
+		pProfiler->CountRemove();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ProjectilePool.h"
+#include "Core/GameplayMemory.h"
+
+////////////////////////////////////////////////////////
+// Owns every projectile in flight.
+// Lifetime, type and entity id are kept in parallel contiguous arrays so that all projectiles are aged in a single
+// loop per frame and expired projectiles are returned to the pool in one batch, instead of every bullet receiving
+// its own Update event.
+////////////////////////////////////////////////////////
+class CProjectileManager
+{
+public:
+	explicit CProjectileManager(CProjectilePool& pool) : m_pool(pool) {}
+
+	// Takes a projectile from the pool, launches it from the origin and starts tracking its lifetime.
+	// The age is how long ago the shot was fired, it is taken off the lifetime.
+	// Replicated copies show a shot of the server, the origin is where that shot is by now.
+	IEntity* Spawn(EProjectileType type, const QuatTS& origin, float age = 0.f, bool isReplicatedCopy = false);
+	// Stops tracking the projectile and returns it to the pool, used when a projectile is destroyed before it expires.
+	void Despawn(EntityId entityId);
+
+	// Ages all projectiles by the frame time and expires the ones whose lifetime ran out.
+	void Update(float frameTime);
+	// Forgets all tracked projectiles, called when the level unloads.
+	void Reset();
+
+	size_t GetProjectileCount() const { return m_entityIds.size(); }
+	// Seconds a projectile of the given type stays alive after being fired.
+	static float GetLifetime(EProjectileType type);
+	// Speed a projectile of the given type leaves the muzzle with.
+	static float GetLaunchSpeed(EProjectileType type);
+
+private:
+	void RemoveAt(size_t index);
+	// Takes the arrays for this level from the level arena, one entry for every entity the pool may own.
+	void AttachLevelStorage();
+
+	CProjectilePool& m_pool;
+
+	// Structure of arrays, index i of every array describes the same projectile.
+	// They live in the level arena and are detached before it is rewound.
+	MemoryKernels::TFixedArray<float> m_lifetimes;
+	MemoryKernels::TFixedArray<EProjectileType> m_types;
+	MemoryKernels::TFixedArray<EntityId> m_entityIds;
+};
@@ -0,0 +1,254 @@
+#include "StdAfx.h"
+#include "ProjectilePool.h"
+#include "GamePlugin.h"
+#include "GameplayMemory.h"
+#include "Components/ProjectileTypes.h"
+
+namespace
+{
+	const char* GetProjectileTypeName(EProjectileType type)
+	{
+		switch (type)
+		{
+		case EProjectileType::Regular: return "Regular";
+		case EProjectileType::Water: return "Water";
+		}
+		return "Unknown";
+	}
+
+	void LogProjectilePoolStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CProjectilePool& pool = CGamePlugin::GetInstance()->GetProjectilePool();
+		pool.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			pool.ResetStatistics();
+		}
+	}
+}
+
+CProjectilePool::~CProjectilePool()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_projectilePoolInitialSize", true);
+		gEnv->pConsole->UnregisterVariable("g_projectilePoolMaxSize", true);
+		gEnv->pConsole->RemoveCommand("g_projectilePoolStats");
+	}
+}
+
+void CProjectilePool::RegisterCVars()
+{
+	REGISTER_CVAR2("g_projectilePoolInitialSize", &m_initialSize, m_initialSize, VF_NULL, "Number of bullet entities spawned per projectile type when a level loads");
+	REGISTER_CVAR2("g_projectilePoolMaxSize", &m_maxSize, m_maxSize, VF_NULL, "Maximum number of bullet entities the pool may grow to per projectile type, a larger value applies from the next level on");
+	REGISTER_COMMAND("g_projectilePoolStats", LogProjectilePoolStatsCommand, VF_NULL, "Prints projectile pool hits, misses and growth. Pass 'reset' to clear the counters afterwards");
+}
+
+void CProjectilePool::Prewarm()
+{
+	AttachLevelStorage();
+	for (size_t i = 0; i < m_pools.size(); ++i)
+	{
+		const EProjectileType type = static_cast<EProjectileType>(i);
+		STypePool& pool = m_pools[i];
+
+		while (pool.size < min(static_cast<uint32>(max(m_initialSize, 0)), pool.freeEntities.capacity()))
+		{
+			IEntity* pEntity = Spawn(type);
+			if (pEntity == nullptr)
+				break;
+
+			pool.freeEntities.push_back(pEntity->GetId());
+		}
+	}
+}
+
+void CProjectilePool::Reset()
+{
+	// The free lists live in the level arena, which is rewound after this
+	for (STypePool& pool : m_pools)
+	{
+		pool.freeEntities.Detach();
+		pool.size = 0;
+	}
+}
+
+void CProjectilePool::AttachLevelStorage()
+{
+	const uint32 capacity = static_cast<uint32>(max(m_maxSize, 0));
+	for (STypePool& pool : m_pools)
+	{
+		if (!pool.freeEntities.IsAttached())
+		{
+			pool.freeEntities.Attach(CGameplayMemory::Get()->AllocateLevelArray<EntityId>(EMemoryTag::ProjectilePool, capacity), capacity);
+		}
+	}
+}
+
+uint32 CProjectilePool::GetLevelCapacity() const
+{
+	uint32 capacity = 0;
+	for (const STypePool& pool : m_pools)
+	{
+		capacity += pool.freeEntities.capacity();
+	}
+	return capacity;
+}
+
+IEntity* CProjectilePool::Acquire(EProjectileType type, const QuatTS& origin, bool isReplicatedCopy, float age)
+{
+	AttachLevelStorage();
+	STypePool& pool = m_pools[static_cast<size_t>(type)];
+	IEntity* pEntity = nullptr;
+
+	// Parked entities can be removed underneath us, for example by the editor, so skip any that no longer exist
+	while (pEntity == nullptr && !pool.freeEntities.empty())
+	{
+		const EntityId entityId = pool.freeEntities.back();
+		pool.freeEntities.pop_back();
+
+		pEntity = gEnv->pEntitySystem->GetEntity(entityId);
+		if (pEntity == nullptr)
+		{
+			CRY_ASSERT(pool.size > 0);
+			--pool.size;
+		}
+	}
+
+	if (pEntity != nullptr)
+	{
+		++pool.statistics.hits;
+	}
+	else
+	{
+		++pool.statistics.misses;
+
+		// Every entity of the pool has to fit into the free list, a larger maximum size applies from the next level on
+		if (pool.size >= min(static_cast<uint32>(max(m_maxSize, 0)), pool.freeEntities.capacity()))
+		{
+			++pool.statistics.rejected;
+			return nullptr;
+		}
+
+		pEntity = Spawn(type);
+		if (pEntity == nullptr)
+			return nullptr;
+
+		++pool.statistics.growth;
+	}
+
+	SetParked(type, *pEntity, false);
+	// Move the parked bullet to the muzzle, keeping the scale it was spawned with
+	pEntity->SetPosRotScale(origin.t, origin.q, pEntity->GetScale());
+	pEntity->Hide(false);
+
+	DispatchProjectileType(type, [pEntity, isReplicatedCopy, age](auto traits)
+	{
+		pEntity->GetComponent<CProjectileComponent<decltype(traits)>>()->Launch(isReplicatedCopy, age);
+	});
+
+	return pEntity;
+}
+
+void CProjectilePool::Release(EProjectileType type, EntityId entityId)
+{
+	if (IEntity* pEntity = gEnv->pEntitySystem->GetEntity(entityId))
+	{
+		// A bullet released twice would be on the free list twice and handed out to two shots
+		if (!SetParked(type, *pEntity, true))
+			return;
+
+		Park(*pEntity);
+		STypePool& pool = m_pools[static_cast<size_t>(type)];
+		// Cannot fail while the pool stays within the capacity of its free list
+		if (!pool.freeEntities.push_back(entityId))
+		{
+			gEnv->pEntitySystem->RemoveEntity(entityId);
+			CRY_ASSERT(pool.size > 0);
+			if (pool.size > 0)
+			{
+				--pool.size;
+			}
+		}
+	}
+}
+
+void CProjectilePool::ResetStatistics()
+{
+	for (STypePool& pool : m_pools)
+	{
+		pool.statistics = SStatistics();
+	}
+}
+
+void CProjectilePool::LogStatistics() const
+{
+	for (size_t i = 0; i < m_pools.size(); ++i)
+	{
+		const STypePool& pool = m_pools[i];
+		CryLogAlways("[ProjectilePool] %s: size %u, free %u, hits %u, misses %u, growth %u, rejected %u",
+			GetProjectileTypeName(static_cast<EProjectileType>(i)), pool.size, static_cast<uint32>(pool.freeEntities.size()),
+			pool.statistics.hits, pool.statistics.misses, pool.statistics.growth, pool.statistics.rejected);
+	}
+}
+
+IEntity* CProjectilePool::Spawn(EProjectileType type)
+{
+	SEntitySpawnParams spawnParams;
+	spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+	DispatchProjectileType(type, [&spawnParams](auto traits)
+	{
+		spawnParams.vScale = Vec3(decltype(traits)::Scale);
+	});
+	// Pooled bullets belong to the level, they must never be saved with it
+	spawnParams.nFlags = ENTITY_FLAG_NO_SAVE;
+
+	IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams);
+	if (pEntity == nullptr)
+		return nullptr;
+
+	// Initialize loads the geometry and material and physicalizes the bullet once for the lifetime of the pool
+	DispatchProjectileType(type, [pEntity](auto traits)
+	{
+		pEntity->CreateComponentClass<CProjectileComponent<decltype(traits)>>();
+	});
+
+	Park(*pEntity);
+	SetParked(type, *pEntity, true);
+	++m_pools[static_cast<size_t>(type)].size;
+	return pEntity;
+}
+
+bool CProjectilePool::SetParked(EProjectileType type, IEntity& entity, bool isParked)
+{
+	bool isChanged = false;
+	DispatchProjectileType(type, [&entity, isParked, &isChanged](auto traits)
+	{
+		if (auto* pProjectile = entity.GetComponent<CProjectileComponent<decltype(traits)>>())
+		{
+			isChanged = pProjectile->IsParked() != isParked;
+			pProjectile->SetParked(isParked);
+		}
+	});
+	return isChanged;
+}
+
+void CProjectilePool::Park(IEntity& entity)
+{
+	if (IPhysicalEntity* pPhysics = entity.GetPhysics())
+	{
+		// Stop any motion left over from the last shot
+		pe_action_set_velocity setVelocity;
+		setVelocity.v = ZERO;
+		setVelocity.w = ZERO;
+		pPhysics->Action(&setVelocity);
+
+		// Put the rigid body to sleep so that the physics step skips it until it is fired again
+		pe_action_awake awake;
+		awake.bAwake = 0;
+		pPhysics->Action(&awake);
+	}
+
+	entity.Hide(true);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <CryEntitySystem/IEntitySystem.h>
+#include "Core/GameplayMemory.h"
+#include <array>
+
+// Every projectile type that can be fired by the player.
+enum class EProjectileType : uint8
+{
+	Regular = 0,
+	Water,
+	Count
+};
+
+////////////////////////////////////////////////////////
+// Keeps physicalized bullet entities alive between shots.
+// Pooled entities are hidden and put to sleep while unused and handed back out with a new transform and impulse,
+// so firing no longer spawns, physicalizes and removes an entity per shot.
+////////////////////////////////////////////////////////
+class CProjectilePool
+{
+public:
+	// Counters for a single projectile type.
+	struct SStatistics
+	{
+		// Acquires that were served from the free list.
+		uint32 hits = 0;
+		// Acquires that found the free list empty.
+		uint32 misses = 0;
+		// Entities spawned after the initial prewarm because of a miss.
+		uint32 growth = 0;
+		// Acquires that failed because the pool reached its maximum size.
+		uint32 rejected = 0;
+	};
+
+	CProjectilePool() = default;
+	~CProjectilePool();
+
+	// Registers the pool size CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+	// Spawns the initial set of pooled entities for every projectile type, called on level load.
+	void Prewarm();
+	// Forgets all pooled entities, the entity system removes them itself when the level unloads.
+	void Reset();
+	// Takes the free lists for this level from the level arena, sized for the maximum pool size. Does nothing if
+	// they already exist, called before the first entity of the level is pooled.
+	void AttachLevelStorage();
+	// Entities all pools together may hold in this level.
+	uint32 GetLevelCapacity() const;
+
+	// Hands out a parked projectile at the origin and launches it. Returns nullptr if the pool is exhausted.
+	// Replicated copies show a shot fired the age ago and get the velocity it has by now.
+	IEntity* Acquire(EProjectileType type, const QuatTS& origin, bool isReplicatedCopy = false, float age = 0.f);
+	// Hides and sleeps the projectile so that it can be handed out again.
+	void Release(EProjectileType type, EntityId entityId);
+
+	const SStatistics& GetStatistics(EProjectileType type) const { return m_pools[static_cast<size_t>(type)].statistics; }
+	void ResetStatistics();
+	void LogStatistics() const;
+
+private:
+	struct STypePool
+	{
+		// Parked entities that are ready to be fired, its capacity is the most entities the pool may own this level.
+		MemoryKernels::TFixedArray<EntityId> freeEntities;
+		// Total number of entities owned by this pool, parked or in flight.
+		uint32 size = 0;
+		SStatistics statistics;
+	};
+
+	IEntity* Spawn(EProjectileType type);
+	static void Park(IEntity& entity);
+	// Marks the pooled entity as parked or in flight, returns false if it already was.
+	static bool SetParked(EProjectileType type, IEntity& entity, bool isParked);
+
+	std::array<STypePool, static_cast<size_t>(EProjectileType::Count)> m_pools;
+	int m_initialSize = 16;
+	int m_maxSize = 128;
+};
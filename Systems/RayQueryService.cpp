@@ -0,0 +1,236 @@
+#include "StdAfx.h"
+#include "RayQueryService.h"
+#include "GamePlugin.h"
+#include "GameplayProfiler.h"
+#include <algorithm>
+
+namespace
+{
+	void LogRayQueryStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CRayQueryService& rayQueryService = CGamePlugin::GetInstance()->GetRayQueryService();
+		rayQueryService.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			rayQueryService.ResetStatistics();
+		}
+	}
+}
+
+CRayQueryService::~CRayQueryService()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_rayQueryBudget", true);
+		gEnv->pConsole->RemoveCommand("g_rayQueryStats");
+	}
+}
+
+void CRayQueryService::RegisterCVars()
+{
+	REGISTER_CVAR2("g_rayQueryBudget", &m_budget, m_budget, VF_NULL, "Maximum number of deferred ray queries handed to the physics system per frame");
+	REGISTER_COMMAND("g_rayQueryStats", LogRayQueryStatsCommand, VF_NULL, "Prints deferred ray query counts. Pass 'reset' to clear the counters afterwards");
+}
+
+RayQueryHandle CRayQueryService::Submit(const Vec3& origin, const Vec3& direction, int objectTypes, unsigned int flags, IPhysicalEntity* pSkipEntity, RayQueryCallback callback)
+{
+	++m_statistics.submitted;
+
+	for (uint32 i = 0; i < SlotCount; ++i)
+	{
+		const uint32 slotIndex = (m_searchStart + i) % SlotCount;
+		SSlot& slot = m_slots[slotIndex];
+		if (slot.state.load(std::memory_order_acquire) != ESlotState::Free)
+			continue;
+
+		m_searchStart = (slotIndex + 1) % SlotCount;
+
+		// Keep the serial within the bits left over by the slot index, and never produce the invalid handle
+		m_nextSerial = (m_nextSerial + 1) & ((1u << (32 - SlotBits)) - 1);
+		m_nextSerial = m_nextSerial == 0 ? 1 : m_nextSerial;
+
+		slot.serial = m_nextSerial;
+		slot.origin = origin;
+		slot.direction = direction;
+		slot.objectTypes = objectTypes;
+		slot.flags = flags;
+		slot.pSkipEntity = pSkipEntity;
+		slot.callback = std::move(callback);
+		slot.result = SRayQueryResult();
+		slot.state.store(ESlotState::Pending, std::memory_order_release);
+
+		m_pendingSlots.push_back(slotIndex);
+		return (slot.serial << SlotBits) | slotIndex;
+	}
+
+	++m_statistics.rejected;
+	return InvalidHandle;
+}
+
+void CRayQueryService::Cancel(RayQueryHandle handle)
+{
+	SSlot* pSlot = GetSlot(handle);
+	if (pSlot == nullptr)
+		return;
+
+	// Cancelled twice while in flight, the physics system still owns the slot until its result arrives
+	if (pSlot->state.load(std::memory_order_acquire) == ESlotState::Cancelled)
+		return;
+
+	++m_statistics.cancelled;
+	pSlot->callback = nullptr;
+
+	ESlotState expected = ESlotState::InFlight;
+	if (pSlot->state.compare_exchange_strong(expected, ESlotState::Cancelled, std::memory_order_acq_rel))
+	{
+		// The physics system still owns the hit buffer, the slot is freed when the result arrives
+		return;
+	}
+
+	if (expected == ESlotState::Pending)
+	{
+		m_pendingSlots.erase(std::find(m_pendingSlots.begin(), m_pendingSlots.end(), static_cast<uint32>(pSlot - m_slots.data())));
+	}
+	FreeSlot(*pSlot);
+}
+
+bool CRayQueryService::TryGetResult(RayQueryHandle handle, SRayQueryResult& result)
+{
+	SSlot* pSlot = GetSlot(handle);
+	if (pSlot == nullptr || pSlot->state.load(std::memory_order_acquire) != ESlotState::Completed)
+		return false;
+
+	result = pSlot->result;
+	FreeSlot(*pSlot);
+	return true;
+}
+
+void CRayQueryService::Update()
+{
+	GAMEPLAY_PROFILE_SCOPE(RayQueryUpdate);
+	// Deliver the results that arrived since the last frame
+	uint32 inFlightCount = 0;
+	for (SSlot& slot : m_slots)
+	{
+		const ESlotState state = slot.state.load(std::memory_order_acquire);
+		if (state == ESlotState::InFlight)
+		{
+			++inFlightCount;
+		}
+		else if (state == ESlotState::Completed && slot.callback)
+		{
+			++m_statistics.completed;
+			// Free the slot before invoking, so that the callback can submit its next query into it
+			const RayQueryCallback callback = std::move(slot.callback);
+			const SRayQueryResult result = slot.result;
+			FreeSlot(slot);
+			callback(result);
+		}
+	}
+
+	// Hand pending queries to the physics system within the frame budget
+	uint32 issuedCount = 0;
+	while (!m_pendingSlots.empty() && issuedCount < static_cast<uint32>(m_budget))
+	{
+		Issue(m_pendingSlots.front());
+		m_pendingSlots.pop_front();
+		++issuedCount;
+	}
+
+	m_statistics.issued += issuedCount;
+	m_statistics.issuedLastFrame = issuedCount;
+	m_statistics.peakInFlight = max(m_statistics.peakInFlight, inFlightCount + issuedCount);
+	if (!m_pendingSlots.empty())
+	{
+		++m_statistics.budgetLimitedFrames;
+	}
+}
+
+void CRayQueryService::Reset()
+{
+	m_pendingSlots.clear();
+	for (SSlot& slot : m_slots)
+	{
+		slot.callback = nullptr;
+
+		ESlotState expected = ESlotState::InFlight;
+		if (!slot.state.compare_exchange_strong(expected, ESlotState::Cancelled, std::memory_order_acq_rel))
+		{
+			FreeSlot(slot);
+		}
+	}
+}
+
+void CRayQueryService::LogStatistics() const
+{
+	CryLogAlways("[RayQuery] submitted %u, issued %u, completed %u, cancelled %u, rejected %u, budget %i, issued last frame %u, pending %u, budget limited frames %u, peak in flight %u",
+		m_statistics.submitted, m_statistics.issued, m_statistics.completed, m_statistics.cancelled, m_statistics.rejected, m_budget,
+		m_statistics.issuedLastFrame, static_cast<uint32>(m_pendingSlots.size()), m_statistics.budgetLimitedFrames, m_statistics.peakInFlight);
+}
+
+int CRayQueryService::OnRayWorldIntersectionResult(const EventPhysRWIResult* pEvent)
+{
+	CRayQueryService* pService = static_cast<CRayQueryService*>(pEvent->pForeignData);
+	SSlot& slot = pService->m_slots[pEvent->iForeignData];
+
+	// This can run on the physics thread, so only fill in the result and let Update deliver it
+	SRayQueryResult& result = slot.result;
+	result.hasHit = pEvent->nHits > 0;
+	if (result.hasHit)
+	{
+		const ray_hit& hit = pEvent->pHits[0];
+		result.point = hit.pt;
+		result.normal = hit.n;
+		result.distance = hit.dist;
+		result.pCollider = hit.pCollider;
+	}
+
+	ESlotState expected = ESlotState::InFlight;
+	if (!slot.state.compare_exchange_strong(expected, ESlotState::Completed, std::memory_order_acq_rel))
+	{
+		// Cancelled while in flight, nobody is waiting for the result anymore
+		slot.state.store(ESlotState::Free, std::memory_order_release);
+	}
+	return 1;
+}
+
+CRayQueryService::SSlot* CRayQueryService::GetSlot(RayQueryHandle handle)
+{
+	if (handle == InvalidHandle)
+		return nullptr;
+
+	SSlot& slot = m_slots[handle & (SlotCount - 1)];
+	if (slot.serial != handle >> SlotBits || slot.state.load(std::memory_order_acquire) == ESlotState::Free)
+		return nullptr;
+
+	return &slot;
+}
+
+void CRayQueryService::Issue(uint32 slotIndex)
+{
+	SSlot& slot = m_slots[slotIndex];
+	slot.state.store(ESlotState::InFlight, std::memory_order_release);
+
+	SRWIParams params;
+	params.org = slot.origin;
+	params.dir = slot.direction;
+	params.objtypes = slot.objectTypes;
+	// rwi_queue defers the ray to the physics system, the result is reported through OnEvent
+	params.flags = slot.flags | rwi_queue;
+	params.hits = &slot.hit;
+	params.nMaxHits = 1;
+	params.pSkipEnts = slot.pSkipEntity != nullptr ? &slot.pSkipEntity : nullptr;
+	params.nSkipEnts = slot.pSkipEntity != nullptr ? 1 : 0;
+	params.pForeignData = this;
+	params.iForeignData = static_cast<int>(slotIndex);
+	params.OnEvent = &CRayQueryService::OnRayWorldIntersectionResult;
+
+	gEnv->pPhysicalWorld->RayWorldIntersection(params, "CRayQueryService");
+}
+
+void CRayQueryService::FreeSlot(SSlot& slot)
+{
+	slot.callback = nullptr;
+	slot.state.store(ESlotState::Free, std::memory_order_release);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <CryPhysics/physinterface.h>
+#include "GameplayMemory.h"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+
+// Identifies a submitted ray query, zero is never a valid handle.
+using RayQueryHandle = uint32;
+
+struct SRayQueryResult
+{
+	bool hasHit = false;
+	Vec3 point = ZERO;
+	Vec3 normal = ZERO;
+	float distance = 0.f;
+	IPhysicalEntity* pCollider = nullptr;
+};
+
+using RayQueryCallback = std::function<void(const SRayQueryResult&)>;
+
+////////////////////////////////////////////////////////
+// Deferred ray queries for gameplay code.
+// Rays are handed to the physics system's queued raycasting (rwi_queue) up to a per-frame budget, and results are
+// delivered on the main thread during the next Update, either to a callback or for polling through the handle.
+////////////////////////////////////////////////////////
+class CRayQueryService
+{
+public:
+	static constexpr RayQueryHandle InvalidHandle = 0;
+
+	struct SStatistics
+	{
+		uint32 submitted = 0;
+		uint32 issued = 0;
+		uint32 completed = 0;
+		uint32 cancelled = 0;
+		// Submissions refused because every slot was in use.
+		uint32 rejected = 0;
+		// Frames in which the budget left queries waiting for the next frame.
+		uint32 budgetLimitedFrames = 0;
+		uint32 issuedLastFrame = 0;
+		uint32 peakInFlight = 0;
+	};
+
+	CRayQueryService() = default;
+	~CRayQueryService();
+
+	// Registers the budget CVar and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Queues a ray from the origin along the direction, the length of the direction is the ray length.
+	// Without a callback the result is kept until it is fetched with TryGetResult.
+	RayQueryHandle Submit(const Vec3& origin, const Vec3& direction, int objectTypes, unsigned int flags, IPhysicalEntity* pSkipEntity, RayQueryCallback callback = nullptr);
+	// Drops the query, its callback will not be invoked. Must be called by owners that go away before the result arrives.
+	void Cancel(RayQueryHandle handle);
+	// Fetches and releases the result of a query submitted without a callback. Returns false while it is still pending.
+	bool TryGetResult(RayQueryHandle handle, SRayQueryResult& result);
+
+	// Delivers completed results and issues pending queries within the frame budget.
+	void Update();
+	// Cancels all queries, called when the level unloads.
+	void Reset();
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	enum class ESlotState : uint8
+	{
+		Free = 0,
+		// Submitted but not yet handed to the physics system.
+		Pending,
+		// Handed to the physics system, waiting for the result event.
+		InFlight,
+		// Result arrived and waits to be delivered on the main thread.
+		Completed,
+		// Cancelled while in flight, freed once the physics system is done with it.
+		Cancelled
+	};
+
+	struct SSlot
+	{
+		std::atomic<ESlotState> state { ESlotState::Free };
+		uint32 serial = 0;
+		Vec3 origin = ZERO;
+		Vec3 direction = ZERO;
+		int objectTypes = 0;
+		unsigned int flags = 0;
+		IPhysicalEntity* pSkipEntity = nullptr;
+		RayQueryCallback callback;
+		// Hit buffer the physics system writes into, it has to stay valid until the result event.
+		ray_hit hit;
+		SRayQueryResult result;
+	};
+
+	static constexpr uint32 SlotCount = 256;
+	static constexpr uint32 SlotBits = 8;
+
+	static int OnRayWorldIntersectionResult(const EventPhysRWIResult* pEvent);
+	SSlot* GetSlot(RayQueryHandle handle);
+	void Issue(uint32 slotIndex);
+	void FreeSlot(SSlot& slot);
+
+	std::array<SSlot, SlotCount> m_slots;
+	// Slots waiting to be issued, in submission order.
+	std::deque<uint32, TGameplayAllocator<uint32, EMemoryTag::RayQueryQueue>> m_pendingSlots;
+	uint32 m_nextSerial = 1;
+	uint32 m_searchStart = 0;
+	SStatistics m_statistics;
+
+	int m_budget = 64;
+};
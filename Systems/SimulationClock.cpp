@@ -0,0 +1,87 @@
+#include "StdAfx.h"
+#include "SimulationClock.h"
+#include "GamePlugin.h"
+
+namespace
+{
+	void LogSimulationStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CSimulationClock& simulationClock = CGamePlugin::GetInstance()->GetSimulationClock();
+		simulationClock.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			simulationClock.ResetStatistics();
+		}
+	}
+}
+
+CSimulationClock::~CSimulationClock()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_fixedTimestep", true);
+		gEnv->pConsole->UnregisterVariable("g_simulationTickRate", true);
+		gEnv->pConsole->UnregisterVariable("g_simulationMaxTicksPerFrame", true);
+		gEnv->pConsole->RemoveCommand("g_simulationStats");
+	}
+}
+
+void CSimulationClock::RegisterCVars()
+{
+	// A dedicated server renders nothing, so it gains the most from a low fixed tick rate
+	if (gEnv->IsDedicated())
+	{
+		m_isFixedTimestep = 1;
+		m_tickRate = 20.f;
+	}
+
+	REGISTER_CVAR2("g_fixedTimestep", &m_isFixedTimestep, m_isFixedTimestep, VF_NULL, "Runs player movement and projectile aging in fixed ticks\n0: One tick of the frame time per frame\n1: Ticks of 1 / g_simulationTickRate seconds, presentation is interpolated");
+	REGISTER_CVAR2("g_simulationTickRate", &m_tickRate, m_tickRate, VF_NULL, "Gameplay ticks per second while g_fixedTimestep is on");
+	REGISTER_CVAR2("g_simulationMaxTicksPerFrame", &m_maxTicksPerFrame, m_maxTicksPerFrame, VF_NULL, "Ticks run in one frame at most, a longer hitch slows the simulation down instead of stalling the next frames");
+	REGISTER_COMMAND("g_simulationStats", LogSimulationStatsCommand, VF_NULL, "Prints ticks per frame and dropped ticks. Pass 'reset' to clear the counters afterwards");
+}
+
+uint32 CSimulationClock::Advance(float frameTime)
+{
+	m_time += frameTime;
+	if (m_isFixedTimestep != 0)
+	{
+		m_timestep.SetTickRate(m_tickRate);
+		m_timestep.SetMaxTicksPerFrame(static_cast<uint32>(max(m_maxTicksPerFrame, 1)));
+		m_tickCount = m_timestep.Advance(frameTime);
+		m_tickInterval = m_timestep.GetTickInterval();
+	}
+	else
+	{
+		m_tickCount = 1;
+		m_tickInterval = frameTime;
+	}
+
+	++m_statistics.frames;
+	m_statistics.ticks += m_tickCount;
+	m_statistics.idleFrames += m_tickCount == 0 ? 1 : 0;
+	m_statistics.maxTicksPerFrame = max(m_statistics.maxTicksPerFrame, m_tickCount);
+	return m_tickCount;
+}
+
+void CSimulationClock::Pause()
+{
+	// Otherwise the projectiles would run the tick count of the last frame before the pause again
+	m_tickCount = 0;
+}
+
+void CSimulationClock::Reset()
+{
+	m_timestep.Reset();
+	m_tickCount = 0;
+	m_time = 0.f;
+}
+
+void CSimulationClock::LogStatistics() const
+{
+	const float ticksPerFrame = m_statistics.frames > 0 ? static_cast<float>(m_statistics.ticks) / m_statistics.frames : 0.f;
+	CryLogAlways("[Simulation] %s, %.1f ticks per second, frames %u, ticks %llu (%.2f per frame, max %u), frames without a tick %u, dropped ticks %llu",
+		IsFixedTimestep() ? "fixed timestep" : "variable timestep", m_tickRate, m_statistics.frames, static_cast<unsigned long long>(m_statistics.ticks),
+		ticksPerFrame, m_statistics.maxTicksPerFrame, m_statistics.idleFrames, static_cast<unsigned long long>(m_timestep.GetDroppedTicks()));
+}
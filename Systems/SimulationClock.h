@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Core/FixedTimestep.h"
+
+////////////////////////////////////////////////////////
+// Decides how many gameplay ticks run each frame.
+// With g_fixedTimestep on, player movement and projectile aging run in ticks of 1 / g_simulationTickRate seconds
+// regardless of the frame rate, so a dedicated server can tick at a low and cheap rate while clients present the
+// results interpolated. With it off every frame is one tick of the frame time, as before.
+////////////////////////////////////////////////////////
+class CSimulationClock
+{
+public:
+	struct SStatistics
+	{
+		uint32 frames = 0;
+		uint64 ticks = 0;
+		// Frames in which no tick was due.
+		uint32 idleFrames = 0;
+		uint32 maxTicksPerFrame = 0;
+	};
+
+	CSimulationClock() = default;
+	~CSimulationClock();
+
+	// Registers the timestep CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Advances the clock by the frame time, called once per frame by the plug-in update before anything ticks.
+	uint32 Advance(float frameTime);
+	// Runs no tick this frame and keeps the time and any partial tick, called instead of Advance while the game is paused.
+	void Pause();
+
+	bool IsFixedTimestep() const { return m_isFixedTimestep != 0; }
+	// Ticks to run in the current frame and the seconds each of them simulates.
+	uint32 GetTickCount() const { return m_tickCount; }
+	float GetTickInterval() const { return m_tickInterval; }
+	// Fraction of a tick the frame is past the last tick, for interpolating presentation.
+	float GetInterpolationAlpha() const { return IsFixedTimestep() ? m_timestep.GetInterpolationAlpha() : 1.f; }
+	// Seconds simulated since the level started, the sum of the frame times the clock was advanced by.
+	// Unlike the engine timer it follows the recorded frame times while an input recording is replayed.
+	float GetTime() const { return m_time; }
+
+	// Drops any partial tick and restarts the time, called when the level unloads.
+	void Reset();
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	SimulationKernels::CFixedTimestep m_timestep;
+	SStatistics m_statistics;
+	uint32 m_tickCount = 0;
+	float m_tickInterval = 0.f;
+	float m_time = 0.f;
+
+	int m_isFixedTimestep = 0;
+	float m_tickRate = 30.f;
+	int m_maxTicksPerFrame = 4;
+};
@@ -0,0 +1,209 @@
+#include "StdAfx.h"
+#include "SnapshotSystem.h"
+#include "GamePlugin.h"
+#include "Components/Player.h"
+#include <algorithm>
+
+namespace
+{
+	void LogSnapshotStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CSnapshotSystem& snapshotSystem = CGamePlugin::GetInstance()->GetSnapshotSystem();
+		snapshotSystem.LogStatistics();
+		// Passing "reset" clears the counters after printing them
+		if (pArgs->GetArgCount() > 1 && stricmp(pArgs->GetArg(1), "reset") == 0)
+		{
+			snapshotSystem.ResetStatistics();
+		}
+	}
+}
+
+CSnapshotSystem::~CSnapshotSystem()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_playerSnapshots", true);
+		gEnv->pConsole->UnregisterVariable("g_playerSnapshotRate", true);
+		gEnv->pConsole->UnregisterVariable("g_playerSnapshotAckDelay", true);
+		gEnv->pConsole->UnregisterVariable("g_playerSnapshotVerify", true);
+		gEnv->pConsole->RemoveCommand("g_playerSnapshotStats");
+	}
+}
+
+void CSnapshotSystem::RegisterCVars()
+{
+	REGISTER_CVAR2("g_playerSnapshots", &m_isEnabled, m_isEnabled, VF_NULL, "Takes delta compressed snapshots of the player state on the server\n0: Off\n1: On");
+	REGISTER_CVAR2("g_playerSnapshotRate", &m_snapshotRate, m_snapshotRate, VF_NULL, "Player snapshots per second");
+	REGISTER_CVAR2("g_playerSnapshotAckDelay", &m_ackDelay, m_ackDelay, VF_NULL, "Snapshots the local receiver waits before acknowledging one, stands in for the round trip time");
+	REGISTER_CVAR2("g_playerSnapshotVerify", &m_verifyMode, m_verifyMode, VF_NULL, "Passes every snapshot through the local receive path on the server, also in single player\n0: Off\n1: Decode and count round trip mismatches\n2: Also apply the states to the remote players like a client would");
+	REGISTER_COMMAND("g_playerSnapshotStats", LogSnapshotStatsCommand, VF_NULL, "Prints snapshot counts and bytes per player per tick. Pass 'reset' to clear the counters afterwards");
+}
+
+void CSnapshotSystem::OnLevelLoadEnd()
+{
+	NetKernels::SLevelGrid grid;
+	grid.extent = static_cast<float>(max(gEnv->p3DEngine->GetTerrainSize(), 1024));
+	m_sender.SetGrid(grid);
+	m_receiver.SetGrid(grid);
+	m_pendingAcks.clear();
+}
+
+void CSnapshotSystem::RegisterPlayer(CPlayerComponent* pPlayer)
+{
+	if (std::find(m_players.begin(), m_players.end(), pPlayer) != m_players.end())
+		return;
+
+	if (m_freeSlots.empty())
+	{
+		m_players.push_back(pPlayer);
+	}
+	else
+	{
+		// The slot's entries carry the new player's id, so it goes out in full once instead of as a delta of the old player
+		m_players[m_freeSlots.back()] = pPlayer;
+		m_freeSlots.pop_back();
+	}
+}
+
+void CSnapshotSystem::UnregisterPlayer(CPlayerComponent* pPlayer)
+{
+	// The other players keep their slots, so their deltas stay against their own baselines
+	auto it = std::find(m_players.begin(), m_players.end(), pPlayer);
+	if (it != m_players.end())
+	{
+		*it = nullptr;
+		m_freeSlots.push_back(static_cast<uint32>(it - m_players.begin()));
+	}
+}
+
+bool CSnapshotSystem::ReceiveSnapshot(const uint8* pData, uint32 byteCount, uint16& sequence)
+{
+	if (!DecodeSnapshot(pData, byteCount, sequence))
+		return false;
+
+	ApplySnapshot();
+	return true;
+}
+
+bool CSnapshotSystem::DecodeSnapshot(const uint8* pData, uint32 byteCount, uint16& sequence)
+{
+	if (!m_receiver.Decode(pData, byteCount, m_decodedStates, sequence))
+	{
+		++m_statistics.rejectedSnapshots;
+		return false;
+	}
+	return true;
+}
+
+void CSnapshotSystem::ApplySnapshot()
+{
+	const float snapshotInterval = m_snapshotRate > 0.f ? 1.f / m_snapshotRate : 0.f;
+	for (const NetKernels::SPlayerState& state : m_decodedStates)
+	{
+		IEntity* pEntity = state.playerId != 0 ? gEnv->pEntitySystem->GetEntity(static_cast<EntityId>(state.playerId)) : nullptr;
+		// The local player is predicted from its own input
+		if (pEntity == nullptr || (pEntity->GetFlags() & ENTITY_FLAG_LOCAL_PLAYER) != 0)
+			continue;
+
+		if (CPlayerComponent* pPlayer = pEntity->GetComponent<CPlayerComponent>())
+		{
+			pPlayer->ApplySnapshotState(state, snapshotInterval);
+		}
+	}
+}
+
+void CSnapshotSystem::Update(float frameTime)
+{
+	if (m_isEnabled == 0 || !gEnv->bServer || m_players.empty() || m_snapshotRate <= 0.f)
+		return;
+
+	// Nobody to send them to, unless the local receive path is being verified
+	if (m_verifyMode == 0 && !CGamePlugin::GetInstance()->HasRemoteClients())
+		return;
+
+	m_timeSinceSnapshot += frameTime;
+	const float interval = 1.f / m_snapshotRate;
+	if (m_timeSinceSnapshot < interval)
+		return;
+
+	// A long frame takes one snapshot, not a burst of them
+	m_timeSinceSnapshot = fmodf(m_timeSinceSnapshot, interval);
+	TakeSnapshot();
+}
+
+void CSnapshotSystem::Reset()
+{
+	m_sender.Reset();
+	m_receiver.Reset();
+	m_pendingAcks.clear();
+	m_timeSinceSnapshot = 0.f;
+}
+
+void CSnapshotSystem::LogStatistics() const
+{
+	const float averageBytesPerPlayer = m_statistics.playerStates > 0 ? static_cast<float>(m_statistics.payloadBytes) / m_statistics.playerStates : 0.f;
+	CryLogAlways("[Snapshots] players %u in %u slots, snapshots %u (%u full), %.2f bytes per player per tick, largest snapshot %u bytes",
+		static_cast<uint32>(m_players.size() - m_freeSlots.size()), static_cast<uint32>(m_players.size()), m_statistics.snapshots, m_statistics.fullSnapshots, averageBytesPerPlayer, m_statistics.largestSnapshotBytes);
+	CryLogAlways("[Snapshots] round trip mismatches %u, rejected snapshots %u", m_statistics.roundTripMismatches, m_statistics.rejectedSnapshots);
+}
+
+void CSnapshotSystem::TakeSnapshot()
+{
+	m_states.resize(m_players.size());
+	for (size_t i = 0; i < m_players.size(); ++i)
+	{
+		// Free slots cost a bit each until a player takes them
+		m_states[i] = m_players[i] != nullptr ? m_players[i]->GetSnapshotState() : NetKernels::SPlayerState();
+	}
+
+	m_sender.Encode(m_states.data(), static_cast<uint32>(m_states.size()), m_packet);
+	++m_statistics.snapshots;
+	m_statistics.playerStates += m_states.size();
+	m_statistics.payloadBytes += m_packet.size();
+	m_statistics.largestSnapshotBytes = max(m_statistics.largestSnapshotBytes, static_cast<uint32>(m_packet.size()));
+	if (!m_sender.WasLastSnapshotDelta())
+	{
+		++m_statistics.fullSnapshots;
+	}
+
+	if (m_verifyMode != 0)
+	{
+		VerifySnapshot();
+	}
+}
+
+void CSnapshotSystem::VerifySnapshot()
+{
+	// Local receive path, decodes the snapshot the way a client would
+	uint16 sequence = 0;
+	if (!DecodeSnapshot(m_packet.data(), static_cast<uint32>(m_packet.size()), sequence))
+		return;
+
+	const std::vector<NetKernels::SQuantizedPlayerState>* pDecoded = m_receiver.GetQuantizedStates(sequence);
+	if (pDecoded == nullptr || pDecoded->size() != m_states.size())
+	{
+		++m_statistics.rejectedSnapshots;
+		return;
+	}
+
+	for (size_t i = 0; i < m_states.size(); ++i)
+	{
+		if ((*pDecoded)[i] != NetKernels::QuantizePlayerState(m_sender.GetGrid(), m_states[i]))
+		{
+			++m_statistics.roundTripMismatches;
+		}
+	}
+
+	// The remote players then follow the snapshots instead of their own simulation, the local player stays predicted
+	if (m_verifyMode > 1)
+	{
+		ApplySnapshot();
+	}
+
+	m_pendingAcks.push_back(sequence);
+	while (m_pendingAcks.size() > static_cast<size_t>(max(m_ackDelay, 0)))
+	{
+		m_sender.Acknowledge(m_pendingAcks.front());
+		m_pendingAcks.erase(m_pendingAcks.begin());
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Core/PlayerSnapshot.h"
+#include <vector>
+
+class CPlayerComponent;
+
+////////////////////////////////////////////////////////
+// Takes bit packed snapshots of every player at a fixed rate.
+// Each snapshot is delta encoded against the last one the client acknowledged. Snapshots are only taken on a server
+// with remote clients. With g_playerSnapshotVerify the server also passes them to the local receive path, which checks
+// that they decode back to the sent state and acknowledges them after a configurable delay.
+// The statistics report the bytes per player per tick.
+////////////////////////////////////////////////////////
+class CSnapshotSystem
+{
+public:
+	struct SStatistics
+	{
+		uint32 snapshots = 0;
+		uint32 fullSnapshots = 0;
+		uint64 playerStates = 0;
+		uint64 payloadBytes = 0;
+		uint32 largestSnapshotBytes = 0;
+		// Players whose decoded state differed from the state that was sent.
+		uint32 roundTripMismatches = 0;
+		uint32 rejectedSnapshots = 0;
+	};
+
+	CSnapshotSystem() = default;
+	~CSnapshotSystem();
+
+	// Registers the snapshot CVars and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+	// Fits the quantization grid to the loaded level, earlier snapshots can no longer be used as baselines.
+	void OnLevelLoadEnd();
+
+	// Every player keeps its slot in the snapshot until it unregisters, freed slots are reused by the next players.
+	void RegisterPlayer(CPlayerComponent* pPlayer);
+	void UnregisterPlayer(CPlayerComponent* pPlayer);
+
+	// Decodes a snapshot from the server and returns the sequence to acknowledge, false if it could not be decoded.
+	// The states are applied to the players other than the local one. Only clients call this from the transport,
+	// the server's own players stay authoritative.
+	bool ReceiveSnapshot(const uint8* pData, uint32 byteCount, uint16& sequence);
+
+	// Takes a snapshot when the snapshot interval has passed.
+	void Update(float frameTime);
+	// Forgets baselines and pending acknowledgements, called when the level unloads.
+	void Reset();
+
+	const SStatistics& GetStatistics() const { return m_statistics; }
+	void ResetStatistics() { m_statistics = SStatistics(); }
+	void LogStatistics() const;
+
+private:
+	void TakeSnapshot();
+	// Decodes into m_decodedStates.
+	bool DecodeSnapshot(const uint8* pData, uint32 byteCount, uint16& sequence);
+	void ApplySnapshot();
+	// Runs the last snapshot through the local receive path and acknowledges it after the delay.
+	void VerifySnapshot();
+
+	// Players by slot, nullptr for a free slot.
+	std::vector<CPlayerComponent*> m_players;
+	std::vector<uint32> m_freeSlots;
+	std::vector<NetKernels::SPlayerState> m_states;
+	std::vector<NetKernels::SPlayerState> m_decodedStates;
+	std::vector<uint8> m_packet;
+	NetKernels::CSnapshotSender m_sender;
+	NetKernels::CSnapshotReceiver m_receiver;
+	// Sequences the receiver decoded, acknowledged to the sender once they are old enough.
+	std::vector<uint16> m_pendingAcks;
+	SStatistics m_statistics;
+	float m_timeSinceSnapshot = 0.f;
+
+	int m_isEnabled = 1;
+	float m_snapshotRate = 30.f;
+	int m_ackDelay = 3;
+	int m_verifyMode = 0;
+};
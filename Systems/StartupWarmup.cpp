@@ -0,0 +1,273 @@
+#include "StdAfx.h"
+#include "StartupWarmup.h"
+#include "GamePlugin.h"
+
+namespace
+{
+	// Marks the read of the character definition, the files it references are read once it arrived.
+	const DWORD_PTR CharacterDefinitionRead = 1;
+
+	void LogStartupTimelineCommand(IConsoleCmdArgs* pArgs)
+	{
+		CGamePlugin::GetInstance()->GetStartupWarmup().LogTimeline();
+	}
+}
+
+CStartupWarmup::~CStartupWarmup()
+{
+	CancelStreams();
+
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_startupWarmup", true);
+		gEnv->pConsole->RemoveCommand("g_startupTimeline");
+	}
+}
+
+void CStartupWarmup::RegisterCVars()
+{
+	REGISTER_CVAR2("g_startupWarmup", &m_isEnabled, m_isEnabled, VF_NULL, "Reads and loads the player character and Mannequin data before the first player spawns\n0: The first player loads its character when it spawns\n1: Read in the background from the plug-in initialization, load once the game initialized");
+	REGISTER_COMMAND("g_startupTimeline", LogStartupTimelineCommand, VF_NULL, "Prints the startup phases from the plug-in initialization to the first interactive frame");
+}
+
+void CStartupWarmup::Start()
+{
+	m_startTime = gEnv->pTimer->GetAsyncTime();
+	AddPhase("plug-in initialized");
+
+	if (m_isEnabled == 0)
+		return;
+
+	StartReads();
+	AddPhase("warm-up reads issued");
+}
+
+void CStartupWarmup::Bind()
+{
+	if (m_isEnabled == 0 || m_state == EState::Bound)
+		return;
+
+	// Whatever did not finish reading yet is read by the loaders themselves
+	if (m_state == EState::Streaming)
+	{
+		AddPhase("warm-up reads still running");
+		CancelStreams();
+	}
+
+	const CTimeValue bindStartTime = gEnv->pTimer->GetAsyncTime();
+	// The registry keeps the template for the session, every player spawned later shares it
+	CGamePlugin::GetInstance()->GetCharacterTemplateRegistry().Acquire(GetPlayerCharacterFiles());
+
+	// Bullet and cursor materials, the level load finds them already resolved
+	CGamePlugin::GetInstance()->GetAssetCache().Resolve();
+
+	m_state = EState::Bound;
+	AddPhase("character data bound", (gEnv->pTimer->GetAsyncTime() - bindStartTime).GetMilliSeconds());
+}
+
+void CStartupWarmup::OnLevelLoadStart()
+{
+	if (!m_isComplete)
+	{
+		AddPhase("level load started");
+	}
+}
+
+void CStartupWarmup::OnLevelLoadEnd()
+{
+	if (!m_isComplete)
+	{
+		AddPhase("level loaded");
+	}
+}
+
+void CStartupWarmup::OnGameplayStart()
+{
+	if (!m_isComplete)
+	{
+		m_isGameplayStarted = true;
+		AddPhase("gameplay started");
+	}
+}
+
+void CStartupWarmup::OnPlayerLoaded(const CTimeValue& loadStartTime)
+{
+	if (m_isComplete || m_isPlayerLoaded)
+		return;
+
+	m_isPlayerLoaded = true;
+	const float milliseconds = (gEnv->pTimer->GetAsyncTime() - loadStartTime).GetMilliSeconds();
+	AddPhase(m_state == EState::Bound ? "first player bound" : "first player loaded without warm-up", milliseconds);
+}
+
+void CStartupWarmup::Update()
+{
+	if (!m_isGameplayStarted || m_isComplete)
+		return;
+
+	AddPhase("first interactive frame");
+	m_isComplete = true;
+	LogTimeline();
+}
+
+void CStartupWarmup::LogTimeline() const
+{
+	CryLogAlways("[StartupWarmup] %-40s %10s %10s %10s", "Phase", "At ms", "Delta ms", "Took ms");
+	CTimeValue previousTime = m_startTime;
+	for (const SPhase& phase : m_phases)
+	{
+		const float atMs = (phase.time - m_startTime).GetMilliSeconds();
+		const float deltaMs = (phase.time - previousTime).GetMilliSeconds();
+		if (phase.durationMs >= 0.f)
+		{
+			CryLogAlways("[StartupWarmup] %-40s %10.1f %10.1f %10.1f", phase.szName, atMs, deltaMs, phase.durationMs);
+		}
+		else
+		{
+			CryLogAlways("[StartupWarmup] %-40s %10.1f %10.1f %10s", phase.szName, atMs, deltaMs, "-");
+		}
+		previousTime = phase.time;
+	}
+	CryLogAlways("[StartupWarmup] warm-up %s, %.1f MB read ahead", m_isEnabled != 0 ? "enabled" : "disabled", m_streamedBytes / (1024.f * 1024.f));
+}
+
+const SCharacterFiles& CStartupWarmup::GetPlayerCharacterFiles()
+{
+	static const SCharacterFiles files =
+	{
+		"Objects/Characters/SampleCharacter/thirdperson.cdf",
+		"Animations/Mannequin/ADB/FirstPerson.adb",
+		"Animations/Mannequin/ADB/FirstPersonControllerDefinition.xml"
+	};
+	return files;
+}
+
+void CStartupWarmup::StreamOnComplete(IReadStream* pStream, unsigned nError)
+{
+	// Streams cancelled by CancelStreams are already forgotten
+	if (nError == ERROR_USER_ABORT)
+		return;
+
+	if (nError != 0)
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "[StartupWarmup] Could not read %s, error %u", pStream->GetName(), nError);
+	}
+	else
+	{
+		m_streamedBytes += pStream->GetBytesRead();
+
+		// The skeleton, skins and their materials make up most of the character, read them as well
+		if (pStream->GetUserData() == CharacterDefinitionRead)
+		{
+			if (XmlNodeRef pDefinition = gEnv->pSystem->LoadXmlFromBuffer(static_cast<const char*>(pStream->GetBuffer()), pStream->GetBytesRead()))
+			{
+				StreamReadParams readParams;
+				readParams.ePriority = estpBelowNormal;
+				IStreamEngine* pStreamEngine = gEnv->pSystem->GetStreamEngine();
+
+				auto readReferencedFile = [&](const char* szFilePath)
+				{
+					if (szFilePath[0] != '\0' && gEnv->pCryPak->IsFileExist(szFilePath))
+					{
+						StartRead(*pStreamEngine, szFilePath, readParams);
+					}
+				};
+
+				if (XmlNodeRef pModel = pDefinition->findChild("Model"))
+				{
+					readReferencedFile(pModel->getAttr("File"));
+					readReferencedFile(pModel->getAttr("Material"));
+				}
+				if (XmlNodeRef pAttachments = pDefinition->findChild("AttachmentList"))
+				{
+					for (int i = 0; i < pAttachments->getChildCount(); ++i)
+					{
+						readReferencedFile(pAttachments->getChild(i)->getAttr("Binding"));
+					}
+				}
+			}
+		}
+	}
+
+	// The data itself is not kept, reading it is what moves it into the pak and disk caches
+	--m_pendingReads;
+	if (m_pendingReads == 0 && m_state == EState::Streaming)
+	{
+		m_state = EState::Resident;
+		m_streams.clear();
+		AddPhase("warm-up reads resident");
+	}
+}
+
+void CStartupWarmup::StartReads()
+{
+	const SCharacterFiles& files = GetPlayerCharacterFiles();
+	std::vector<string> filePaths = { files.szAnimationDatabase, files.szControllerDefinition };
+	for (uint32 i = 0; i < static_cast<uint32>(EMaterialAsset::Count); ++i)
+	{
+		filePaths.push_back(PathUtil::ReplaceExtension(CAssetCache::GetMaterialPath(static_cast<EMaterialAsset>(i)), "mtl"));
+	}
+	for (uint32 i = 0; i < static_cast<uint32>(EGeometryAsset::Count); ++i)
+	{
+		filePaths.push_back(CAssetCache::GetGeometryPath(static_cast<EGeometryAsset>(i)));
+	}
+
+	// Low priority, the engine's own startup reads come first
+	StreamReadParams readParams;
+	readParams.ePriority = estpBelowNormal;
+	IStreamEngine* pStreamEngine = gEnv->pSystem->GetStreamEngine();
+
+	readParams.dwUserData = CharacterDefinitionRead;
+	StartRead(*pStreamEngine, files.szCharacter, readParams);
+
+	readParams.dwUserData = 0;
+	for (const string& filePath : filePaths)
+	{
+		StartRead(*pStreamEngine, filePath.c_str(), readParams);
+	}
+
+	// Reads that completed right away are already counted off
+	m_state = m_pendingReads == 0 ? EState::Resident : EState::Streaming;
+}
+
+void CStartupWarmup::StartRead(IStreamEngine& streamEngine, const char* szFilePath, const StreamReadParams& readParams)
+{
+	// Counted first, the read may complete before StartRead returns
+	++m_pendingReads;
+	if (IReadStreamPtr pStream = streamEngine.StartRead(eStreamTaskTypeReadAhead, szFilePath, this, &readParams))
+	{
+		m_streams.push_back(pStream);
+	}
+	else
+	{
+		--m_pendingReads;
+	}
+}
+
+void CStartupWarmup::CancelStreams()
+{
+	for (const IReadStreamPtr& pStream : m_streams)
+	{
+		pStream->Abort();
+	}
+	m_streams.clear();
+	m_pendingReads = 0;
+}
+
+void CStartupWarmup::AddPhase(const char* szName, float durationMs)
+{
+	SPhase phase;
+	phase.szName = szName;
+	phase.time = gEnv->pTimer->GetAsyncTime();
+	phase.durationMs = durationMs;
+	m_phases.push_back(phase);
+
+	if (durationMs >= 0.f)
+	{
+		CryLogAlways("[StartupWarmup] %s at %.1f ms, took %.1f ms", szName, (phase.time - m_startTime).GetMilliSeconds(), durationMs);
+	}
+	else
+	{
+		CryLogAlways("[StartupWarmup] %s at %.1f ms", szName, (phase.time - m_startTime).GetMilliSeconds());
+	}
+}
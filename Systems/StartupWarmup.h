@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CharacterTemplateRegistry.h"
+#include <CrySystem/IStreamEngine.h>
+#include <vector>
+
+////////////////////////////////////////////////////////
+// Warms up the player character and Mannequin data while the engine is still starting, and logs a startup timeline.
+// The files are read in the background as soon as the plug-in initializes. Once the game finished initializing,
+// the player's character template is loaded, so that the first player spawn only binds data that is already resident.
+// Every phase from the plug-in initialization to the first interactive frame is timed, g_startupTimeline prints them.
+////////////////////////////////////////////////////////
+class CStartupWarmup : public IStreamCallback
+{
+public:
+	enum class EState
+	{
+		Idle = 0,
+		// The files are being read in the background.
+		Streaming,
+		// Every file finished reading.
+		Resident,
+		// The character template is loaded.
+		Bound
+	};
+
+	CStartupWarmup() = default;
+	virtual ~CStartupWarmup();
+
+	// Registers the warm-up CVar and the timeline command, called once from the plug-in initialization.
+	void RegisterCVars();
+	// Starts the timeline and the background reads, called right after RegisterCVars.
+	void Start();
+
+	// Loads the player's character template on the main thread, called once the game finished initializing.
+	void Bind();
+
+	// Startup phases, forwarded from the plug-in's system events.
+	void OnLevelLoadStart();
+	void OnLevelLoadEnd();
+	void OnGameplayStart();
+	// Called by each player once its character is set up, with the time it started loading.
+	void OnPlayerLoaded(const CTimeValue& loadStartTime);
+	// Records the first interactive frame after gameplay started.
+	void Update();
+
+	EState GetState() const { return m_state; }
+	void LogTimeline() const;
+
+	// The files every player character is set up from.
+	static const SCharacterFiles& GetPlayerCharacterFiles();
+
+	// IStreamCallback
+	// Called on the main thread by the stream engine's update, like the reads it starts, so no locking is needed.
+	virtual void StreamOnComplete(IReadStream* pStream, unsigned nError) override;
+
+private:
+	struct SPhase
+	{
+		const char* szName;
+		CTimeValue time;
+		// Time spent in the step itself, negative if the phase is only a point in time.
+		float durationMs;
+	};
+
+	void StartReads();
+	void StartRead(IStreamEngine& streamEngine, const char* szFilePath, const StreamReadParams& readParams);
+	void CancelStreams();
+	void AddPhase(const char* szName, float durationMs = -1.f);
+
+	EState m_state = EState::Idle;
+	int m_isEnabled = 1;
+
+	std::vector<IReadStreamPtr> m_streams;
+	// Reads started and not completed yet. Counted before each read starts, so that the reads a completed
+	// character definition starts keep the warm-up streaming until they completed as well.
+	uint32 m_pendingReads = 0;
+	uint64 m_streamedBytes = 0;
+
+	// Phases are only recorded until the first interactive frame, later levels do not belong to the startup.
+	std::vector<SPhase> m_phases;
+	CTimeValue m_startTime;
+	bool m_isGameplayStarted = false;
+	bool m_isPlayerLoaded = false;
+	bool m_isComplete = false;
+};
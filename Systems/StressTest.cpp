@@ -0,0 +1,292 @@
+#include "StdAfx.h"
+#include "StressTest.h"
+#include "GamePlugin.h"
+#include "Components/Player.h"
+#include "Components/LevelChangeTriggerComponent.h"
+#include <CryGame/IGameFramework.h>
+#include <ILevelSystem.h>
+#include <algorithm>
+
+namespace
+{
+	// Spacing of the spawn grid, large enough that the character controllers do not overlap.
+	const float StressSpawnSpacing = 2.5f;
+
+	void StressSpawnPlayersCommand(IConsoleCmdArgs* pArgs)
+	{
+		const uint32 count = pArgs->GetArgCount() > 1 ? static_cast<uint32>(atoi(pArgs->GetArg(1))) : 10;
+		CGamePlugin::GetInstance()->GetStressTest().SpawnPlayers(count);
+	}
+
+	void StressSpawnTriggersCommand(IConsoleCmdArgs* pArgs)
+	{
+		const uint32 count = pArgs->GetArgCount() > 1 ? static_cast<uint32>(atoi(pArgs->GetArg(1))) : 10;
+		CGamePlugin::GetInstance()->GetStressTest().SpawnTriggers(count);
+	}
+
+	void StressClearCommand(IConsoleCmdArgs* pArgs)
+	{
+		CGamePlugin::GetInstance()->GetStressTest().Clear();
+	}
+
+	void StressRunCommand(IConsoleCmdArgs* pArgs)
+	{
+		const float duration = pArgs->GetArgCount() > 1 ? static_cast<float>(atof(pArgs->GetArg(1))) : 30.f;
+		const char* szFileName = pArgs->GetArgCount() > 2 ? pArgs->GetArg(2) : "";
+		CGamePlugin::GetInstance()->GetStressTest().StartRun(duration, szFileName);
+	}
+
+	void WarnIfNotExampleLevel()
+	{
+		ILevelInfo* pLevel = gEnv->pGameFramework->GetILevelSystem()->GetCurrentLevel();
+		if (pLevel == nullptr || stricmp(pLevel->GetName(), "example") != 0)
+		{
+			CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_WARNING, "[StressTest] Scaling curves are only comparable in the example map");
+		}
+	}
+}
+
+CStressTest::~CStressTest()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_stressFireRate", true);
+		gEnv->pConsole->RemoveCommand("g_stressSpawnPlayers");
+		gEnv->pConsole->RemoveCommand("g_stressSpawnTriggers");
+		gEnv->pConsole->RemoveCommand("g_stressClear");
+		gEnv->pConsole->RemoveCommand("g_stressRun");
+	}
+}
+
+void CStressTest::RegisterCVars()
+{
+	REGISTER_CVAR2("g_stressFireRate", &m_fireRate, m_fireRate, VF_NULL, "Rounds per second fired through the weapon paths of the stress test players, spread over all of them");
+	REGISTER_COMMAND("g_stressSpawnPlayers", StressSpawnPlayersCommand, VF_NULL, "Spawns N stress test players around the local player. Usage: g_stressSpawnPlayers <N>");
+	REGISTER_COMMAND("g_stressSpawnTriggers", StressSpawnTriggersCommand, VF_NULL, "Spawns M level change trigger volumes around the local player. Usage: g_stressSpawnTriggers <M>");
+	REGISTER_COMMAND("g_stressClear", StressClearCommand, VF_NULL, "Removes every entity spawned by the stress test");
+	REGISTER_COMMAND("g_stressRun", StressRunCommand, VF_NULL, "Records frame time, entity and physics entity counts and writes a summary. Usage: g_stressRun <seconds> [file name]");
+}
+
+void CStressTest::SpawnPlayers(uint32 count)
+{
+	WarnIfNotExampleLevel();
+
+	const Vec3 center = GetSpawnCenter();
+	const uint32 rowLength = max(static_cast<uint32>(sqrtf(static_cast<float>(m_playerIds.size() + count))), 1u);
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const uint32 index = static_cast<uint32>(m_playerIds.size());
+
+		SEntitySpawnParams spawnParams;
+		spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+		spawnParams.vPosition = center + Vec3(static_cast<float>(index % rowLength), static_cast<float>(index / rowLength) + 1.f, 0.f) * StressSpawnSpacing;
+		spawnParams.nFlags = ENTITY_FLAG_NO_SAVE;
+
+		if (IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
+		{
+			pEntity->CreateComponentClass<CPlayerComponent>();
+			// Players spawned mid game never see the level start, send it so that they reset like the level's own player
+			pEntity->SendEvent(SEntityEvent(ENTITY_EVENT_START_GAME));
+			m_playerIds.push_back(pEntity->GetId());
+		}
+	}
+
+	CryLogAlways("[StressTest] %u stress test players", static_cast<uint32>(m_playerIds.size()));
+}
+
+void CStressTest::SpawnTriggers(uint32 count)
+{
+	WarnIfNotExampleLevel();
+
+	const Vec3 center = GetSpawnCenter();
+	// Scatter the volumes deterministically so that runs with the same counts are comparable
+	CRndGen random(static_cast<uint32>(m_triggerIds.size()) + 1);
+	const float radius = 10.f + sqrtf(static_cast<float>(m_triggerIds.size() + count)) * StressSpawnSpacing;
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		SEntitySpawnParams spawnParams;
+		spawnParams.pClass = gEnv->pEntitySystem->GetClassRegistry()->GetDefaultClass();
+		spawnParams.vPosition = center + Vec3(random.GetRandom(-radius, radius), random.GetRandom(-radius, radius), 0.f);
+		spawnParams.nFlags = ENTITY_FLAG_NO_SAVE;
+
+		if (IEntity* pEntity = gEnv->pEntitySystem->SpawnEntity(spawnParams))
+		{
+			pEntity->CreateComponentClass<CLevelChangeTriggerComponent>();
+			m_triggerIds.push_back(pEntity->GetId());
+		}
+	}
+
+	CryLogAlways("[StressTest] %u stress test triggers", static_cast<uint32>(m_triggerIds.size()));
+}
+
+void CStressTest::Clear()
+{
+	for (const EntityId entityId : m_playerIds)
+	{
+		gEnv->pEntitySystem->RemoveEntity(entityId);
+	}
+	for (const EntityId entityId : m_triggerIds)
+	{
+		gEnv->pEntitySystem->RemoveEntity(entityId);
+	}
+
+	m_playerIds.clear();
+	m_triggerIds.clear();
+	m_pendingShots = 0.f;
+}
+
+void CStressTest::StartRun(float duration, const char* szFileName)
+{
+	m_isRecording = duration > 0.f;
+	m_recordingDuration = duration;
+	m_recordingTimeLeft = duration;
+	m_samples.clear();
+	// Assume 120 frames per second so that recording does not reallocate in the common case
+	m_samples.reserve(static_cast<size_t>(duration * 120.f));
+
+	if (szFileName != nullptr && szFileName[0] != '\0')
+	{
+		m_summaryFileName = szFileName;
+	}
+	else
+	{
+		m_summaryFileName.Format("stress_%up_%ut_%.0frps.txt", static_cast<uint32>(m_playerIds.size()), static_cast<uint32>(m_triggerIds.size()), m_fireRate);
+	}
+
+	CryLogAlways("[StressTest] Recording %.1f seconds", duration);
+}
+
+void CStressTest::Update(float frameTime)
+{
+	if (m_fireRate > 0.f && !m_playerIds.empty())
+	{
+		FireSyntheticShots(frameTime);
+	}
+
+	if (!m_isRecording)
+		return;
+
+	SFrameSample sample;
+	sample.frameTime = gEnv->pTimer->GetRealFrameTime();
+	sample.entityCount = gEnv->pEntitySystem->GetNumEntities();
+	// Counting through a world sized box returns every physical entity without allocating a list
+	IPhysicalEntity** pPhysicalEntities = nullptr;
+	sample.physicalEntityCount = static_cast<uint32>(gEnv->pPhysicalWorld->GetEntitiesInBox(Vec3(-1e5f), Vec3(1e5f), pPhysicalEntities, ent_all));
+	sample.projectileCount = static_cast<uint32>(CGamePlugin::GetInstance()->GetProjectileManager().GetProjectileCount());
+	m_samples.push_back(sample);
+
+	m_recordingTimeLeft -= sample.frameTime;
+	if (m_recordingTimeLeft <= 0.f)
+	{
+		m_isRecording = false;
+		WriteSummary();
+	}
+}
+
+void CStressTest::Reset()
+{
+	m_playerIds.clear();
+	m_triggerIds.clear();
+	m_pendingShots = 0.f;
+	m_isRecording = false;
+	m_samples.clear();
+}
+
+Vec3 CStressTest::GetSpawnCenter() const
+{
+	if (IActor* pLocalActor = gEnv->pGameFramework->GetClientActor())
+	{
+		return pLocalActor->GetEntity()->GetWorldPos();
+	}
+
+	// Without an actor use the first player component found in the level
+	IEntityItPtr pIterator = gEnv->pEntitySystem->GetEntityIterator();
+	while (IEntity* pEntity = pIterator->Next())
+	{
+		if (pEntity->GetComponent<CPlayerComponent>() != nullptr && std::find(m_playerIds.begin(), m_playerIds.end(), pEntity->GetId()) == m_playerIds.end())
+		{
+			return pEntity->GetWorldPos();
+		}
+	}
+	return ZERO;
+}
+
+void CStressTest::FireSyntheticShots(float frameTime)
+{
+	m_pendingShots += m_fireRate * frameTime;
+
+	while (m_pendingShots >= 1.f)
+	{
+		m_pendingShots -= 1.f;
+
+		const uint32 shooterIndex = m_nextShooter++ % static_cast<uint32>(m_playerIds.size());
+		IEntity* pEntity = gEnv->pEntitySystem->GetEntity(m_playerIds[shooterIndex]);
+		if (CPlayerComponent* pPlayer = pEntity != nullptr ? pEntity->GetComponent<CPlayerComponent>() : nullptr)
+		{
+			// Alternate between the regular and water weapons every full round over the players
+			pPlayer->SimulateShot((m_nextShooter / m_playerIds.size()) % 2);
+		}
+	}
+}
+
+void CStressTest::WriteSummary()
+{
+	if (m_samples.empty())
+		return;
+
+	std::vector<float> frameTimes;
+	frameTimes.reserve(m_samples.size());
+
+	float totalFrameTime = 0.f;
+	uint64 totalEntities = 0, totalPhysicalEntities = 0, totalProjectiles = 0;
+	uint32 maxEntities = 0, maxPhysicalEntities = 0, maxProjectiles = 0;
+	for (const SFrameSample& sample : m_samples)
+	{
+		frameTimes.push_back(sample.frameTime);
+		totalFrameTime += sample.frameTime;
+		totalEntities += sample.entityCount;
+		totalPhysicalEntities += sample.physicalEntityCount;
+		totalProjectiles += sample.projectileCount;
+		maxEntities = max(maxEntities, sample.entityCount);
+		maxPhysicalEntities = max(maxPhysicalEntities, sample.physicalEntityCount);
+		maxProjectiles = max(maxProjectiles, sample.projectileCount);
+	}
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	const size_t sampleCount = frameTimes.size();
+	const auto percentile = [&frameTimes, sampleCount](float p) { return frameTimes[min(static_cast<size_t>(p * sampleCount), sampleCount - 1)] * 1000.f; };
+
+	const char* szLevelName = "";
+	if (ILevelInfo* pLevel = gEnv->pGameFramework->GetILevelSystem()->GetCurrentLevel())
+	{
+		szLevelName = pLevel->GetName();
+	}
+
+	string summary;
+	summary.Format(
+		"level=%s\nplayers=%u\ntriggers=%u\nfire_rate_rps=%.2f\nduration_s=%.2f\nframes=%u\n"
+		"frame_ms_avg=%.3f\nframe_ms_min=%.3f\nframe_ms_p50=%.3f\nframe_ms_p95=%.3f\nframe_ms_p99=%.3f\nframe_ms_max=%.3f\n"
+		"entities_avg=%.1f\nentities_max=%u\nphysical_entities_avg=%.1f\nphysical_entities_max=%u\nprojectiles_avg=%.1f\nprojectiles_max=%u\n",
+		szLevelName, static_cast<uint32>(m_playerIds.size()), static_cast<uint32>(m_triggerIds.size()), m_fireRate, m_recordingDuration, static_cast<uint32>(sampleCount),
+		totalFrameTime * 1000.f / sampleCount, frameTimes.front() * 1000.f, percentile(0.5f), percentile(0.95f), percentile(0.99f), frameTimes.back() * 1000.f,
+		static_cast<float>(totalEntities) / sampleCount, maxEntities, static_cast<float>(totalPhysicalEntities) / sampleCount, maxPhysicalEntities,
+		static_cast<float>(totalProjectiles) / sampleCount, maxProjectiles);
+
+	const string directory = "%USER%/StressTest";
+	gEnv->pCryPak->MakeDir(directory.c_str());
+	const string filePath = directory + "/" + m_summaryFileName;
+
+	if (FILE* pFile = gEnv->pCryPak->FOpen(filePath.c_str(), "wt"))
+	{
+		gEnv->pCryPak->FWrite(summary.c_str(), summary.length(), 1, pFile);
+		gEnv->pCryPak->FClose(pFile);
+		CryLogAlways("[StressTest] Summary written to %s", filePath.c_str());
+	}
+	else
+	{
+		CryWarning(VALIDATOR_MODULE_GAME, VALIDATOR_ERROR, "[StressTest] Could not write the summary to %s", filePath.c_str());
+	}
+	CryLogAlways("[StressTest] %s", summary.c_str());
+}
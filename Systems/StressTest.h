@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+////////////////////////////////////////////////////////
+// In-game stress test for finding where the plug-in falls over.
+// Spawns players and level change triggers, fires synthetic shots through the players' real weapon paths and
+// records frame time, entity count and physics entity count over a fixed window into a summary file.
+////////////////////////////////////////////////////////
+class CStressTest
+{
+public:
+	CStressTest() = default;
+	~CStressTest();
+
+	// Registers the stress test commands and CVars, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Spawns player entities on a grid around the local player.
+	void SpawnPlayers(uint32 count);
+	// Spawns level change trigger volumes scattered around the local player.
+	void SpawnTriggers(uint32 count);
+	// Removes every entity spawned by the stress test.
+	void Clear();
+
+	// Starts recording metrics for the given number of seconds, the summary is written to the file afterwards.
+	void StartRun(float duration, const char* szFileName);
+
+	// Fires the synthetic shots due this frame and samples the metrics of a running recording.
+	void Update(float frameTime);
+	// Forgets the spawned entities and stops recording, called when the level unloads.
+	void Reset();
+
+private:
+	struct SFrameSample
+	{
+		float frameTime;
+		uint32 entityCount;
+		uint32 physicalEntityCount;
+		uint32 projectileCount;
+	};
+
+	Vec3 GetSpawnCenter() const;
+	void FireSyntheticShots(float frameTime);
+	void WriteSummary();
+
+	std::vector<EntityId> m_playerIds;
+	std::vector<EntityId> m_triggerIds;
+
+	// Rounds per second fired across all stress test players, bound to g_stressFireRate.
+	float m_fireRate = 0.f;
+	// Shots that are due but not fired yet, carries fractional shots over to the next frame.
+	float m_pendingShots = 0.f;
+	uint32 m_nextShooter = 0;
+
+	bool m_isRecording = false;
+	float m_recordingTimeLeft = 0.f;
+	float m_recordingDuration = 0.f;
+	string m_summaryFileName;
+	std::vector<SFrameSample> m_samples;
+};
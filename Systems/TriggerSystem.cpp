@@ -0,0 +1,133 @@
+#include "StdAfx.h"
+#include "TriggerSystem.h"
+#include "GamePlugin.h"
+#include "GameplayProfiler.h"
+
+namespace
+{
+	// Smaller cells store every trigger in more cells, below this the hash only gets larger and slower
+	const float MinTriggerCellSize = 1.f;
+
+	void LogTriggerStatsCommand(IConsoleCmdArgs* pArgs)
+	{
+		CGamePlugin::GetInstance()->GetTriggerSystem().LogStatistics();
+	}
+}
+
+CTriggerSystem::~CTriggerSystem()
+{
+	if (gEnv && gEnv->pConsole)
+	{
+		gEnv->pConsole->UnregisterVariable("g_triggerCellSize", true);
+		gEnv->pConsole->RemoveCommand("g_triggerStats");
+	}
+}
+
+void CTriggerSystem::RegisterCVars()
+{
+	REGISTER_CVAR2("g_triggerCellSize", &m_cellSize, m_cellSize, VF_NULL, "Cell size in meters of the trigger volume spatial hash, at least 1");
+	REGISTER_COMMAND("g_triggerStats", LogTriggerStatsCommand, VF_NULL, "Prints the number of trigger volumes, players and hash cells");
+}
+
+void CTriggerSystem::SetTrigger(EntityId triggerId, const AABB& worldBounds, ITriggerListener* pListener)
+{
+	if (!m_broadphase.MoveTrigger(triggerId, ToBounds(worldBounds)))
+	{
+		m_broadphase.AddTrigger(triggerId, ToBounds(worldBounds));
+	}
+	m_listeners[triggerId] = pListener;
+}
+
+void CTriggerSystem::RemoveTrigger(EntityId triggerId)
+{
+	// The players inside get their leave events on the next update, but nobody is left to receive them
+	m_broadphase.RemoveTrigger(triggerId);
+	m_listeners.erase(triggerId);
+}
+
+void CTriggerSystem::RegisterPlayer(CPlayerComponent* pPlayer, EntityId playerId)
+{
+	m_players[playerId] = pPlayer;
+}
+
+void CTriggerSystem::UnregisterPlayer(EntityId playerId)
+{
+	m_players.erase(playerId);
+}
+
+void CTriggerSystem::Update()
+{
+	// Without triggers there is nothing to test, unless players still have to leave the last removed ones
+	if (m_broadphase.GetTriggerCount() == 0 && !m_broadphase.HasOverlaps())
+		return;
+
+	GAMEPLAY_PROFILE_SCOPE(TriggerBroadphase);
+	if (m_appliedCellSize != m_cellSize)
+	{
+		m_cellSize = max(m_cellSize, MinTriggerCellSize);
+		m_broadphase.SetCellSize(m_cellSize);
+		m_appliedCellSize = m_cellSize;
+	}
+
+	m_playerIds.clear();
+	m_playerBounds.clear();
+	for (const auto& player : m_players)
+	{
+		IEntity* pEntity = gEnv->pEntitySystem->GetEntity(player.first);
+		if (pEntity == nullptr)
+			continue;
+
+		AABB worldBounds;
+		pEntity->GetWorldBounds(worldBounds);
+		// Entities without geometry have empty bounds, test their position instead
+		if (worldBounds.IsReset())
+		{
+			worldBounds = AABB(pEntity->GetWorldPos(), 0.f);
+		}
+		m_playerIds.push_back(player.first);
+		m_playerBounds.push_back(ToBounds(worldBounds));
+	}
+
+	m_events.clear();
+	m_broadphase.Update(m_playerIds.data(), m_playerBounds.data(), static_cast<uint32>(m_playerIds.size()), m_events);
+	m_lastEventCount = static_cast<uint32>(m_events.size());
+
+	for (const TriggerKernels::SOverlapEvent& event : m_events)
+	{
+		auto listener = m_listeners.find(event.triggerId);
+		auto player = m_players.find(event.playerId);
+		if (listener == m_listeners.end() || player == m_players.end())
+			continue;
+
+		if (event.isEnter)
+		{
+			listener->second->OnPlayerEnterTrigger(*player->second);
+		}
+		else
+		{
+			listener->second->OnPlayerLeaveTrigger(*player->second);
+		}
+	}
+}
+
+void CTriggerSystem::Reset()
+{
+	// Forget the old level's triggers and overlaps without events, the components removed with it unregister
+	// afterwards and find nothing left to remove
+	m_broadphase.Clear();
+	m_listeners.clear();
+	m_players.clear();
+	m_events.clear();
+	m_lastEventCount = 0;
+}
+
+void CTriggerSystem::LogStatistics() const
+{
+	CryLogAlways("[TriggerSystem] triggers %u (%u too large for the cells), players %u, cells %u, events last frame %u",
+		m_broadphase.GetTriggerCount(), m_broadphase.GetLargeTriggerCount(), static_cast<uint32>(m_players.size()), m_broadphase.GetCellCount(), m_lastEventCount);
+}
+
+TriggerKernels::SBounds CTriggerSystem::ToBounds(const AABB& bounds)
+{
+	return TriggerKernels::SBounds { bounds.min.x, bounds.min.y, bounds.min.z, bounds.max.x, bounds.max.y, bounds.max.z };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Core/TriggerBroadphase.h"
+#include "GameplayMemory.h"
+#include <unordered_map>
+#include <vector>
+
+class CPlayerComponent;
+
+// Receives the enter and leave events of a trigger volume registered with CTriggerSystem.
+struct ITriggerListener
+{
+	virtual ~ITriggerListener() = default;
+	virtual void OnPlayerEnterTrigger(CPlayerComponent& player) = 0;
+	virtual void OnPlayerLeaveTrigger(CPlayerComponent& player) = 0;
+};
+
+////////////////////////////////////////////////////////
+// Plug-in level trigger volumes.
+// Replaces one IEntityTriggerComponent per trigger with a single spatial hash over every trigger box.
+// Only the registered players are tested, once per frame in one batch, and the listeners receive the player
+// component directly instead of looking the entity up again.
+////////////////////////////////////////////////////////
+class CTriggerSystem
+{
+public:
+	CTriggerSystem() = default;
+	~CTriggerSystem();
+
+	// Registers the cell size CVar and the statistics command, called once from the plug-in initialization.
+	void RegisterCVars();
+
+	// Adds or replaces the trigger of the entity, the bounds are in world space.
+	void SetTrigger(EntityId triggerId, const AABB& worldBounds, ITriggerListener* pListener);
+	void RemoveTrigger(EntityId triggerId);
+
+	void RegisterPlayer(CPlayerComponent* pPlayer, EntityId playerId);
+	void UnregisterPlayer(EntityId playerId);
+
+	// Tests the players against every trigger and sends the enter and leave events.
+	void Update();
+	// Forgets every trigger, player and overlap, called when the level unloads.
+	void Reset();
+
+	void LogStatistics() const;
+
+private:
+	static TriggerKernels::SBounds ToBounds(const AABB& bounds);
+
+	TriggerKernels::CTriggerBroadphase m_broadphase;
+	// Triggers and players are added and removed as entities spawn, their nodes come from the gameplay memory pools.
+	std::unordered_map<EntityId, ITriggerListener*, std::hash<EntityId>, std::equal_to<EntityId>,
+		TGameplayAllocator<std::pair<const EntityId, ITriggerListener*>, EMemoryTag::TriggerListeners>> m_listeners;
+	std::unordered_map<EntityId, CPlayerComponent*, std::hash<EntityId>, std::equal_to<EntityId>,
+		TGameplayAllocator<std::pair<const EntityId, CPlayerComponent*>, EMemoryTag::TriggerPlayers>> m_players;
+
+	// Rebuilt every frame from the registered players.
+	std::vector<uint32> m_playerIds;
+	std::vector<TriggerKernels::SBounds> m_playerBounds;
+	std::vector<TriggerKernels::SOverlapEvent> m_events;
+
+	float m_cellSize = 8.f;
+	float m_appliedCellSize = 8.f;
+	uint32 m_lastEventCount = 0;
+};